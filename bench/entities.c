@@ -0,0 +1,81 @@
+/// Benchmark for entities.
+///
+/// Moves 10k, 100k and 1M entities with 1, 2, 4, ... threads up to one per
+/// CPU, and reports the entities moved per millisecond and the speedup
+/// over one thread.
+///
+/// @see entities_update()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "entities.h"
+#include "prelude_sdl.h"
+#include "worker_pool.h"
+
+enum {
+    WIDTH = 1920,
+    HEIGHT = 1080,
+    MOVED = 50000000, // Entities moved per run, so every size runs for about as long
+};
+
+static const size_t SIZES[] = {10000, 100000, 1000000};
+
+static uint32_t rng_state = 1;
+
+static float rng(float max)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return max * (float)(rng_state >> 8) / (float)(1U << 24);
+}
+
+static int run(struct entities *es, int threads, double *rate)
+{
+    struct worker_pool *pool = worker_pool_create(threads);
+    if (pool == NULL) {
+        return -1;
+    }
+    const size_t steps = MOVED / es->count;
+    const uint64_t begin = now();
+    for (size_t step = 0; step < steps; ++step) {
+        entities_update(es, 1.0f / 60.0f, WIDTH, HEIGHT, pool);
+    }
+    const double ms = (double)(now() - begin) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    *rate = (double)(steps * es->count) / ms;
+    worker_pool_destroy(pool);
+    return 0;
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    const int cpus = SDL_GetCPUCount();
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); ++s) {
+        struct entities es = {0};
+        if (entities_init(&es, SIZES[s]) != 0) {
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < SIZES[s]; ++i) {
+            (void)entities_create(&es, rng(WIDTH), rng(HEIGHT), rng(200.0f) - 100.0f, rng(200.0f) - 100.0f);
+        }
+        double base = 0.0;
+        for (int threads = 1;; threads *= 2) {
+            if (threads > cpus) {
+                threads = cpus;
+            }
+            double rate = 0.0;
+            if (run(&es, threads, &rate) != 0) {
+                entities_finish(&es);
+                return EXIT_FAILURE;
+            }
+            if (threads == 1) {
+                base = rate;
+            }
+            printf("%8zu entities, %3d threads: %10.0f entities/ms, %5.2fx\n", SIZES[s], threads, rate, rate / base);
+            if (threads == cpus) {
+                break;
+            }
+        }
+        entities_finish(&es);
+    }
+    return EXIT_SUCCESS;
+}
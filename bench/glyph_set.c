@@ -0,0 +1,86 @@
+/// Benchmark for glyph_set.
+///
+/// Renders every glyph of a font with 1, 2, 4 and 8 threads, and reports
+/// glyphs per second and the speedup over one thread, best of a few runs.
+/// Each run's bitmaps are checked against the single-threaded ones.
+///
+/// @see glyph_set_load()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "glyph_set.h"
+
+enum {
+    RUNS = 3,
+};
+
+static const char *const FONT_FILE = "./assets/ucs-fonts/10x20.bdf";
+
+static double elapsed_s(const struct timespec *begin)
+{
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)(end.tv_sec - begin->tv_sec) + ((double)(end.tv_nsec - begin->tv_nsec) / 1e9);
+}
+
+static int same_glyphs(const struct glyph_set *a, const struct glyph_set *b)
+{
+    if (a->count != b->count) {
+        return 0;
+    }
+    for (size_t i = 0; i < a->count; ++i) {
+        const struct glyph *ga = &a->glyphs[i];
+        const struct glyph *gb = &b->glyphs[i];
+        if (ga->code != gb->code || ga->width != gb->width || ga->rows != gb->rows || ga->pitch != gb->pitch ||
+            ga->left != gb->left || ga->top != gb->top || ga->advance != gb->advance) {
+            return 0;
+        }
+        if (ga->bits != NULL && memcmp(ga->bits, gb->bits, (size_t)ga->rows * ga->pitch) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    extern const char *const FONT_FILE;
+
+    static const int threads[] = {1, 2, 4, 8};
+    const struct glyph_range all = {.low = 0, .high = 0x10FFFF};
+    const char *font_file = (argc > 1) ? argv[1] : FONT_FILE;
+
+    struct glyph_set reference;
+    if (glyph_set_load(&reference, font_file, &all, 1, 1) != 0) {
+        (void)fprintf(stderr, "Failed to load %s\n", font_file);
+        return EXIT_FAILURE;
+    }
+    int ret = EXIT_SUCCESS;
+    double serial = 0.0;
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+        double best = 0.0;
+        for (int run = 0; run < RUNS; ++run) {
+            struct glyph_set set;
+            struct timespec begin;
+            (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+            if (glyph_set_load(&set, font_file, &all, 1, threads[t]) != 0) {
+                ret = EXIT_FAILURE;
+                goto out_finish;
+            }
+            const double seconds = elapsed_s(&begin);
+            best = (run == 0 || seconds < best) ? seconds : best;
+            if (!same_glyphs(&set, &reference)) {
+                ret = EXIT_FAILURE;
+            }
+            glyph_set_finish(&set);
+        }
+        serial = (t == 0) ? best : serial;
+        printf("%d threads: %zu glyphs in %7.2f ms, %6.2f k glyphs/s, %4.2fx\n", threads[t], reference.count,
+               best * 1e3, (double)reference.count / best / 1e3, serial / best);
+    }
+out_finish:
+    glyph_set_finish(&reference);
+    return ret;
+}
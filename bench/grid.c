@@ -0,0 +1,156 @@
+/// Benchmark for grid.
+///
+/// Indexes 100k points moving across a 7680x4320 area, and reports the
+/// cost of rebuilding the grid from scratch against moving the points in
+/// place, and of 1920x1080 view queries and 64 pixel radius queries
+/// against scanning every point.
+///
+/// @see grid_move()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "grid.h"
+#include "prelude_sdl.h"
+
+enum {
+    POINTS = 100000,
+    FRAMES = 100,
+    VIEWS = 100,
+    RADII = 10000,
+};
+
+static const float WIDTH = 7680.0f;
+static const float HEIGHT = 4320.0f;
+static const float CELL = 64.0f;
+static const float VIEW_W = 1920.0f;
+static const float VIEW_H = 1080.0f;
+static const float RADIUS = 64.0f;
+static const float STEP = 100.0f / 60.0f; // Distance moved per frame at 100 pixels per second
+
+static float px[POINTS];
+static float py[POINTS];
+static uint32_t out[POINTS];
+
+static uint32_t rng_state = 1;
+
+static float rng(float max)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return max * (float)(rng_state >> 8) / (float)(1U << 24);
+}
+
+static double elapsed_ms(uint64_t begin)
+{
+    return (double)(now() - begin) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void step(void)
+{
+    for (size_t i = 0; i < POINTS; ++i) {
+        px[i] += (i & 1) ? STEP : -STEP;
+        py[i] += (i & 2) ? STEP : -STEP;
+    }
+}
+
+static size_t scan_rect(float x, float y, float w, float h)
+{
+    size_t found = 0;
+    for (uint32_t i = 0; i < POINTS; ++i) {
+        if (px[i] >= x && px[i] < x + w && py[i] >= y && py[i] < y + h) {
+            out[found++] = i;
+        }
+    }
+    return found;
+}
+
+static size_t scan_radius(float x, float y, float r)
+{
+    size_t found = 0;
+    for (uint32_t i = 0; i < POINTS; ++i) {
+        const float dx = px[i] - x;
+        const float dy = py[i] - y;
+        if ((dx * dx) + (dy * dy) <= r * r) {
+            out[found++] = i;
+        }
+    }
+    return found;
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    struct grid *grid = grid_create(WIDTH, HEIGHT, CELL, POINTS);
+    if (grid == NULL) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < POINTS; ++i) {
+        px[i] = rng(WIDTH);
+        py[i] = rng(HEIGHT);
+    }
+
+    uint64_t begin = now();
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        step();
+        grid_clear(grid);
+        for (uint32_t i = 0; i < POINTS; ++i) {
+            if (grid_move(grid, i, px[i], py[i]) != 0) {
+                goto out_destroy_grid;
+            }
+        }
+    }
+    printf("rebuild:     %8.3f ms/frame\n", elapsed_ms(begin) / FRAMES);
+
+    begin = now();
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        step();
+        for (uint32_t i = 0; i < POINTS; ++i) {
+            if (grid_move(grid, i, px[i], py[i]) != 0) {
+                goto out_destroy_grid;
+            }
+        }
+    }
+    printf("incremental: %8.3f ms/frame\n", elapsed_ms(begin) / FRAMES);
+
+    size_t grid_found = 0;
+    size_t scan_found = 0;
+    rng_state = 1;
+    begin = now();
+    for (int i = 0; i < VIEWS; ++i) {
+        grid_found += grid_query_rect(grid, rng(WIDTH - VIEW_W), rng(HEIGHT - VIEW_H), VIEW_W, VIEW_H, out, POINTS);
+    }
+    const double grid_view = elapsed_ms(begin) * 1000.0 / VIEWS;
+    rng_state = 1;
+    begin = now();
+    for (int i = 0; i < VIEWS; ++i) {
+        scan_found += scan_rect(rng(WIDTH - VIEW_W), rng(HEIGHT - VIEW_H), VIEW_W, VIEW_H);
+    }
+    const double scan_view = elapsed_ms(begin) * 1000.0 / VIEWS;
+    printf("view:        %8.3f us grid, %8.3f us scan, %5.1fx, %zu points each\n",
+           grid_view, scan_view, scan_view / grid_view, grid_found / VIEWS);
+    if (grid_found != scan_found) {
+        goto out_destroy_grid;
+    }
+
+    grid_found = 0;
+    scan_found = 0;
+    rng_state = 1;
+    begin = now();
+    for (int i = 0; i < RADII; ++i) {
+        grid_found += grid_query_radius(grid, rng(WIDTH), rng(HEIGHT), RADIUS, out, POINTS);
+    }
+    const double grid_radius = elapsed_ms(begin) * 1000.0 / RADII;
+    rng_state = 1;
+    begin = now();
+    for (int i = 0; i < RADII / 100; ++i) {
+        scan_found += scan_radius(rng(WIDTH), rng(HEIGHT), RADIUS);
+    }
+    const double scan_radius_us = elapsed_ms(begin) * 1000.0 / (RADII / 100);
+    printf("radius:      %8.3f us grid, %8.3f us scan, %5.1fx, %.1f points each\n",
+           grid_radius, scan_radius_us, scan_radius_us / grid_radius, (double)grid_found / RADII);
+
+    grid_destroy(grid);
+    return EXIT_SUCCESS;
+out_destroy_grid:
+    grid_destroy(grid);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,83 @@
+/// Benchmark for mixer.
+///
+/// Renders 2048-frame stereo buffers at 48 kHz with growing numbers of
+/// voices playing sines, and then looping samples, at spread pans through
+/// the limiter, and reports the time per buffer, the time per voice, and
+/// how many such voices fit in the buffer's period on one core.
+///
+/// @see mixer_render()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mixer.h"
+#include "oscillator.h"
+#include "prelude_sdl.h"
+
+enum {
+    SAMPLE_RATE = 48000,
+    BUFFER = 2048,
+    BUFFERS = 50,
+    VOICES = 256,
+    SAMPLE = 12345,
+};
+
+static float stream[2 * BUFFER];
+static float sample_data[SAMPLE];
+
+static double elapsed_us(uint64_t begin)
+{
+    return (double)(now() - begin) * 1e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+/// Starts voices on a new mixer and returns the time per buffer.
+static double run(size_t voices, int samples, float *sink)
+{
+    struct mixer *mixer = mixer_create(SAMPLE_RATE, VOICES, 240);
+    if (mixer == NULL) {
+        return -1.0;
+    }
+    const struct mixer_sample sample = {.samples = sample_data, .count = SAMPLE, .loop = 1};
+    for (size_t v = 0; v < voices; ++v) {
+        const float pan = (2.0f * (float)v / (float)VOICES) - 1.0f;
+        if (samples) {
+            (void)mixer_play_sample(mixer, v, &sample, 0.1f, pan);
+        } else {
+            (void)mixer_play_tone(mixer, v, 110.0 + (10.0 * (double)v), 0.1f, pan);
+        }
+    }
+    // Let the ramps settle so the steady state is measured
+    mixer_render(mixer, stream, BUFFER);
+    const uint64_t begin = now();
+    for (uint64_t b = 0; b < BUFFERS; ++b) {
+        mixer_render(mixer, stream, BUFFER);
+        *sink += stream[b % (2 * BUFFER)];
+    }
+    const double per_buffer = elapsed_us(begin) / BUFFERS;
+    mixer_destroy(mixer);
+    return per_buffer;
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    const double period = 1e6 * BUFFER / SAMPLE_RATE;
+    float sink = 0.0f;
+
+    struct oscillator osc = {0};
+    oscillator_init(&osc, 330.0, SAMPLE_RATE);
+    oscillator_sine(&osc, sample_data, SAMPLE, 1.0f);
+
+    static const char *const kinds[] = {"tones", "samples"};
+    for (int samples = 0; samples < 2; ++samples) {
+        const double empty = run(0, samples, &sink);
+        printf("%-7s %3d voices: %9.3f us/buffer\n", kinds[samples], 0, empty);
+        for (size_t voices = 16; voices <= VOICES; voices *= 4) {
+            const double t = run(voices, samples, &sink);
+            const double per_voice = (t - empty) / (double)voices;
+            printf("%-7s %3zu voices: %9.3f us/buffer, %6.3f us/voice, %6.3f%% of %.1f ms, ~%.0f voices fit\n",
+                   kinds[samples], voices, t, per_voice, 100.0 * t / period, period / 1000.0, (period - empty) / per_voice);
+        }
+    }
+    // Keeps the buffers from being optimized away
+    return (sink == 1e30f) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
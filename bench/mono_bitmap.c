@@ -0,0 +1,132 @@
+/// Benchmark for mono_bitmap.
+///
+/// Composes a page of 32x32 pseudo-random one-bit-per-pixel glyphs into a
+/// 32-bit BMP image, for glyphs 10x20 and 24x24, in two ways.  The old way
+/// expands each glyph a bit at a time into an image of one byte per pixel,
+/// then maps the bytes to pixels with the rows flipped.  The new way fills
+/// the image and expands each glyph a byte at a time through the table,
+/// straight to the flipped pixels.  Reports megapixels per second of each
+/// and checks that the images match.
+///
+/// @see mono_bitmap_expand()
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mono_bitmap.h"
+
+#define GET_BIT(c, pos) (((pos) >= CHAR_BIT) ? 0 : (((c) >> (CHAR_BIT + ~(pos)) & 1)))
+
+enum {
+    GRID = 32,       // Glyphs across and down the page
+    MAX_SIZE = 24,   // Largest glyph width and height
+    MAX_PITCH = 4,   // Bytes per glyph row, padded as FreeType does
+    RUNS = 50,
+};
+
+static const bmp_pixel32 WHITE = {0xFF, 0xFF, 0xFF, 0x00};
+static const bmp_pixel32 BLACK = {0x00, 0x00, 0x00, 0xFF};
+
+static unsigned char bits[GRID * GRID][MAX_SIZE * MAX_PITCH];
+static char bytes[(GRID * MAX_SIZE) * (GRID * MAX_SIZE)];
+static bmp_pixel32 old_image[(GRID * MAX_SIZE) * (GRID * MAX_SIZE)];
+static bmp_pixel32 new_image[(GRID * MAX_SIZE) * (GRID * MAX_SIZE)];
+
+static double elapsed_s(const struct timespec *begin)
+{
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)(end.tv_sec - begin->tv_sec) + ((double)(end.tv_nsec - begin->tv_nsec) / 1e9);
+}
+
+/// The loops generate_atlas_from_bdf used before mono_bitmap.
+static void compose_old(size_t width, size_t rows)
+{
+    extern const bmp_pixel32 WHITE;
+    extern const bmp_pixel32 BLACK;
+
+    const size_t stride = width * GRID;
+    const size_t height = rows * GRID;
+    memset(bytes, 0, stride * height);
+    for (size_t g = 0; g < GRID * GRID; ++g) {
+        const size_t left = (g % GRID) * width;
+        const size_t top = (g / GRID) * rows;
+        for (size_t y = 0, p = 0; y < rows; ++y, p += MAX_PITCH) {
+            for (size_t i = 0; i < MAX_PITCH; ++i) {
+                for (size_t j = 0, x; j < CHAR_BIT; ++j) {
+                    x = j + (i * CHAR_BIT);
+                    if (x >= width) {
+                        continue;
+                    }
+                    bytes[((top + y) * stride) + left + x] = (char)GET_BIT(bits[g][p + i], j);
+                }
+            }
+        }
+    }
+    for (size_t y = height, i = 0; y-- > 0;) {
+        for (size_t x = 0; x < stride; ++x, ++i) {
+            old_image[i] = bytes[(y * stride) + x] ? BLACK : WHITE;
+        }
+    }
+}
+
+static void compose_new(const struct mono_bitmap_lut *lut, size_t width, size_t rows)
+{
+    extern const bmp_pixel32 WHITE;
+
+    const size_t stride = width * GRID;
+    const size_t height = rows * GRID;
+    mono_bitmap_fill(new_image, stride * height, WHITE);
+    for (size_t g = 0; g < GRID * GRID; ++g) {
+        mono_bitmap_expand(lut, bits[g], MAX_PITCH, width, rows, new_image, stride, height, (g % GRID) * width,
+                           (g / GRID) * rows);
+    }
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    extern const bmp_pixel32 WHITE;
+    extern const bmp_pixel32 BLACK;
+
+    static const size_t sizes[][2] = {{10, 20}, {24, 24}};
+
+    uint32_t rng_state = 1;
+    for (size_t g = 0; g < GRID * GRID; ++g) {
+        for (size_t i = 0; i < sizeof(bits[g]); ++i) {
+            rng_state = rng_state * 1664525U + 1013904223U;
+            bits[g][i] = (unsigned char)(rng_state >> 24);
+        }
+    }
+    struct mono_bitmap_lut lut;
+    mono_bitmap_lut_init(&lut, BLACK, WHITE);
+
+    int ret = EXIT_SUCCESS;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        const size_t width = sizes[s][0];
+        const size_t rows = sizes[s][1];
+        const double pixels = (double)(width * rows * GRID * GRID) * RUNS;
+
+        struct timespec begin;
+        (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int run = 0; run < RUNS; ++run) {
+            compose_old(width, rows);
+        }
+        const double old_seconds = elapsed_s(&begin);
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int run = 0; run < RUNS; ++run) {
+            compose_new(&lut, width, rows);
+        }
+        const double new_seconds = elapsed_s(&begin);
+
+        if (memcmp(old_image, new_image, width * rows * GRID * GRID * sizeof(*old_image)) != 0) {
+            ret = EXIT_FAILURE;
+        }
+        printf("%2zux%-2zu glyphs: bit loops %7.1f M pixels/s, table %7.1f M pixels/s, %5.2fx\n", width, rows,
+               pixels / old_seconds / 1e6, pixels / new_seconds / 1e6, old_seconds / new_seconds);
+    }
+    return ret;
+}
@@ -0,0 +1,76 @@
+/// Benchmark for oscillator.
+///
+/// Fills 2048-frame stereo buffers at 48 kHz with a 440 Hz sine, once by
+/// calling sin() in double precision per sample from the elapsed time as
+/// the audio callback used to, and once with oscillator_sine() into a mono
+/// buffer copied to both channels, as the mixer does, and reports the time
+/// per buffer and the share of the buffer's period.
+///
+/// @see oscillator_sine()
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "oscillator.h"
+#include "prelude_sdl.h"
+
+enum {
+    SAMPLE_RATE = 48000,
+    BUFFER = 2048,
+    BUFFERS = 2000,
+};
+
+static const double FREQUENCY = 440.0;
+static const double VOLUME = 0.25;
+
+static float stream[2 * BUFFER];
+
+static float chunk[BUFFER];
+
+static void fill_sin(uint64_t elapsed)
+{
+    const uint64_t offset = elapsed * BUFFER;
+    for (uint64_t i = 0; i < BUFFER; ++i) {
+        const double time = (double)(offset + i) / SAMPLE_RATE;
+        const double y = VOLUME * sin(2.0 * M_PI * time * FREQUENCY);
+        stream[2 * i] = (float)y;
+        stream[(2 * i) + 1] = (float)y;
+    }
+}
+
+static double elapsed_us(uint64_t begin)
+{
+    return (double)(now() - begin) * 1e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    const double period = 1e6 * BUFFER / SAMPLE_RATE;
+    float sink = 0.0f;
+
+    uint64_t begin = now();
+    for (uint64_t b = 0; b < BUFFERS; ++b) {
+        fill_sin(b);
+        sink += stream[b % (2 * BUFFER)];
+    }
+    const double legacy = elapsed_us(begin) / BUFFERS;
+
+    struct oscillator osc = {0};
+    oscillator_init(&osc, FREQUENCY, SAMPLE_RATE);
+    begin = now();
+    for (uint64_t b = 0; b < BUFFERS; ++b) {
+        oscillator_sine(&osc, chunk, BUFFER, (float)VOLUME);
+        for (size_t i = 0; i < BUFFER; ++i) {
+            stream[2 * i] = chunk[i];
+            stream[(2 * i) + 1] = chunk[i];
+        }
+        sink += stream[b % (2 * BUFFER)];
+    }
+    const double fast = elapsed_us(begin) / BUFFERS;
+
+    printf("sin():      %8.3f us/buffer, %6.3f%% of %.1f ms\n", legacy, 100.0 * legacy / period, period / 1000.0);
+    printf("oscillator: %8.3f us/buffer, %6.3f%% of %.1f ms, %.1fx\n", fast, 100.0 * fast / period, period / 1000.0, legacy / fast);
+    // Keeps the buffers from being optimized away
+    return (sink == 1e30f) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
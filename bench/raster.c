@@ -0,0 +1,126 @@
+/// Benchmark for raster.
+///
+/// Rasterizes a 1920x1080 frame of a full-screen blit, 256 filled rectangles
+/// and 4096 alpha-blended 32x32 sprites with 1, 2, 4, ... threads up to one
+/// per CPU, and reports frames per second and the speedup over one thread.
+///
+/// @see raster_draw()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+#include "raster.h"
+#include "worker_pool.h"
+
+enum {
+    FRAMES = 50,
+    WIDTH = 1920,
+    HEIGHT = 1080,
+    SPRITE = 32,
+    SPRITES = 4096,
+    RECTS = 256,
+};
+
+static bmp_pixel32 background[WIDTH * HEIGHT];
+static bmp_pixel32 sprite[SPRITE * SPRITE];
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return rng_state >> 8;
+}
+
+static void init_images(void)
+{
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            background[(y * WIDTH) + x] = (bmp_pixel32){.b = (uint8_t)x, .g = (uint8_t)y, .r = (uint8_t)(x ^ y), .a = 0xFF};
+        }
+    }
+    // A disc fading out towards its edge, with fully transparent corners
+    const int c = SPRITE / 2;
+    for (int y = 0; y < SPRITE; ++y) {
+        for (int x = 0; x < SPRITE; ++x) {
+            const int d2 = ((x - c) * (x - c)) + ((y - c) * (y - c));
+            const int a = (d2 >= c * c) ? 0 : 255 - ((255 * d2) / (c * c));
+            sprite[(y * SPRITE) + x] = (bmp_pixel32){.b = 0xFF, .g = 0x80, .r = 0x20, .a = (uint8_t)a};
+        }
+    }
+}
+
+static int draw_frame(struct raster *raster)
+{
+    const struct raster_image bg = {background, WIDTH, HEIGHT, WIDTH};
+    const struct raster_image sp = {sprite, SPRITE, SPRITE, SPRITE};
+    if (raster_blit(raster, &bg, NULL, 0, 0) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < RECTS; ++i) {
+        const SDL_Rect rect = {(int)(rng() % WIDTH), (int)(rng() % HEIGHT), 64, 64};
+        const bmp_pixel32 color = {.b = (uint8_t)rng(), .g = (uint8_t)rng(), .r = (uint8_t)rng(), .a = 0xFF};
+        if (raster_fill(raster, &rect, color) != 0) {
+            return -1;
+        }
+    }
+    for (int i = 0; i < SPRITES; ++i) {
+        if (raster_blend(raster, &sp, NULL, (int)(rng() % WIDTH), (int)(rng() % HEIGHT)) != 0) {
+            return -1;
+        }
+    }
+    return raster_draw(raster, NULL);
+}
+
+static int run(int threads, double *fps)
+{
+    int ret = -1;
+    struct worker_pool *pool = worker_pool_create(threads);
+    if (pool == NULL) {
+        return -1;
+    }
+    struct raster *raster = raster_create(WIDTH, HEIGHT, pool);
+    if (raster == NULL) {
+        goto out_destroy_pool;
+    }
+    rng_state = 1;
+    const uint64_t begin = now();
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        if (draw_frame(raster) != 0) {
+            goto out_destroy_raster;
+        }
+    }
+    const double seconds = (double)(now() - begin) / (double)SDL_GetPerformanceFrequency();
+    *fps = FRAMES / seconds;
+    ret = 0;
+out_destroy_raster:
+    raster_destroy(raster);
+out_destroy_pool:
+    worker_pool_destroy(pool);
+    return ret;
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    init_images();
+    const int cpus = SDL_GetCPUCount();
+    double base = 0.0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > cpus) {
+            threads = cpus;
+        }
+        double fps = 0.0;
+        if (run(threads, &fps) != 0) {
+            return EXIT_FAILURE;
+        }
+        if (threads == 1) {
+            base = fps;
+        }
+        printf("%3d threads: %8.1f frames/s, %5.2fx\n", threads, fps, fps / base);
+        if (threads == cpus) {
+            break;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/// Benchmark for resampler.
+///
+/// Resamples stereo sines between 44.1 and 48 kHz both ways and by
+/// factors of two.  For quality it reports the signal-to-noise ratio of
+/// 1 kHz and 10 kHz sines against the ideal sine at the output rate, and
+/// when decimating, how far a tone between the two Nyquist frequencies is
+/// rejected.  For throughput it reports output frames per second and the
+/// multiple of real time on one core.
+///
+/// @see resampler_process()
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+#include "resampler.h"
+
+enum {
+    FRAMES = 96000, // Input frames per run
+    BLOCK = 2048,   // Input frames fed at a time
+    RUNS = 20,
+};
+
+static float in[2 * FRAMES];
+static float out[4 * FRAMES];
+
+static double elapsed_s(uint64_t begin)
+{
+    return (double)(now() - begin) / (double)SDL_GetPerformanceFrequency();
+}
+
+static void fill_sine(double frequency, int rate)
+{
+    for (size_t i = 0; i < FRAMES; ++i) {
+        const double phase = (2.0 * M_PI * frequency * (double)i) / rate;
+        in[2 * i] = (float)(0.5 * sin(phase));
+        in[(2 * i) + 1] = (float)(0.5 * cos(phase));
+    }
+}
+
+/// Resamples the input a block at a time and returns the output frames.
+static size_t run(struct resampler *resampler)
+{
+    resampler_reset(resampler);
+    size_t used = 0;
+    size_t written = 0;
+    while (used < FRAMES) {
+        size_t n = (FRAMES - used < BLOCK) ? FRAMES - used : BLOCK;
+        written += resampler_process(resampler, &in[2 * used], &n, &out[2 * written], (2 * FRAMES) - written);
+        used += n;
+    }
+    return written;
+}
+
+/// Returns the ratio of the ideal sine's power to the error's, in decibels.
+static double snr(struct resampler *resampler, double frequency, int from, int to)
+{
+    fill_sine(frequency, from);
+    const size_t written = run(resampler);
+    double signal = 0.0;
+    double noise = 0.0;
+    // Past the outputs filtered partly from the silence before the stream
+    for (size_t k = (2 * RESAMPLER_TAPS * (size_t)to) / (size_t)from; k < written; ++k) {
+        const double phase = (2.0 * M_PI * frequency * (double)k) / to;
+        const double left = 0.5 * sin(phase);
+        const double right = 0.5 * cos(phase);
+        signal += (left * left) + (right * right);
+        noise += ((out[2 * k] - left) * (out[2 * k] - left)) + ((out[(2 * k) + 1] - right) * (out[(2 * k) + 1] - right));
+    }
+    return 10.0 * log10(signal / noise);
+}
+
+/// Returns how far a tone above the output's Nyquist frequency is
+/// attenuated, in decibels.
+static double rejection(struct resampler *resampler, double frequency, int from, int to)
+{
+    fill_sine(frequency, from);
+    const size_t written = run(resampler);
+    double power = 0.0;
+    const size_t start = (2 * RESAMPLER_TAPS * (size_t)to) / (size_t)from;
+    for (size_t k = start; k < written; ++k) {
+        power += (out[2 * k] * out[2 * k]) + (out[(2 * k) + 1] * out[(2 * k) + 1]);
+    }
+    // The input's power is 0.25 a frame over both channels
+    return -10.0 * log10(power / (0.25 * (double)(written - start)));
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    static const int rates[][2] = {{44100, 48000}, {48000, 44100}, {24000, 48000}, {96000, 48000}};
+    float sink = 0.0f;
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        const int from = rates[r][0];
+        const int to = rates[r][1];
+        struct resampler resampler;
+        if (resampler_init(&resampler, from, to) != 0) {
+            return EXIT_FAILURE;
+        }
+        printf("%5d -> %5d: SNR %5.1f dB at 1 kHz, %5.1f dB at 10 kHz", from, to,
+               snr(&resampler, 1000.0, from, to), snr(&resampler, 10000.0, from, to));
+        if (from > to) {
+            const double alias = (double)(from + to) / 4.0;
+            printf(", %5.1f dB rejection at %.0f Hz", rejection(&resampler, alias, from, to), alias);
+        }
+        printf("\n");
+
+        fill_sine(1000.0, from);
+        size_t frames = 0;
+        const uint64_t begin = now();
+        for (int i = 0; i < RUNS; ++i) {
+            frames += run(&resampler);
+            sink += out[i];
+        }
+        const double seconds = elapsed_s(begin);
+        printf("%5d -> %5d: %6.2f M frames/s, %5.0fx real time\n", from, to,
+               (double)frames / seconds / 1e6, ((double)frames / to) / seconds);
+        resampler_finish(&resampler);
+    }
+    // Keeps the buffers from being optimized away
+    return (sink == 1e30f) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
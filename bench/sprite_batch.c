@@ -0,0 +1,187 @@
+/// Benchmark for sprite_batch.
+///
+/// Draws 1k to 100k random sprites per frame, once with one SDL_RenderCopy
+/// per sprite and once through a sprite_batch, with both an accelerated and
+/// the software renderer, and reports sprites per millisecond.
+///
+/// @see sprite_batch_draw()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+#include "sprite_batch.h"
+
+enum {
+    FRAMES = 10,
+    MAX_SPRITES = 100000,
+    WIDTH = 1280,
+    HEIGHT = 720,
+    TILE = 16,
+    TILES = 4, // Tiles per atlas row and column
+};
+
+static const int COUNTS[] = {1000, 10000, 100000};
+
+struct sprites {
+    SDL_Rect src[MAX_SPRITES];
+    SDL_FRect dst[MAX_SPRITES];
+    SDL_Color color[MAX_SPRITES];
+};
+
+static struct sprites sprites = {0};
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return rng_state >> 8;
+}
+
+static void init_sprites(struct sprites *s)
+{
+    for (int i = 0; i < MAX_SPRITES; ++i) {
+        const int tile = (int)(rng() % (TILES * TILES));
+        s->src[i] = (SDL_Rect){(tile % TILES) * TILE, (tile / TILES) * TILE, TILE, TILE};
+        s->dst[i] = (SDL_FRect){(float)(rng() % WIDTH), (float)(rng() % HEIGHT), TILE, TILE};
+        s->color[i] = (SDL_Color){(uint8_t)rng(), (uint8_t)rng(), (uint8_t)rng(), 0xFF};
+    }
+}
+
+/// Creates a TILES x TILES atlas of flat-colored tiles.
+static SDL_Texture *create_atlas(SDL_Renderer *renderer)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, TILE * TILES, TILE * TILES, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == NULL) {
+        log_sdl_error("SDL_CreateRGBSurfaceWithFormat failed");
+        return NULL;
+    }
+    for (int y = 0; y < surface->h; ++y) {
+        uint32_t *row = (uint32_t *)((uint8_t *)surface->pixels + ((size_t)y * (size_t)surface->pitch));
+        for (int x = 0; x < surface->w; ++x) {
+            const uint32_t tile = (uint32_t)((y / TILE) * TILES + (x / TILE));
+            row[x] = 0xFF000000 | (tile * 0x0F0F0F);
+        }
+    }
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (texture == NULL) {
+        log_sdl_error("SDL_CreateTextureFromSurface failed");
+    }
+    return texture;
+}
+
+static int draw_copy(SDL_Renderer *renderer, SDL_Texture *texture, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        const SDL_FRect *f = &sprites.dst[i];
+        const SDL_Rect dst = {(int)f->x, (int)f->y, (int)f->w, (int)f->h};
+        if (SDL_RenderCopy(renderer, texture, &sprites.src[i], &dst) != 0) {
+            log_sdl_error("SDL_RenderCopy failed");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int draw_batch(struct sprite_batch *batch, SDL_Texture *texture, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        if (sprite_batch_draw(batch, texture, &sprites.src[i], &sprites.dst[i], sprites.color[i]) != 0) {
+            return -1;
+        }
+    }
+    return sprite_batch_flush(batch);
+}
+
+static int run(const char *name, SDL_Renderer *renderer)
+{
+    int ret = -1;
+    SDL_Texture *texture = create_atlas(renderer);
+    if (texture == NULL) {
+        return -1;
+    }
+    struct sprite_batch *batch = sprite_batch_create(renderer, 16384);
+    if (batch == NULL) {
+        goto out_destroy_texture;
+    }
+    const double freq = (double)SDL_GetPerformanceFrequency();
+    for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); ++c) {
+        const int n = COUNTS[c];
+        for (int method = 0; method < 2; ++method) {
+            const uint64_t begin = now();
+            for (int frame = 0; frame < FRAMES; ++frame) {
+                (void)SDL_RenderClear(renderer);
+                const int rc = (method == 0) ? draw_copy(renderer, texture, n) : draw_batch(batch, texture, n);
+                if (rc != 0) {
+                    goto out_destroy_batch;
+                }
+                SDL_RenderPresent(renderer);
+            }
+            const double ms = ((double)(now() - begin) * 1000.0) / freq;
+            printf("%-12s %-6s %7d sprites: %10.1f sprites/ms\n",
+                   name, (method == 0) ? "copy" : "batch", n, ((double)n * FRAMES) / ms);
+        }
+    }
+    ret = 0;
+out_destroy_batch:
+    sprite_batch_destroy(batch);
+out_destroy_texture:
+    SDL_DestroyTexture(texture);
+    return ret;
+}
+
+static int run_accelerated(void)
+{
+    SDL_Window *window = SDL_CreateWindow("bench", 0, 0, WIDTH, HEIGHT, SDL_WINDOW_HIDDEN);
+    if (window == NULL) {
+        log_sdl_error("SDL_CreateWindow failed, skipping accelerated renderer");
+        return 0;
+    }
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (renderer == NULL) {
+        log_sdl_error("SDL_CreateRenderer failed, skipping accelerated renderer");
+        SDL_DestroyWindow(window);
+        return 0;
+    }
+    const int rc = run("accelerated", renderer);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    return rc;
+}
+
+static int run_software(void)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WIDTH, HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == NULL) {
+        log_sdl_error("SDL_CreateRGBSurfaceWithFormat failed");
+        return -1;
+    }
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(surface);
+    if (renderer == NULL) {
+        log_sdl_error("SDL_CreateSoftwareRenderer failed");
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    const int rc = run("software", renderer);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return rc;
+}
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char *argv[])
+{
+    int rc = SDL_Init(SDL_INIT_VIDEO);
+    if (rc != 0) {
+        log_sdl_error("SDL_Init failed");
+        return EXIT_FAILURE;
+    }
+    init_sprites(&sprites);
+    rc = run_accelerated();
+    if (rc == 0) {
+        rc = run_software();
+    }
+    SDL_Quit();
+    return (rc == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+/// Benchmark for text.
+///
+/// Fills a 1280x720 screen with 128x36 glyphs per frame, once with every
+/// line changing each frame and once with the same lines, with both an
+/// accelerated and the software renderer, and reports glyphs per
+/// millisecond and submissions per frame.
+///
+/// @see text_draw()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+#include "sprite_batch.h"
+#include "text.h"
+
+enum {
+    FRAMES = 100,
+    WIDTH = 1280,
+    HEIGHT = 720,
+    COLS = WIDTH / 10,
+    ROWS = HEIGHT / 20,
+};
+
+static char lines[ROWS][COLS + 1] = {{0}};
+
+/// Fills the screen's lines with printable characters that depend on the frame.
+static void fill_lines(unsigned frame)
+{
+    for (unsigned row = 0; row < ROWS; ++row) {
+        for (unsigned col = 0; col < COLS; ++col) {
+            lines[row][col] = (char)('!' + ((row * 7 + col * 13 + frame) % ('~' - '!' + 1)));
+        }
+        lines[row][COLS] = '\0';
+    }
+}
+
+static int run(const char *name, SDL_Renderer *renderer, const char *atlas)
+{
+    int ret = -1;
+    struct text *text = text_create(renderer, atlas);
+    if (text == NULL) {
+        return -1;
+    }
+    struct sprite_batch *batch = sprite_batch_create(renderer, ROWS * COLS);
+    if (batch == NULL) {
+        goto out_destroy_text;
+    }
+    const double freq = (double)SDL_GetPerformanceFrequency();
+    for (int changing = 1; changing >= 0; --changing) {
+        fill_lines(0);
+        (void)sprite_batch_submissions(batch);
+        const uint64_t begin = now();
+        for (unsigned frame = 0; frame < FRAMES; ++frame) {
+            if (changing) {
+                fill_lines(frame);
+            }
+            (void)SDL_RenderClear(renderer);
+            for (int row = 0; row < ROWS; ++row) {
+                if (text_draw(text, batch, 0, row * 20, lines[row]) != 0) {
+                    goto out_destroy_batch;
+                }
+            }
+            if (sprite_batch_flush(batch) != 0) {
+                goto out_destroy_batch;
+            }
+            SDL_RenderPresent(renderer);
+        }
+        const double ms = ((double)(now() - begin) * 1000.0) / freq;
+        const int submissions = sprite_batch_submissions(batch);
+        printf("%-12s %-9s %d glyphs: %10.1f glyphs/ms, %.1f submissions/frame\n",
+               name, changing ? "changing" : "unchanged", ROWS * COLS,
+               ((double)ROWS * COLS * FRAMES) / ms, (double)submissions / FRAMES);
+    }
+    ret = 0;
+out_destroy_batch:
+    sprite_batch_destroy(batch);
+out_destroy_text:
+    text_destroy(text);
+    return ret;
+}
+
+static int run_accelerated(const char *atlas)
+{
+    SDL_Window *window = SDL_CreateWindow("bench", 0, 0, WIDTH, HEIGHT, SDL_WINDOW_HIDDEN);
+    if (window == NULL) {
+        log_sdl_error("SDL_CreateWindow failed, skipping accelerated renderer");
+        return 0;
+    }
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (renderer == NULL) {
+        log_sdl_error("SDL_CreateRenderer failed, skipping accelerated renderer");
+        SDL_DestroyWindow(window);
+        return 0;
+    }
+    const int rc = run("accelerated", renderer, atlas);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    return rc;
+}
+
+static int run_software(const char *atlas)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WIDTH, HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == NULL) {
+        log_sdl_error("SDL_CreateRGBSurfaceWithFormat failed");
+        return -1;
+    }
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(surface);
+    if (renderer == NULL) {
+        log_sdl_error("SDL_CreateSoftwareRenderer failed");
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    const int rc = run("software", renderer, atlas);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *atlas = (argc > 1) ? argv[1] : "assets/10x20.bmp";
+    int rc = SDL_Init(SDL_INIT_VIDEO);
+    if (rc != 0) {
+        log_sdl_error("SDL_Init failed");
+        return EXIT_FAILURE;
+    }
+    rc = run_accelerated(atlas);
+    if (rc == 0) {
+        rc = run_software(atlas);
+    }
+    SDL_Quit();
+    return (rc == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,3 +4,42 @@ height = 720
 
 -- define framerate
 framerate = 60
+
+-- define simulation tick rate, independent of framerate
+tickrate = 60
+
+-- define maximum number of simulation ticks per frame
+maxticks = 5
+
+-- redraw only the regions of the window which changed
+damagetracking = false
+
+-- draw the background on the CPU, with one thread per core
+softwareraster = false
+
+-- pick the framerate from measured frame cost, as a divisor of the display refresh rate
+governor = false
+
+-- framerate used by the governor when no input arrives for idletimeout milliseconds
+idlerate = 10
+idletimeout = 5000
+
+-- replay each frame on a separate render thread while the main thread records the next
+-- (SDL renderers are not thread-safe on every platform, macOS needs this off)
+renderthread = false
+
+-- number of moving objects simulated each tick, across 3x3 windows viewed through the middle one
+entities = 0
+
+-- audio sample rate asked of the device, which may grant another
+samplerate = 48000
+
+-- audio latency in milliseconds, the buffer size asked of the device
+audiolatency = 20
+
+-- render audio on the main thread and queue it on the device instead of mixing in a callback,
+-- keeping about audiolatency queued and adapting to how regularly frames come
+audiopush = false
+
+-- WAV file streamed in a loop while F4 is toggled on, resampled to the device's rate, or "" for none
+music = ""
@@ -0,0 +1,67 @@
+#ifndef SDL_BITS_INCLUDE_AUDIO_METER_H
+#define SDL_BITS_INCLUDE_AUDIO_METER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+    AUDIO_METER_BINS = 21, // Bins of 5% of the period, the last for over budget
+};
+
+/// Timings of the audio callback against the period of its buffer.
+///
+/// The audio thread records each callback with audio_meter_record(),
+/// which only stores to counters.  Any other thread can read them at any
+/// time with audio_meter_read(), without locks.
+struct audio_meter {
+    double period;                               // Performance counter ticks per buffer
+    double frequency;                            // Performance counter ticks per second
+    uint64_t last_begin;                         // Start of the previous callback, owned by the audio thread
+    atomic_uint_fast64_t callbacks;              // Number of callbacks
+    atomic_uint_fast64_t over;                   // Callbacks which took longer than the period
+    atomic_uint_fast64_t late;                   // Callbacks which began over 1.5 periods after the previous
+    atomic_uint_fast64_t missed;                 // Periods with no callback, estimated from the intervals
+    atomic_uint_fast64_t busy;                   // Total ticks spent in callbacks
+    atomic_uint_fast64_t max_busy;               // Most ticks spent in a callback
+    atomic_uint_fast64_t bins[AUDIO_METER_BINS]; // Callbacks by share of the period used
+};
+
+/// A snapshot of an audio meter.
+///
+/// Each counter is exact, but they may have been read on either side of
+/// a callback.
+struct audio_meter_stats {
+    double period;                   // Period of a buffer in milliseconds
+    uint64_t callbacks;              // Number of callbacks
+    uint64_t over;                   // Callbacks which took longer than the period
+    uint64_t late;                   // Callbacks which began over 1.5 periods after the previous
+    uint64_t missed;                 // Periods with no callback
+    double mean;                     // Mean share of the period used
+    double max;                      // Largest share of the period used
+    double p99;                      // Share of the period used by 99% of callbacks, to a bin
+    uint64_t bins[AUDIO_METER_BINS]; // Callbacks by share of the period used
+};
+
+/// Initializes the meter with no callbacks.
+///
+/// @param meter The meter.
+/// @param sample_rate The sample rate in Hz.
+/// @param buffer_size The number of frames per buffer.
+/// @param frequency The performance counter frequency in Hz.
+void audio_meter_init(struct audio_meter *meter, int sample_rate, int buffer_size, uint64_t frequency);
+
+/// Records a callback.  Called by the audio thread only.
+///
+/// @param meter The meter.
+/// @param begin The performance counter when the callback began.
+/// @param end The performance counter when the callback ended.
+void audio_meter_record(struct audio_meter *meter, uint64_t begin, uint64_t end);
+
+/// Reads the counters.  Called by any thread.
+///
+/// @param meter The meter.
+/// @param stats The stats to write.
+void audio_meter_read(struct audio_meter *meter, struct audio_meter_stats *stats);
+
+#endif // SDL_BITS_INCLUDE_AUDIO_METER_H
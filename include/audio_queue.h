@@ -0,0 +1,44 @@
+#ifndef SDL_BITS_INCLUDE_AUDIO_QUEUE_H
+#define SDL_BITS_INCLUDE_AUDIO_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+    AUDIO_QUEUE_WINDOW = 64, // Top-ups between attempts to lower the target
+};
+
+/// Picks how much audio to queue when pushing it to the device.
+///
+/// Each top-up fills the queue to a target number of frames.  The target
+/// grows by a granule whenever the queue is found empty, and every
+/// AUDIO_QUEUE_WINDOW top-ups it gives back half of what the queue never
+/// dipped below, keeping a granule in hand, so that it settles at the
+/// least latency that the caller's timing allows.
+struct audio_queue {
+    size_t granule;     // Frames rendered at a time
+    size_t min_target;  // Least target
+    size_t max_target;  // Most target
+    size_t target;      // Frames to have queued after a top-up
+    size_t low;         // Fewest frames found queued since the last evaluation
+    size_t top_ups;     // Top-ups since the last evaluation
+    uint64_t underruns; // Top-ups which found the queue empty
+    int started;        // Whether anything has been queued
+};
+
+/// Initializes the controller.
+///
+/// @param queue The controller.
+/// @param granule The frames rendered at a time.
+/// @param target The initial target, rounded up to a granule.
+/// @param max_target The most target.
+void audio_queue_init(struct audio_queue *queue, size_t granule, size_t target, size_t max_target);
+
+/// Records the frames still queued and returns how many to add.
+///
+/// @param queue The controller.
+/// @param queued The frames still queued on the device.
+/// @return The frames to render and queue, a multiple of the granule.
+size_t audio_queue_top_up(struct audio_queue *queue, size_t queued);
+
+#endif // SDL_BITS_INCLUDE_AUDIO_QUEUE_H
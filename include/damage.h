@@ -0,0 +1,52 @@
+#ifndef SDL_BITS_INCLUDE_DAMAGE_H
+#define SDL_BITS_INCLUDE_DAMAGE_H
+
+#include <stdint.h>
+
+#include <SDL.h>
+
+enum {
+    DAMAGE_MAX_RECTS = 16, // Beyond this, the damage collapses to its bounding box
+};
+
+/// The regions of a render target which must be redrawn.
+///
+/// The rectangles are kept disjoint and clipped to the bounds.
+struct damage {
+    SDL_Rect bounds;                  // Bounds of the render target
+    SDL_Rect rects[DAMAGE_MAX_RECTS]; // Dirty rectangles
+    int count;                        // Number of dirty rectangles
+};
+
+/// Initializes the damage with the whole target dirty.
+///
+/// @param damage The damage.
+/// @param width The width of the render target.
+/// @param height The height of the render target.
+void damage_init(struct damage *damage, int width, int height);
+
+/// Marks a rectangle as dirty.
+///
+/// Overlapping rectangles are merged into their union.
+///
+/// @param damage The damage.
+/// @param rect The rectangle.
+void damage_add(struct damage *damage, const SDL_Rect *rect);
+
+/// Marks the whole render target as dirty.
+///
+/// @param damage The damage.
+void damage_add_all(struct damage *damage);
+
+/// Marks everything as clean.
+///
+/// @param damage The damage.
+void damage_clear(struct damage *damage);
+
+/// Returns the number of dirty pixels.
+///
+/// @param damage The damage.
+/// @return The total area of the dirty rectangles.
+uint64_t damage_area(const struct damage *damage);
+
+#endif // SDL_BITS_INCLUDE_DAMAGE_H
@@ -0,0 +1,118 @@
+#ifndef SDL_BITS_INCLUDE_ENTITIES_H
+#define SDL_BITS_INCLUDE_ENTITIES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "worker_pool.h"
+
+/// A handle to an entity.
+///
+/// The low 32 bits name a slot and the high 32 bits count how many times
+/// the slot has been reused.  A slot whose count would wrap is retired
+/// instead of reused, so a handle to a destroyed entity never refers to a
+/// later one.  0 is never a valid handle.
+typedef uint64_t entity;
+
+enum {
+    ENTITY_MAX = 1 << 22, // Maximum number of live entities
+    ENTITY_CHUNK = 16384, // Entities per parallel iteration
+};
+
+#define ENTITY_NONE ((entity)0)
+
+/// A slot a handle refers to.
+struct entity_slot {
+    uint32_t dense;      // Index in the columns while live, else the next free slot
+    uint32_t generation; // Generation of the handles to this slot, 0 once retired
+};
+
+/// Entities stored as parallel columns, packed at [0, count).
+///
+/// Destroying an entity moves the last one into its place, so indices
+/// change but handles do not.  The columns may be read and written
+/// directly, indexed by entities_index().  Positions are in pixels and
+/// velocities in pixels per second.
+struct entities {
+    float *x;                  // Horizontal positions
+    float *y;                  // Vertical positions
+    float *vx;                 // Horizontal velocities
+    float *vy;                 // Vertical velocities
+    uint32_t *owner;           // Slot of each packed entity
+    size_t count;              // Number of live entities
+    size_t cap;                // Capacity of the columns
+    struct entity_slot *slots; // Slots, of which used are initialized
+    uint32_t used;             // Number of slots ever handed out
+    uint32_t free;             // First free slot, or UINT32_MAX
+};
+
+/// Allocates storage for up to cap entities.
+///
+/// @param es The store.
+/// @param cap The maximum number of live entities, at most ENTITY_MAX.
+/// @return 0 on success, -1 on error.
+/// @see entities_finish()
+int entities_init(struct entities *es, size_t cap);
+
+/// Frees resources associated with the store.
+///
+/// @param es The store.
+/// @see entities_init()
+void entities_finish(struct entities *es);
+
+/// Creates an entity.
+///
+/// @param es The store.
+/// @param x The horizontal position.
+/// @param y The vertical position.
+/// @param vx The horizontal velocity.
+/// @param vy The vertical velocity.
+/// @return A handle to the entity, or ENTITY_NONE if the store is full.
+entity entities_create(struct entities *es, float x, float y, float vx, float vy);
+
+/// Destroys an entity, moving the last packed entity into its place.
+///
+/// @param es The store.
+/// @param e The entity.
+/// @return 0 on success, -1 if the handle is stale or invalid.
+int entities_destroy(struct entities *es, entity e);
+
+/// Finds where an entity is packed.
+///
+/// @param es The store.
+/// @param e The entity.
+/// @param index Set to the entity's index in the columns.
+/// @return 0 on success, -1 if the handle is stale or invalid.
+int entities_index(const struct entities *es, entity e, size_t *index);
+
+/// Returns the handle of a packed entity.
+///
+/// @param es The store.
+/// @param index The index in the columns, less than count.
+/// @return The handle.
+entity entities_handle(const struct entities *es, size_t index);
+
+/// Moves the packed entities [begin, end) by their velocities, wrapping
+/// them around the edges of a width by height area.
+///
+/// Entities are assumed to move less than the area per step.
+///
+/// @param es The store.
+/// @param dt The time step in seconds.
+/// @param width The width of the area.
+/// @param height The height of the area.
+/// @param begin The first entity.
+/// @param end One past the last entity.
+void entities_integrate(struct entities *es, float dt, float width, float height, size_t begin, size_t end);
+
+/// Moves every entity, in chunks of ENTITY_CHUNK spread over the pool.
+///
+/// @param es The store.
+/// @param dt The time step in seconds.
+/// @param width The width of the area.
+/// @param height The height of the area.
+/// @param pool The pool, or NULL to run on the calling thread.
+/// @see entities_integrate()
+void entities_update(struct entities *es, float dt, float width, float height, struct worker_pool *pool);
+
+#endif // SDL_BITS_INCLUDE_ENTITIES_H
@@ -0,0 +1,124 @@
+#ifndef SDL_BITS_INCLUDE_GLYPH_INDEX_H
+#define SDL_BITS_INCLUDE_GLYPH_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+    GLYPH_INDEX_MAGIC = 0x58444947, // "GIDX" in a little-endian file
+    GLYPH_INDEX_VERSION = 1,
+};
+
+#define GLYPH_INDEX_NONE UINT32_MAX
+
+/// The header at the start of a glyph index file.
+///
+/// The file is a header followed by four arrays, each at an offset from
+/// the start of the file that is a multiple of 4: the page sizes, the
+/// glyph metrics in order of codepoint, a dense table with the metrics
+/// index of every codepoint from dense_low, GLYPH_INDEX_NONE where the
+/// font has none, and the sparse entries for the codepoints outside it,
+/// in order.  Every field is in the byte order of the machine that wrote
+/// it, which the magic number tells apart.
+struct glyph_index_header {
+    uint32_t magic;         // GLYPH_INDEX_MAGIC
+    uint16_t version;       // GLYPH_INDEX_VERSION
+    uint16_t page_count;    // Number of atlas pages
+    int16_t ascent;         // Rows from the top of a line to the baseline
+    int16_t line_height;    // Rows from one baseline to the next
+    uint32_t glyph_count;   // Number of glyph metrics
+    uint32_t dense_low;     // First codepoint of the dense table
+    uint32_t dense_count;   // Number of codepoints in the dense table
+    uint32_t sparse_count;  // Number of sparse entries
+    uint32_t pages_offset;  // Offset of the page sizes
+    uint32_t glyphs_offset; // Offset of the glyph metrics
+    uint32_t dense_offset;  // Offset of the dense table
+    uint32_t sparse_offset; // Offset of the sparse entries
+    uint32_t file_size;     // Size of the whole file
+};
+
+/// The size of an atlas page.
+struct glyph_index_page {
+    uint16_t width;
+    uint16_t height;
+};
+
+/// Where a glyph is in the atlas, and how it is placed on a line.
+///
+/// The texture coordinates of the glyph are its rectangle divided by the
+/// size of its page.
+struct glyph_metrics {
+    uint16_t page;   // Atlas page
+    uint16_t x;      // Left edge in the page
+    uint16_t y;      // Top edge in the page
+    uint16_t width;  // Width in the page, 0 for a blank glyph
+    uint16_t height; // Height in the page, 0 for a blank glyph
+    int16_t left;    // Columns from the pen to the left edge
+    int16_t top;     // Rows from the baseline up to the top edge
+    int16_t advance; // Columns the pen moves after the glyph
+};
+
+/// A codepoint outside the dense table.
+struct glyph_index_entry {
+    uint32_t code;  // Codepoint
+    uint32_t glyph; // Index of its metrics
+};
+
+/// A glyph index file mapped into memory.
+struct glyph_index {
+    void *map;                               // Mapping of the whole file
+    size_t map_size;                         // Size of the mapping in bytes
+    const struct glyph_index_header *header; // Header, at the start of the mapping
+    const struct glyph_index_page *pages;    // Page sizes
+    const struct glyph_metrics *glyphs;      // Glyph metrics
+    const uint32_t *dense;                   // Dense table
+    const struct glyph_index_entry *sparse;  // Sparse entries
+};
+
+/// Writes a glyph index file.
+///
+/// The dense table covers the longest run of codepoints that the font has
+/// at least half of, and the rest go in the sparse entries.
+///
+/// @param file The name of the file.
+/// @param pages The page sizes.
+/// @param page_count The number of pages.
+/// @param codes The codepoints, in increasing order.
+/// @param glyphs The metrics of each codepoint.
+/// @param count The number of codepoints.
+/// @param ascent Rows from the top of a line to the baseline.
+/// @param line_height Rows from one baseline to the next.
+/// @return 0 on success, -1 on error.
+int glyph_index_write(const char *file, const struct glyph_index_page *pages, size_t page_count, const uint32_t *codes,
+                      const struct glyph_metrics *glyphs, size_t count, int ascent, int line_height);
+
+/// Names the index written beside an atlas: the name of the atlas with
+/// its extension replaced by .glyphs.
+///
+/// @param atlas_file The name of the atlas' first page.
+/// @return The name, to be freed by the caller, or NULL on error.
+char *glyph_index_file_name(const char *atlas_file);
+
+/// Maps a glyph index file and checks that its arrays lie within it.
+///
+/// @param index The index.
+/// @param file The name of the file.
+/// @return 0 on success, -1 on error.
+/// @see glyph_index_close()
+int glyph_index_open(struct glyph_index *index, const char *file);
+
+/// Unmaps the glyph index file.
+///
+/// @param index The index.
+/// @see glyph_index_open()
+void glyph_index_close(struct glyph_index *index);
+
+/// Finds the metrics of a codepoint, with one load in the dense table, or
+/// a binary search of the sparse entries outside it.
+///
+/// @param index The index.
+/// @param code The codepoint.
+/// @return The metrics, or NULL if the font has no glyph for the codepoint.
+const struct glyph_metrics *glyph_index_find(const struct glyph_index *index, uint32_t code);
+
+#endif // SDL_BITS_INCLUDE_GLYPH_INDEX_H
@@ -0,0 +1,65 @@
+#ifndef SDL_BITS_INCLUDE_GLYPH_SET_H
+#define SDL_BITS_INCLUDE_GLYPH_SET_H
+
+#include <stddef.h>
+
+enum {
+    GLYPH_SET_CHUNK = 64,  // Glyphs a worker takes from the queue at a time
+    GLYPH_SET_PIXELS = 20, // Height a scalable font is rendered at
+};
+
+/// Codepoints from low to high, inclusive.
+struct glyph_range {
+    unsigned long low;
+    unsigned long high;
+};
+
+/// A glyph's bitmap and where it is packed.
+struct glyph {
+    unsigned long code;  // Codepoint
+    int width;           // Width of the bitmap
+    int rows;            // Height of the bitmap
+    int left;            // Columns from the pen to the bitmap's left edge
+    int top;             // Rows from the baseline up to the bitmap's top edge
+    int advance;         // Columns the pen moves after the glyph
+    size_t pitch;        // Bytes per row of the bitmap
+    unsigned char *bits; // Rows of the bitmap, one bit per pixel, top first
+    int page;            // Page the glyph is packed into
+    int x;               // Left edge in the page
+    int y;               // Top edge in the page
+};
+
+/// Monochrome bitmaps of the glyphs a font has in some ranges, in order
+/// of codepoint.
+struct glyph_set {
+    struct glyph *glyphs;
+    size_t count;
+    int ascent;      // Rows from the top of a line to the baseline
+    int line_height; // Rows from one baseline to the next
+};
+
+/// Renders every glyph the font has in the ranges, each codepoint once.
+///
+/// A font with fixed sizes is rendered at its first, and a scalable one
+/// GLYPH_SET_PIXELS high.  The codepoints are read from the font's
+/// character map, then rendered by a number of threads, each with its own
+/// FreeType library and face, which take chunks of GLYPH_SET_CHUNK
+/// codepoints from a shared counter and fill in those glyphs.  The
+/// caller's thread is one of them.
+///
+/// @param set The set to fill.
+/// @param font_file The font to render.
+/// @param ranges The codepoint ranges, which may overlap.
+/// @param range_count The number of ranges.
+/// @param threads The number of threads to render with.
+/// @return 0 on success, -1 on error.
+/// @see glyph_set_finish()
+int glyph_set_load(struct glyph_set *set, const char *font_file, const struct glyph_range *ranges, size_t range_count, int threads);
+
+/// Frees the glyphs and their bitmaps.
+///
+/// @param set The set.
+/// @see glyph_set_load()
+void glyph_set_finish(struct glyph_set *set);
+
+#endif // SDL_BITS_INCLUDE_GLYPH_SET_H
@@ -0,0 +1,62 @@
+#ifndef SDL_BITS_INCLUDE_GOVERNOR_H
+#define SDL_BITS_INCLUDE_GOVERNOR_H
+
+#include <stddef.h>
+
+enum {
+    GOVERNOR_WINDOW = 64,  // Number of frame costs kept
+    GOVERNOR_PERIOD = 16,  // Frames between evaluations
+    GOVERNOR_HOLD = 4,     // Evaluations with headroom before stepping up
+    GOVERNOR_PERCENT = 95, // Percentile of the frame cost compared to the budget
+};
+
+/// Picks the frame rate from measured frame costs.
+///
+/// Rates are divisors of the display refresh rate, so that every frame is
+/// shown for the same number of refreshes.  The rate steps down as soon as
+/// the cost percentile overruns the budget, and steps up only after it has
+/// fit well within the faster rate's budget for GOVERNOR_HOLD evaluations
+/// in a row.
+struct governor {
+    int refresh_rate;              // Display refresh rate
+    int min_divisor;               // Divisor of the maximum rate
+    int idle_divisor;              // Divisor of the idle rate
+    int divisor;                   // Divisor of the current busy rate
+    double idle_timeout;           // Time without input before idling, in milliseconds
+    double since_input;            // Time since the last input, in milliseconds
+    double costs[GOVERNOR_WINDOW]; // Frame costs in milliseconds
+    size_t next;                   // Index of the next cost to write
+    size_t count;                  // Number of costs in the ring
+    size_t frames;                 // Frames since the last evaluation
+    int headroom;                  // Evaluations in a row with headroom
+};
+
+/// Initializes the governor at its maximum rate.
+///
+/// @param gov The governor.
+/// @param refresh_rate The display refresh rate.
+/// @param max_rate The maximum frame rate.
+/// @param idle_rate The frame rate without input.
+/// @param idle_timeout The time without input before idling, in milliseconds.
+void governor_init(struct governor *gov, int refresh_rate, int max_rate, int idle_rate, double idle_timeout);
+
+/// Notes that input arrived, leaving the idle rate.
+///
+/// @param gov The governor.
+void governor_input(struct governor *gov);
+
+/// Records a frame and returns the time to allot to the next one.
+///
+/// @param gov The governor.
+/// @param cost The time spent on the frame before pacing, in milliseconds.
+/// @param delta The time since the previous frame, in milliseconds.
+/// @return The frame time in milliseconds.
+double governor_frame(struct governor *gov, double cost, double delta);
+
+/// Returns the current frame rate.
+///
+/// @param gov The governor.
+/// @return The frame rate.
+double governor_rate(const struct governor *gov);
+
+#endif // SDL_BITS_INCLUDE_GOVERNOR_H
@@ -0,0 +1,75 @@
+#ifndef SDL_BITS_INCLUDE_GRID_H
+#define SDL_BITS_INCLUDE_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// A uniform grid of square cells indexing points by position.
+///
+/// Points are named by ids below the grid's capacity, such as entity slots.
+/// Each cell keeps an array of the ids in it, so moving a point within its
+/// cell only updates its position, and moving it to another cell touches
+/// just the two cells.  Points outside the grid's area are kept in the
+/// nearest edge cell.
+struct grid;
+
+/// Creates a new grid.
+///
+/// @param width The width of the area.
+/// @param height The height of the area.
+/// @param cell The width and height of a cell.
+/// @param cap The number of ids, which range over [0, cap).
+/// @return A pointer to a new grid, or NULL on error.
+/// @see grid_destroy()
+struct grid *grid_create(float width, float height, float cell, uint32_t cap);
+
+/// Frees resources associated with the grid.
+///
+/// @param grid The grid.
+/// @see grid_create()
+void grid_destroy(struct grid *grid);
+
+/// Removes every point, keeping the allocations.
+///
+/// @param grid The grid.
+void grid_clear(struct grid *grid);
+
+/// Inserts a point or moves it to a new position.
+///
+/// @param grid The grid.
+/// @param id The point.
+/// @param x The horizontal position.
+/// @param y The vertical position.
+/// @return 0 on success, -1 on error.
+int grid_move(struct grid *grid, uint32_t id, float x, float y);
+
+/// Removes a point, if present.
+///
+/// @param grid The grid.
+/// @param id The point.
+void grid_remove(struct grid *grid, uint32_t id);
+
+/// Finds the points in a rectangle, including its top and left edges.
+///
+/// @param grid The grid.
+/// @param x The left edge.
+/// @param y The top edge.
+/// @param w The width.
+/// @param h The height.
+/// @param out The array to write the ids to.
+/// @param cap The capacity of out.
+/// @return The number of points found, of which at most cap are written.
+size_t grid_query_rect(const struct grid *grid, float x, float y, float w, float h, uint32_t *out, size_t cap);
+
+/// Finds the points within a distance of a position.
+///
+/// @param grid The grid.
+/// @param x The horizontal position.
+/// @param y The vertical position.
+/// @param radius The distance.
+/// @param out The array to write the ids to.
+/// @param cap The capacity of out.
+/// @return The number of points found, of which at most cap are written.
+size_t grid_query_radius(const struct grid *grid, float x, float y, float radius, uint32_t *out, size_t cap);
+
+#endif // SDL_BITS_INCLUDE_GRID_H
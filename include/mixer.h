@@ -0,0 +1,136 @@
+#ifndef SDL_BITS_INCLUDE_MIXER_H
+#define SDL_BITS_INCLUDE_MIXER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct spsc_ring;
+
+/// A mono sound held in memory at the mixer's sample rate.
+///
+/// The samples are borrowed, and must outlive every voice playing them.
+struct mixer_sample {
+    const float *samples; // Samples, one per frame
+    size_t count;         // Number of samples
+    int loop;             // Whether to play from the start again at the end
+};
+
+/// Stereo frames produced ahead of the mixer by another thread, such as a
+/// reader prefetching a file.
+///
+/// The ring may have carried an earlier stream, whose frames the mixer
+/// skips.
+struct mixer_stream {
+    struct spsc_ring *ring;   // Frames of two floats, popped by the mixer
+    size_t start;             // Frames pushed to the ring before the stream's first
+    const atomic_size_t *end; // Frames pushed once the stream is over, or SIZE_MAX
+};
+
+/// A fixed pool of voices mixed into an interleaved stereo stream.
+///
+/// Each voice plays a sine, a sample or a stream at its own gain and pan.
+/// The main thread controls voices by index through a wait-free ring, and
+/// the audio callback mixes them with mixer_render(), which neither
+/// allocates nor locks.  Gain changes are ramped so they do not click, and the mix goes
+/// through a limiter so that many loud voices do not clip.
+struct mixer;
+
+/// Creates a new mixer.
+///
+/// @param sample_rate The sample rate in Hz.
+/// @param voices The number of voices.
+/// @param ramp The number of frames a gain change is spread over, at least 1.
+/// @return A pointer to a new mixer, or NULL on error.
+/// @see mixer_destroy()
+struct mixer *mixer_create(int sample_rate, size_t voices, uint32_t ramp);
+
+/// Frees resources associated with the mixer.
+///
+/// @param mixer The mixer.
+/// @see mixer_create()
+void mixer_destroy(struct mixer *mixer);
+
+/// Returns the number of voices.
+///
+/// @param mixer The mixer.
+/// @return The number of voices.
+size_t mixer_voices(const struct mixer *mixer);
+
+/// Returns the number of voices playing at the end of the last render.
+///
+/// @param mixer The mixer.
+/// @return The number of voices.
+size_t mixer_active(struct mixer *mixer);
+
+/// Returns the number of renders in which a stream ran dry.
+///
+/// @param mixer The mixer.
+/// @return The number of underruns.
+size_t mixer_underruns(struct mixer *mixer);
+
+/// Plays a sine on a voice, replacing what it played.  The phase starts at
+/// 0 only if the voice is silent.  Called by the controlling thread only.
+///
+/// @param mixer The mixer.
+/// @param voice The voice.
+/// @param frequency The frequency in Hz, below half the sample rate.
+/// @param gain The amplitude.
+/// @param pan The position from -1.0 (left) to 1.0 (right).
+/// @return 0 on success, -1 on error.
+int mixer_play_tone(struct mixer *mixer, size_t voice, double frequency, float gain, float pan);
+
+/// Plays a sample on a voice from its start, replacing what it played.
+/// Called by the controlling thread only.
+///
+/// @param mixer The mixer.
+/// @param voice The voice.
+/// @param sample The sample.
+/// @param gain The amplitude.
+/// @param pan The position from -1.0 (left) to 1.0 (right).
+/// @return 0 on success, -1 on error.
+int mixer_play_sample(struct mixer *mixer, size_t voice, const struct mixer_sample *sample, float gain, float pan);
+
+/// Plays a stream on a voice, replacing what it played.  Called by the
+/// controlling thread only.
+///
+/// A stream which runs dry before its end leaves the voice silent until
+/// frames arrive again, and counts as an underrun.  At a gain of 1.0 in
+/// the centre, a stream plays 3 dB down, as a mono voice does on each
+/// channel.
+///
+/// @param mixer The mixer.
+/// @param voice The voice.
+/// @param stream The stream, which must outlive the voice playing it.
+/// @param gain The amplitude.
+/// @param pan The balance from -1.0 (left) to 1.0 (right).
+/// @return 0 on success, -1 on error.
+int mixer_play_stream(struct mixer *mixer, size_t voice, const struct mixer_stream *stream, float gain, float pan);
+
+/// Changes the gain and pan of a voice.  Called by the controlling thread
+/// only.
+///
+/// @param mixer The mixer.
+/// @param voice The voice.
+/// @param gain The amplitude.
+/// @param pan The position from -1.0 (left) to 1.0 (right).
+/// @return 0 on success, -1 on error.
+int mixer_set_gain(struct mixer *mixer, size_t voice, float gain, float pan);
+
+/// Fades a voice out, after which it is idle.  Called by the controlling
+/// thread only.
+///
+/// @param mixer The mixer.
+/// @param voice The voice.
+/// @return 0 on success, -1 on error.
+int mixer_stop(struct mixer *mixer, size_t voice);
+
+/// Applies pending commands and writes the mix of every voice.  Called by
+/// the audio thread only.
+///
+/// @param mixer The mixer.
+/// @param out The frames to write, two samples each.
+/// @param frames The number of frames.
+void mixer_render(struct mixer *mixer, float *out, size_t frames);
+
+#endif // SDL_BITS_INCLUDE_MIXER_H
@@ -0,0 +1,45 @@
+#ifndef SDL_BITS_INCLUDE_MONO_BITMAP_H
+#define SDL_BITS_INCLUDE_MONO_BITMAP_H
+
+#include <limits.h>
+#include <stddef.h>
+
+#include "bmp.h"
+
+/// The eight pixels each value of a byte of a one-bit-per-pixel bitmap
+/// expands to, the most significant bit leftmost.
+struct mono_bitmap_lut {
+    bmp_pixel32 pixels[1 << CHAR_BIT][CHAR_BIT];
+};
+
+/// Tabulates the pixels for a pair of colors.
+///
+/// @param lut The table.
+/// @param on The color of set bits.
+/// @param off The color of clear bits.
+void mono_bitmap_lut_init(struct mono_bitmap_lut *lut, bmp_pixel32 on, bmp_pixel32 off);
+
+/// Fills an image with one color.
+///
+/// @param image The pixels.
+/// @param count The number of pixels.
+/// @param color The color.
+void mono_bitmap_fill(bmp_pixel32 *image, size_t count, bmp_pixel32 color);
+
+/// Expands a one-bit-per-pixel bitmap into a region of an image stored
+/// bottom row first, as a BMP is, a byte of the bitmap at a time.
+///
+/// @param lut The table of the colors.
+/// @param bits The rows of the bitmap, top first, most significant bit leftmost.
+/// @param pitch The bytes per row of the bitmap.
+/// @param width The width of the bitmap.
+/// @param rows The height of the bitmap.
+/// @param image The pixels of the image, bottom row first.
+/// @param image_width The width of the image.
+/// @param image_height The height of the image.
+/// @param x The left edge of the region.
+/// @param y The top edge of the region, counted from the top of the image.
+void mono_bitmap_expand(const struct mono_bitmap_lut *lut, const unsigned char *bits, size_t pitch, size_t width,
+                        size_t rows, bmp_pixel32 *image, size_t image_width, size_t image_height, size_t x, size_t y);
+
+#endif // SDL_BITS_INCLUDE_MONO_BITMAP_H
@@ -0,0 +1,40 @@
+#ifndef SDL_BITS_INCLUDE_OSCILLATOR_H
+#define SDL_BITS_INCLUDE_OSCILLATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// A sine oscillator driven by a wrapping phase accumulator.
+///
+/// The phase is a 32-bit fraction of a turn, so it wraps exactly and keeps
+/// the same precision however long the oscillator runs.
+struct oscillator {
+    uint32_t phase;     // Current phase, in 2^-32 turns
+    uint32_t increment; // Phase advance per sample
+};
+
+/// Initializes the oscillator at phase 0.
+///
+/// @param osc The oscillator.
+/// @param frequency The frequency in Hz, below half the sample rate.
+/// @param sample_rate The sample rate in Hz.
+void oscillator_init(struct oscillator *osc, double frequency, int sample_rate);
+
+/// Changes the frequency, keeping the phase.
+///
+/// @param osc The oscillator.
+/// @param frequency The frequency in Hz, below half the sample rate.
+/// @param sample_rate The sample rate in Hz.
+void oscillator_set_frequency(struct oscillator *osc, double frequency, int sample_rate);
+
+/// Writes samples of the sine wave and advances the phase.
+///
+/// The sine is approximated by a polynomial to within 4e-6.
+///
+/// @param osc The oscillator.
+/// @param out The samples to write.
+/// @param n The number of samples.
+/// @param gain The amplitude.
+void oscillator_sine(struct oscillator *osc, float *out, size_t n, float gain);
+
+#endif // SDL_BITS_INCLUDE_OSCILLATOR_H
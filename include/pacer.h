@@ -0,0 +1,87 @@
+#ifndef SDL_BITS_INCLUDE_PACER_H
+#define SDL_BITS_INCLUDE_PACER_H
+
+#include <stdint.h>
+
+/// Statistics of the time between presents, in milliseconds.
+struct pacer_stats {
+    uint64_t count;  // Number of intervals
+    double mean;     // Mean interval
+    double stddev;   // Standard deviation of the interval
+    double min;      // Shortest interval
+    double max;      // Longest interval
+    uint64_t missed; // Deadlines which had passed when asked for
+};
+
+/// Places frame deadlines on the display's refresh cadence.
+///
+/// Deadlines lie on a grid of refresh periods anchored at the first
+/// deadline, so that pacing does not drift against the display.  Each
+/// frame lasts a whole number of refreshes.  All times are in milliseconds
+/// from an arbitrary epoch.
+struct pacer {
+    double period;       // Refresh period
+    double deadline;     // Last deadline handed out
+    int started;         // Whether deadline is valid
+    double last_present; // Time of the last present
+    int presented;       // Whether last_present is valid
+    uint64_t count;      // Number of measured intervals
+    double mean;         // Running mean of the intervals
+    double m2;           // Running sum of squared differences from the mean
+    double min;          // Shortest interval
+    double max;          // Longest interval
+    uint64_t missed;     // Deadlines which had passed when asked for
+};
+
+/// Initializes the pacer.
+///
+/// @param pacer The pacer.
+/// @param refresh_rate The display refresh rate.
+void pacer_init(struct pacer *pacer, int refresh_rate);
+
+/// Changes the refresh rate, restarting the grid and the statistics.
+///
+/// @param pacer The pacer.
+/// @param refresh_rate The display refresh rate.
+void pacer_set_refresh(struct pacer *pacer, int refresh_rate);
+
+/// Returns the number of refreshes a frame of the given length should last.
+///
+/// Rounds up, so frames are never shorter than asked for.
+///
+/// @param pacer The pacer.
+/// @param frame_time The desired frame time.
+/// @return The number of refreshes, at least 1.
+int pacer_divisor(const struct pacer *pacer, double frame_time);
+
+/// Returns the deadline of the current frame.
+///
+/// The deadline is one frame after the previous one.  If that has already
+/// passed, it moves to the next refresh on the grid instead.
+///
+/// @param pacer The pacer.
+/// @param now The current time.
+/// @param frame_time The desired frame time.
+/// @return The deadline.
+double pacer_next(struct pacer *pacer, double now, double frame_time);
+
+/// Records that a frame was presented.
+///
+/// @param pacer The pacer.
+/// @param now The time the present returned.
+void pacer_present(struct pacer *pacer, double now);
+
+/// Records that a frame was not presented, so the next present starts a
+/// new interval.
+///
+/// @param pacer The pacer.
+void pacer_skip(struct pacer *pacer);
+
+/// Calculates the statistics of the intervals between presents.
+///
+/// @param pacer The pacer.
+/// @param stats The statistics to fill.
+/// @return 0 on success, -1 if no intervals have been measured.
+int pacer_stats(const struct pacer *pacer, struct pacer_stats *stats);
+
+#endif // SDL_BITS_INCLUDE_PACER_H
@@ -0,0 +1,31 @@
+#ifndef SDL_BITS_INCLUDE_PIXELS_H
+#define SDL_BITS_INCLUDE_PIXELS_H
+
+#include <stddef.h>
+
+#include "bmp.h"
+
+/// Sets a row of pixels to one color.
+///
+/// @param dst The first pixel.
+/// @param color The color.
+/// @param n The number of pixels.
+void pixels_fill(bmp_pixel32 *dst, bmp_pixel32 color, size_t n);
+
+/// Copies a row of pixels.
+///
+/// @param dst The first destination pixel.
+/// @param src The first source pixel.  Must not overlap dst.
+/// @param n The number of pixels.
+void pixels_copy(bmp_pixel32 *restrict dst, const bmp_pixel32 *restrict src, size_t n);
+
+/// Blends a row of pixels over another with their straight alpha.
+///
+/// The destination is treated as opaque, so the result is too.
+///
+/// @param dst The first destination pixel.
+/// @param src The first source pixel.  Must not overlap dst.
+/// @param n The number of pixels.
+void pixels_blend(bmp_pixel32 *restrict dst, const bmp_pixel32 *restrict src, size_t n);
+
+#endif // SDL_BITS_INCLUDE_PIXELS_H
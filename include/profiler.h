@@ -0,0 +1,131 @@
+#ifndef SDL_BITS_INCLUDE_PROFILER_H
+#define SDL_BITS_INCLUDE_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROFILER_PHASE_VARIANTS           \
+    X(PHASE_EVENTS, 0, "events")          \
+    X(PHASE_UPDATE, 1, "update")          \
+    X(PHASE_RENDER_CLEAR, 2, "clear")     \
+    X(PHASE_RENDER_RASTER, 3, "raster")   \
+    X(PHASE_RENDER_COPY, 4, "copy")       \
+    X(PHASE_RENDER_PRESENT, 5, "present") \
+    X(PHASE_DELAY, 6, "delay")
+
+enum profiler_phase {
+#define X(variant, i, str) variant = (i),
+    PROFILER_PHASE_VARIANTS
+#undef X
+    PHASE_MAX,
+    PHASE_FRAME = PHASE_MAX, // Pseudo-phase holding the total frame time
+};
+
+enum {
+    PROFILER_FRAMES = 256, // Number of frames kept in the ring
+};
+
+/// Per-frame phase timings, in performance counter ticks.
+struct profiler_frame {
+    uint64_t ticks[PHASE_MAX + 1];
+};
+
+/// A fixed-size ring of per-frame phase timings.
+struct profiler {
+    int enabled;                                   // Whether timings are recorded
+    uint64_t frame_begin;                          // Timestamp of the current frame start
+    uint64_t phase_begin[PHASE_MAX];               // Timestamps of the open phases
+    struct profiler_frame current;                 // Timings of the current frame
+    struct profiler_frame frames[PROFILER_FRAMES]; // Timings of completed frames
+    size_t next;                                   // Index of the next frame to write
+    size_t count;                                  // Number of completed frames in the ring
+};
+
+/// Rolling statistics for a single phase, in milliseconds.
+struct profiler_stats {
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
+/// Returns the name of a phase.
+///
+/// @param phase A phase, or PHASE_FRAME.
+/// @return The name of the phase, or NULL if the phase is invalid.
+const char *profiler_phase_str(enum profiler_phase phase);
+
+// Out-of-line halves of the inline functions below.  Call those instead.
+
+void profiler_begin_slow(struct profiler *prof, enum profiler_phase phase);
+
+void profiler_end_slow(struct profiler *prof, enum profiler_phase phase);
+
+void profiler_frame_slow(struct profiler *prof);
+
+/// Marks the start of a phase.
+///
+/// @param prof The profiler.
+/// @param phase The phase.
+static inline void profiler_begin(struct profiler *prof, enum profiler_phase phase)
+{
+    if (prof->enabled) {
+        profiler_begin_slow(prof, phase);
+    }
+}
+
+/// Marks the end of a phase.  A phase may be entered more than once per frame.
+///
+/// @param prof The profiler.
+/// @param phase The phase.
+static inline void profiler_end(struct profiler *prof, enum profiler_phase phase)
+{
+    if (prof->enabled) {
+        profiler_end_slow(prof, phase);
+    }
+}
+
+/// Completes the current frame, pushing its timings into the ring.
+///
+/// @param prof The profiler.
+static inline void profiler_frame(struct profiler *prof)
+{
+    if (prof->enabled) {
+        profiler_frame_slow(prof);
+    }
+}
+
+/// Times the statement or block that follows it as the given phase.
+///
+/// The block must not be left by return, break or goto.
+#define PROFILE_SCOPE(prof, phase)                               \
+    for (int scope_once_ = (profiler_begin((prof), (phase)), 1); \
+         scope_once_;                                            \
+         scope_once_ = (profiler_end((prof), (phase)), 0))
+
+/// Enables or disables recording.  Enabling starts a new frame and drops
+/// the frames recorded before.
+///
+/// Call it between frames, with no phase open, since a phase begun before
+/// enabling would otherwise end with no begin timestamp.
+///
+/// @param prof The profiler.
+/// @param enabled Whether to record timings.
+void profiler_enable(struct profiler *prof, int enabled);
+
+/// Calculates rolling statistics for a phase over the frames in the ring.
+///
+/// @param prof The profiler.
+/// @param phase A phase, or PHASE_FRAME.
+/// @param stats The statistics to fill.
+/// @return 0 on success, -1 if no frames have been recorded.
+int profiler_stats(const struct profiler *prof, enum profiler_phase phase, struct profiler_stats *stats);
+
+/// Writes the frames in the ring and their statistics to a CSV file.
+///
+/// @param prof The profiler.
+/// @param file Path to the output file.
+/// @return 0 on success, -1 on error.
+int profiler_dump(const struct profiler *prof, const char *file);
+
+#endif // SDL_BITS_INCLUDE_PROFILER_H
@@ -0,0 +1,37 @@
+#ifndef SDL_BITS_INCLUDE_RAMP_H
+#define SDL_BITS_INCLUDE_RAMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// A gain which moves linearly to each new target over a fixed number of
+/// frames, so that changes do not click.
+struct ramp {
+    float value;        // Gain of the last frame
+    float target;       // Gain being moved to
+    float step;         // Change per frame while moving
+    uint32_t remaining; // Frames left to reach target
+    uint32_t length;    // Frames a change is spread over
+};
+
+/// Initializes the ramp at rest.
+///
+/// @param ramp The ramp.
+/// @param value The initial gain.
+/// @param length The number of frames a change is spread over, at least 1.
+void ramp_init(struct ramp *ramp, float value, uint32_t length);
+
+/// Starts moving to a new gain, from wherever the ramp is.  Does nothing
+/// if the gain is already the target.
+///
+/// @param ramp The ramp.
+/// @param target The new gain.
+void ramp_set(struct ramp *ramp, float target);
+
+/// Advances the ramp one frame.
+///
+/// @param ramp The ramp.
+/// @return The gain of the frame.
+float ramp_step(struct ramp *ramp);
+
+#endif // SDL_BITS_INCLUDE_RAMP_H
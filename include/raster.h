@@ -0,0 +1,87 @@
+#ifndef SDL_BITS_INCLUDE_RASTER_H
+#define SDL_BITS_INCLUDE_RASTER_H
+
+#include <SDL.h>
+
+#include "bmp.h"
+#include "worker_pool.h"
+
+enum {
+    RASTER_TILE = 64, // Width and height of a tile in pixels
+};
+
+/// Pixels read by raster_blit() and raster_blend().
+struct raster_image {
+    const bmp_pixel32 *pixels; // The first pixel of the top row
+    int width;                 // Width in pixels
+    int height;                // Height in pixels
+    int pitch;                 // Distance between rows in pixels
+};
+
+/// A CPU framebuffer in bmp_pixel32 layout, rasterized in tiles by a worker
+/// pool.
+///
+/// Drawing functions only record commands.  raster_draw() runs them, with
+/// each tile rasterized by one thread, and uploads the result.
+struct raster;
+
+/// Creates a new raster.
+///
+/// @param width The width in pixels.
+/// @param height The height in pixels.
+/// @param pool The pool to rasterize with.  Must outlive the raster.
+/// @return A pointer to a new raster, or NULL on error.
+/// @see raster_destroy()
+struct raster *raster_create(int width, int height, struct worker_pool *pool);
+
+/// Frees resources associated with the raster.
+///
+/// @param raster The raster.
+/// @see raster_create()
+void raster_destroy(struct raster *raster);
+
+/// Records filling a rectangle with a color.
+///
+/// @param raster The raster.
+/// @param rect The rectangle, or NULL for the whole raster.
+/// @param color The color, written as is.
+/// @return 0 on success, -1 on error.
+int raster_fill(struct raster *raster, const SDL_Rect *rect, bmp_pixel32 color);
+
+/// Records copying part of an image.
+///
+/// @param raster The raster.
+/// @param image The image.  Its pixels must be valid until raster_draw().
+/// @param src The part of the image, or NULL for all of it.
+/// @param x The left edge of the destination.
+/// @param y The top edge of the destination.
+/// @return 0 on success, -1 on error.
+int raster_blit(struct raster *raster, const struct raster_image *image, const SDL_Rect *src, int x, int y);
+
+/// Records blending part of an image over the raster with its alpha.
+///
+/// @param raster The raster.
+/// @param image The image.  Its pixels must be valid until raster_draw().
+/// @param src The part of the image, or NULL for all of it.
+/// @param x The left edge of the destination.
+/// @param y The top edge of the destination.
+/// @return 0 on success, -1 on error.
+int raster_blend(struct raster *raster, const struct raster_image *image, const SDL_Rect *src, int x, int y);
+
+/// Runs the recorded commands and clears them.
+///
+/// If a texture is given, each thread copies its finished tiles into it, so
+/// the texture is locked once per frame.
+///
+/// @param raster The raster.
+/// @param texture A streaming ARGB8888 texture of the raster's size, or NULL.
+/// @return 0 on success, -1 on error.
+int raster_draw(struct raster *raster, SDL_Texture *texture);
+
+/// Returns the raster's pixels, as left by the last raster_draw().
+///
+/// @param raster The raster.
+/// @return The first pixel of the top row.  Rows are the raster's width apart.
+const bmp_pixel32 *raster_pixels(const struct raster *raster);
+
+#endif // SDL_BITS_INCLUDE_RASTER_H
@@ -0,0 +1,197 @@
+#ifndef SDL_BITS_INCLUDE_RENDER_LIST_H
+#define SDL_BITS_INCLUDE_RENDER_LIST_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include <SDL.h>
+
+#include "sprite_batch.h"
+#include "text.h"
+
+enum render_op {
+    RENDER_CLEAR,
+    RENDER_COPY,
+    RENDER_FILL,
+    RENDER_SPRITE,
+    RENDER_TEXT,
+    RENDER_CALL,
+};
+
+/// A function run on the render thread by RENDER_CALL.
+///
+/// @param renderer The renderer.
+/// @param data The data passed to render_list_call().
+/// @return 0 on success, -1 on error.
+typedef int render_fn(SDL_Renderer *renderer, void *data);
+
+struct render_command {
+    enum render_op op;
+    SDL_Texture *texture; // Texture of a copy or sprite
+    SDL_Rect src;         // Source rectangle of a copy or sprite
+    int has_src;          // Whether src is used, or the whole texture
+    SDL_Rect dst;         // Destination of a copy or fill
+    SDL_FRect fdst;       // Destination of a sprite
+    SDL_Color color;      // Color of a clear, fill, sprite or text
+    struct text *text;    // Text object of a text
+    int x;                // Left edge of a text
+    int y;                // Top edge of a text
+    size_t str;           // Offset of a text's string in strings
+    render_fn *fn;        // Function of a call
+    void *data;           // Data of a call
+};
+
+/// The drawing commands of one frame, recorded on one thread and replayed
+/// against an SDL_Renderer on another.
+struct render_list {
+    struct render_command *commands; // Recorded commands
+    size_t count;                    // Number of recorded commands
+    size_t cap;                      // Capacity of commands
+    char *strings;                   // Copies of the strings of text commands
+    size_t strings_len;              // Bytes used in strings
+    size_t strings_cap;              // Capacity of strings
+};
+
+/// Preallocates a list.
+///
+/// The list grows if a frame needs more, so the capacities only need to
+/// cover a typical frame.
+///
+/// @param list The list.
+/// @param cap The number of commands.
+/// @param strings_cap The number of bytes of text.
+/// @return 0 on success, -1 on error.
+/// @see render_list_finish()
+int render_list_init(struct render_list *list, size_t cap, size_t strings_cap);
+
+/// Frees resources associated with the list.
+///
+/// @param list The list.
+/// @see render_list_init()
+void render_list_finish(struct render_list *list);
+
+/// Removes all commands, keeping the allocations.
+///
+/// @param list The list.
+void render_list_reset(struct render_list *list);
+
+/// Records clearing the render target.
+///
+/// @param list The list.
+/// @param color The color to clear to.
+/// @return 0 on success, -1 on error.
+int render_list_clear(struct render_list *list, SDL_Color color);
+
+/// Records copying a texture.
+///
+/// @param list The list.
+/// @param texture The texture.  Must outlive the replay.
+/// @param src The source rectangle, or NULL for the whole texture.
+/// @param dst The destination rectangle.
+/// @return 0 on success, -1 on error.
+int render_list_copy(struct render_list *list, SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst);
+
+/// Records filling a rectangle, blended with its alpha.
+///
+/// @param list The list.
+/// @param rect The rectangle.
+/// @param color The color.
+/// @return 0 on success, -1 on error.
+int render_list_fill(struct render_list *list, const SDL_Rect *rect, SDL_Color color);
+
+/// Records a batched sprite.
+///
+/// @param list The list.
+/// @param texture The texture.  Must outlive the replay.
+/// @param src The source rectangle.
+/// @param dst The destination rectangle.
+/// @param color The color to modulate the texture with.
+/// @return 0 on success, -1 on error.
+int render_list_sprite(struct render_list *list, SDL_Texture *texture,
+                       const SDL_Rect *src, const SDL_FRect *dst, SDL_Color color);
+
+/// Records drawing a string.  The string is copied.
+///
+/// The text object is only drawn with during the replay, so it must not be
+/// drawn with on the recording thread.
+///
+/// @param list The list.
+/// @param text The text object.  Must outlive the replay.
+/// @param x The left edge of the string.
+/// @param y The top edge of the string.
+/// @param color The color of the string.
+/// @param str The string.
+/// @return 0 on success, -1 on error.
+int render_list_text(struct render_list *list, struct text *text, int x, int y, SDL_Color color, const char *str);
+
+/// Records a call to a function on the replaying thread.
+///
+/// @param list The list.
+/// @param fn The function.
+/// @param data The data to pass to fn.  Must outlive the replay.
+/// @return 0 on success, -1 on error.
+int render_list_call(struct render_list *list, render_fn *fn, void *data);
+
+/// Replays the commands, without presenting.
+///
+/// Sprites and text are batched until the next command of another kind.
+///
+/// @param list The list.
+/// @param renderer The renderer.
+/// @param batch The batch to draw sprites and text with.
+/// @return 0 on success, -1 on error.
+int render_list_replay(const struct render_list *list, SDL_Renderer *renderer, struct sprite_batch *batch);
+
+/// Three render lists handed from a recording thread to a replaying thread.
+///
+/// The recording thread always has a list to write, the replaying thread
+/// always has one to read, and the third holds the newest completed frame.
+/// Neither thread waits for the other to finish a list.  Frames completed
+/// faster than they are replayed are dropped, oldest first.
+struct render_queue {
+    struct render_list lists[3]; // The lists
+    int writing;                 // Index of the recording thread's list
+    int reading;                 // Index of the replaying thread's list
+    atomic_int ready;            // Index of the newest completed list, flagged until taken
+    atomic_int closed;           // Whether render_queue_close() was called
+    SDL_sem *published;          // Posted when a list is completed or the queue closes
+};
+
+/// Preallocates a queue.
+///
+/// @param queue The queue.
+/// @param cap The number of commands per list.
+/// @param strings_cap The number of bytes of text per list.
+/// @return 0 on success, -1 on error.
+/// @see render_queue_finish()
+int render_queue_init(struct render_queue *queue, size_t cap, size_t strings_cap);
+
+/// Frees resources associated with the queue.
+///
+/// @param queue The queue.
+/// @see render_queue_init()
+void render_queue_finish(struct render_queue *queue);
+
+/// Returns the recording thread's list, emptied.
+///
+/// @param queue The queue.
+/// @return The list to record into.
+struct render_list *render_queue_begin(struct render_queue *queue);
+
+/// Completes the recording thread's list, making it the newest frame.
+///
+/// @param queue The queue.
+void render_queue_publish(struct render_queue *queue);
+
+/// Waits for a frame newer than the last one returned.
+///
+/// @param queue The queue.
+/// @return The list to replay, or NULL once the queue is closed.
+const struct render_list *render_queue_wait(struct render_queue *queue);
+
+/// Wakes the replaying thread and makes render_queue_wait() return NULL.
+///
+/// @param queue The queue.
+void render_queue_close(struct render_queue *queue);
+
+#endif // SDL_BITS_INCLUDE_RENDER_LIST_H
@@ -0,0 +1,65 @@
+#ifndef SDL_BITS_INCLUDE_RESAMPLER_H
+#define SDL_BITS_INCLUDE_RESAMPLER_H
+
+#include <stddef.h>
+
+enum {
+    RESAMPLER_TAPS = 64,         // Input frames each output frame is filtered from
+    RESAMPLER_BLOCK = 256,       // Input frames buffered at a time
+    RESAMPLER_MAX_PHASES = 1024, // Most phases of the filter, the reduced output rate
+};
+
+/// Converts interleaved stereo frames from one sample rate to another.
+///
+/// The rates are reduced to a ratio of up / down, and a windowed-sinc
+/// lowpass is tabulated at each of the up phases an output frame can fall
+/// between two input frames.  Each output frame is then a dot product of
+/// one phase's taps with the input frames around it, which carries no
+/// state from one frame to the next, so the input can arrive in pieces
+/// of any size.
+///
+/// The cutoff is just under the lower of the two Nyquist frequencies.
+/// Output frame k falls at input frame k * down / up, so the stream is not
+/// delayed, but an output frame is only produced once the input frames
+/// half the taps ahead of it have arrived.
+struct resampler {
+    size_t up;             // Output frames per down input frames
+    size_t down;           // Input frames per up output frames
+    float *coefficients;   // Taps of each phase, each duplicated for both channels
+    float *frames;         // Buffered input frames, leading with the history
+    size_t filled;         // Number of frames buffered
+    size_t position;       // First buffered frame of the next output's taps
+    size_t phase;          // Phase of the next output, in 1 / up of a frame
+};
+
+/// Tabulates the filter for a pair of rates.
+///
+/// @param resampler The resampler.
+/// @param from The input sample rate.
+/// @param to The output sample rate.
+/// @return 0 on success, -1 on error or if the ratio needs too many phases.
+/// @see resampler_finish()
+int resampler_init(struct resampler *resampler, int from, int to);
+
+/// Frees the tables and buffers.
+///
+/// @param resampler The resampler.
+/// @see resampler_init()
+void resampler_finish(struct resampler *resampler);
+
+/// Forgets the input so far, as if at the start of a new stream.
+///
+/// @param resampler The resampler.
+void resampler_reset(struct resampler *resampler);
+
+/// Converts as many frames as the input and the output allow.
+///
+/// @param resampler The resampler.
+/// @param in The input frames, two samples each.
+/// @param in_frames The number of input frames, and on return the number used.
+/// @param out The output frames to write, two samples each.
+/// @param out_frames The most output frames to write.
+/// @return The number of output frames written.
+size_t resampler_process(struct resampler *resampler, const float *in, size_t *in_frames, float *out, size_t out_frames);
+
+#endif // SDL_BITS_INCLUDE_RESAMPLER_H
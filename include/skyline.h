@@ -0,0 +1,53 @@
+#ifndef SDL_BITS_INCLUDE_SKYLINE_H
+#define SDL_BITS_INCLUDE_SKYLINE_H
+
+#include <stddef.h>
+
+/// A run of columns packed down to the same row.
+struct skyline_segment {
+    int x;     // Left edge
+    int y;     // First free row
+    int width; // Number of columns
+};
+
+/// Packs rectangles into a page, keeping the lower edge of what is packed
+/// as a skyline: a list of segments from left to right, each at the
+/// first free row of its columns.
+///
+/// Each rectangle goes where its bottom edge ends up highest, and among
+/// those where it leaves the least space beneath it unusable, so that
+/// rectangles inserted tallest first fill the page in dense rows.
+struct skyline {
+    int width;                        // Width of the page
+    int height;                       // Height of the page
+    struct skyline_segment *segments; // Segments from left to right
+    size_t count;                     // Number of segments
+    long area;                        // Area of the rectangles packed
+};
+
+/// Initializes an empty page.
+///
+/// @param sky The skyline.
+/// @param width The width of the page.
+/// @param height The height of the page.
+/// @return 0 on success, -1 on error.
+/// @see skyline_finish()
+int skyline_init(struct skyline *sky, int width, int height);
+
+/// Frees the segments.
+///
+/// @param sky The skyline.
+/// @see skyline_init()
+void skyline_finish(struct skyline *sky);
+
+/// Places a rectangle.
+///
+/// @param sky The skyline.
+/// @param width The width of the rectangle.
+/// @param height The height of the rectangle.
+/// @param x The left edge of the placed rectangle.
+/// @param y The top edge of the placed rectangle.
+/// @return 0 on success, -1 if the rectangle does not fit.
+int skyline_insert(struct skyline *sky, int width, int height, int *x, int *y);
+
+#endif // SDL_BITS_INCLUDE_SKYLINE_H
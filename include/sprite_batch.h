@@ -0,0 +1,52 @@
+#ifndef SDL_BITS_INCLUDE_SPRITE_BATCH_H
+#define SDL_BITS_INCLUDE_SPRITE_BATCH_H
+
+#include <SDL.h>
+
+/// Accumulates textured quads and submits them with one SDL_RenderGeometry
+/// call per texture.
+struct sprite_batch;
+
+/// Creates a new batch with preallocated vertex and index arrays.
+///
+/// @param renderer The renderer to submit to.
+/// @param capacity The maximum number of quads per submission.
+/// @return A pointer to a new sprite_batch, or NULL on error.
+/// @see sprite_batch_destroy()
+struct sprite_batch *sprite_batch_create(SDL_Renderer *renderer, int capacity);
+
+/// Frees resources associated with the batch.
+///
+/// Quads which have not been flushed are discarded.
+///
+/// @param batch The batch.
+/// @see sprite_batch_create()
+void sprite_batch_destroy(struct sprite_batch *batch);
+
+/// Adds a quad to the batch.
+///
+/// Submits the pending quads first if the texture differs from theirs or
+/// the batch is full.
+///
+/// @param batch The batch.
+/// @param texture The texture to sample.
+/// @param src The source rectangle in texels.
+/// @param dst The destination rectangle in pixels.
+/// @param color The color to modulate the texture with.
+/// @return 0 on success, -1 on error.
+int sprite_batch_draw(struct sprite_batch *batch, SDL_Texture *texture,
+                      const SDL_Rect *src, const SDL_FRect *dst, SDL_Color color);
+
+/// Submits the pending quads.
+///
+/// @param batch The batch.
+/// @return 0 on success, -1 on error.
+int sprite_batch_flush(struct sprite_batch *batch);
+
+/// Returns the number of SDL_RenderGeometry calls made since the last call.
+///
+/// @param batch The batch.
+/// @return The number of submissions.
+int sprite_batch_submissions(struct sprite_batch *batch);
+
+#endif // SDL_BITS_INCLUDE_SPRITE_BATCH_H
@@ -0,0 +1,70 @@
+#ifndef SDL_BITS_INCLUDE_SPSC_RING_H
+#define SDL_BITS_INCLUDE_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/// A wait-free ring of fixed-size items between one producing thread and
+/// one consuming thread.
+///
+/// Neither side ever blocks or allocates, so either may be a real-time
+/// thread such as the audio callback.
+struct spsc_ring {
+    unsigned char *items; // Storage for cap items
+    size_t size;          // Size of an item in bytes
+    size_t cap;           // Capacity in items, a power of two
+    atomic_size_t head;   // Items ever pushed, written by the producer
+    atomic_size_t tail;   // Items ever popped, written by the consumer
+};
+
+/// Allocates a ring.
+///
+/// @param ring The ring.
+/// @param size The size of an item in bytes.
+/// @param cap The capacity in items, a power of two.
+/// @return 0 on success, -1 on error.
+/// @see spsc_ring_finish()
+int spsc_ring_init(struct spsc_ring *ring, size_t size, size_t cap);
+
+/// Frees resources associated with the ring.
+///
+/// @param ring The ring.
+/// @see spsc_ring_init()
+void spsc_ring_finish(struct spsc_ring *ring);
+
+/// Appends as many items as fit.  Called by the producer only.
+///
+/// @param ring The ring.
+/// @param items The items.
+/// @param n The number of items.
+/// @return The number of items appended.
+size_t spsc_ring_push(struct spsc_ring *ring, const void *items, size_t n);
+
+/// Removes up to n of the oldest items.  Called by the consumer only.
+///
+/// @param ring The ring.
+/// @param items The array to copy the items to.
+/// @param n The capacity of items.
+/// @return The number of items removed.
+size_t spsc_ring_pop(struct spsc_ring *ring, void *items, size_t n);
+
+/// Discards up to n of the oldest items.  Called by the consumer only.
+///
+/// @param ring The ring.
+/// @param n The number of items.
+/// @return The number of items discarded.
+size_t spsc_ring_drop(struct spsc_ring *ring, size_t n);
+
+/// Returns the number of items the consumer can pop.
+///
+/// @param ring The ring.
+/// @return The number of items.
+size_t spsc_ring_readable(struct spsc_ring *ring);
+
+/// Returns the number of items the producer can push.
+///
+/// @param ring The ring.
+/// @return The number of items.
+size_t spsc_ring_writable(struct spsc_ring *ring);
+
+#endif // SDL_BITS_INCLUDE_SPSC_RING_H
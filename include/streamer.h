@@ -0,0 +1,61 @@
+#ifndef SDL_BITS_INCLUDE_STREAMER_H
+#define SDL_BITS_INCLUDE_STREAMER_H
+
+#include <stddef.h>
+
+#include "mixer.h"
+
+/// A thread which reads WAV files ahead of the mixer.
+///
+/// Each stream has a ring of converted stereo frames, allocated and
+/// touched up front.  The thread keeps the rings topped up from the mapped
+/// files, asking the kernel to read ahead of what it converts, so the
+/// audio callback only ever copies from memory which is already resident
+/// and never waits on the disk.  Files at another sample rate than the
+/// mixer's are resampled by the thread as they are converted.
+struct streamer;
+
+/// Creates a new streamer and starts its thread.
+///
+/// @param sample_rate The sample rate of the mixer in Hz.
+/// @param streams The number of streams.
+/// @param frames The capacity of each stream's ring in frames, a power of two.
+/// @return A pointer to a new streamer, or NULL on error.
+/// @see streamer_destroy()
+struct streamer *streamer_create(int sample_rate, size_t streams, size_t frames);
+
+/// Stops the thread and frees resources associated with the streamer.
+///
+/// Voices playing its streams must be stopped first.
+///
+/// @param streamer The streamer.
+/// @see streamer_create()
+void streamer_destroy(struct streamer *streamer);
+
+/// Opens a WAV file on a closed stream and starts reading it.  Called by
+/// the controlling thread only.
+///
+/// @param streamer The streamer.
+/// @param stream The stream.
+/// @param file The name of the file.
+/// @param loop Whether to play from the start again at the end.
+/// @param out The stream to play with mixer_play_stream().
+/// @return 0 on success, -1 on error or if the stream is still closing.
+int streamer_open(struct streamer *streamer, size_t stream, const char *file, int loop, struct mixer_stream *out);
+
+/// Closes a stream.  The stream can be opened again once the thread has
+/// let go of its file, which streamer_idle() tells.  Called by the
+/// controlling thread only.
+///
+/// @param streamer The streamer.
+/// @param stream The stream.
+void streamer_close(struct streamer *streamer, size_t stream);
+
+/// Returns whether a stream is closed and may be opened.
+///
+/// @param streamer The streamer.
+/// @param stream The stream.
+/// @return 1 if the stream is closed, 0 if it is open or still closing.
+int streamer_idle(const struct streamer *streamer, size_t stream);
+
+#endif // SDL_BITS_INCLUDE_STREAMER_H
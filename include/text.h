@@ -0,0 +1,61 @@
+#ifndef SDL_BITS_INCLUDE_TEXT_H
+#define SDL_BITS_INCLUDE_TEXT_H
+
+#include <SDL.h>
+
+#include "sprite_batch.h"
+
+/// Text drawn from a bitmap glyph atlas
+struct text;
+
+/// Loads a glyph atlas and creates a texture from it.
+///
+/// If the glyph index that generate_atlas_from_bdf writes beside an atlas
+/// is there, the ASCII glyphs' rectangles, bearings and advances are taken
+/// from it, and the atlas may be the first page of a packed atlas.
+/// Otherwise the atlas must be the single row of 10x20 glyphs written by
+/// default.
+///
+/// @param renderer The renderer.
+/// @param path The path to the atlas bitmap.
+/// @return A pointer to a new text object, or NULL on error.
+/// @see text_destroy()
+struct text *text_create(SDL_Renderer *renderer, const char *path);
+
+/// Frees resources associated with the text object.
+///
+/// @param text The text object.
+/// @see text_create()
+void text_destroy(struct text *text);
+
+/// Sets the color used by subsequent draws.
+///
+/// @param text The text object.
+/// @param color The color.
+void text_set_color(struct text *text, SDL_Color color);
+
+/// Calculates the size of a string when drawn.
+///
+/// Does not use the cache of text_draw(), so it may be called on another
+/// thread than the one drawing.
+///
+/// @param text The text object.
+/// @param str The string.
+/// @param rect The rectangle whose width and height are set.
+void text_measure(const struct text *text, const char *str, SDL_Rect *rect);
+
+/// Queues a string to be drawn.  Newlines start a new line.
+///
+/// The layout of recently drawn strings is cached, so drawing an unchanged
+/// string does not lay it out again.  The glyphs are drawn when the batch
+/// is flushed.
+///
+/// @param text The text object.
+/// @param batch The batch to add the glyphs to.
+/// @param x The left edge of the string.
+/// @param y The top edge of the string.
+/// @param str The string.
+/// @return 0 on success, -1 on error.
+int text_draw(struct text *text, struct sprite_batch *batch, int x, int y, const char *str);
+
+#endif // SDL_BITS_INCLUDE_TEXT_H
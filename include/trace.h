@@ -0,0 +1,114 @@
+#ifndef SDL_BITS_INCLUDE_TRACE_H
+#define SDL_BITS_INCLUDE_TRACE_H
+
+#include <stdatomic.h>
+
+/// Event types, as named by the Chrome trace event format.
+enum trace_type {
+    TRACE_BEGIN = 'B',
+    TRACE_END = 'E',
+    TRACE_INSTANT = 'i',
+    TRACE_COUNTER = 'C',
+};
+
+/// Whether tracing is running.  Read with trace_is_enabled().
+extern atomic_int trace_enabled;
+
+/// The events recorded by one thread.
+struct trace_buffer;
+
+/// Starts tracing to a Chrome trace event JSON file.
+///
+/// Starts a background thread which periodically drains the per-thread event
+/// buffers into the file.
+///
+/// @param file Path to the output file.
+/// @return 0 on success, -1 on error.
+/// @see trace_stop()
+int trace_start(const char *file);
+
+/// Stops tracing, flushes all buffered events and closes the file.
+///
+/// Every thread which recorded events must have stopped recording before
+/// this is called.  Their buffers are freed, and a thread which records
+/// in a later trace must attach to a new one.
+///
+/// @see trace_start()
+void trace_stop(void);
+
+/// Allocates and registers a buffer for a thread which must not allocate
+/// once it runs, such as the audio callback's.
+///
+/// @param name The name of the thread.  Must outlive the trace, e.g. a string literal.
+/// @return The buffer, or NULL if tracing is not running or on error.
+/// @see trace_thread_attach()
+struct trace_buffer *trace_buffer_create(const char *name);
+
+/// Makes the calling thread record into a buffer and names it in the trace.
+/// Neither allocates nor locks.
+///
+/// @param buffer A buffer from trace_buffer_create() that no other thread records into, or NULL.
+void trace_thread_attach(struct trace_buffer *buffer);
+
+/// Names the calling thread in the trace and allocates its buffer.
+///
+/// A thread records no events until it has called this or
+/// trace_thread_attach().
+///
+/// @param name The name.  Must outlive the trace, e.g. a string literal.
+void trace_thread_name(const char *name);
+
+/// Records an event on the calling thread's buffer.  Use the inline wrappers below.
+///
+/// @param type The event type.
+/// @param name The event name.  Must outlive the trace and need no JSON escaping.
+/// @param value The counter value, ignored by other event types.
+void trace_event(enum trace_type type, const char *name, double value);
+
+/// Returns whether tracing is running.
+static inline int trace_is_enabled(void)
+{
+    return atomic_load_explicit(&trace_enabled, memory_order_relaxed);
+}
+
+/// Marks the start of a slice on the calling thread.
+static inline void trace_begin(const char *name)
+{
+    if (trace_is_enabled()) {
+        trace_event(TRACE_BEGIN, name, 0.0);
+    }
+}
+
+/// Marks the end of the innermost open slice on the calling thread.
+static inline void trace_end(const char *name)
+{
+    if (trace_is_enabled()) {
+        trace_event(TRACE_END, name, 0.0);
+    }
+}
+
+/// Marks a point in time on the calling thread.
+static inline void trace_instant(const char *name)
+{
+    if (trace_is_enabled()) {
+        trace_event(TRACE_INSTANT, name, 0.0);
+    }
+}
+
+/// Records the value of a counter.
+static inline void trace_counter(const char *name, double value)
+{
+    if (trace_is_enabled()) {
+        trace_event(TRACE_COUNTER, name, value);
+    }
+}
+
+/// Traces the statement or block that follows it as a slice.
+///
+/// The block must not be left by return, break or goto.
+#define TRACE_SCOPE(name)                          \
+    for (int trace_once_ = (trace_begin(name), 1); \
+         trace_once_;                              \
+         trace_once_ = (trace_end(name), 0))
+
+#endif // SDL_BITS_INCLUDE_TRACE_H
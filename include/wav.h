@@ -0,0 +1,106 @@
+#ifndef SDL_BITS_INCLUDE_WAV_H
+#define SDL_BITS_INCLUDE_WAV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum wav_format {
+    WAV_U8,  // 8-bit unsigned integer
+    WAV_S16, // 16-bit signed integer
+    WAV_S24, // 24-bit signed integer, packed
+    WAV_S32, // 32-bit signed integer
+    WAV_F32, // 32-bit float
+};
+
+/// A WAV file mapped into memory.
+///
+/// The file is mapped rather than read, so opening even a long track
+/// costs nothing up front, and its pages are read in as they are first
+/// touched or asked for with wav_prefetch().
+struct wav {
+    void *map;                 // Mapping of the whole file
+    size_t map_size;           // Size of the mapping in bytes
+    const unsigned char *data; // First frame
+    size_t frames;             // Number of frames
+    size_t frame_size;         // Size of a frame in bytes
+    int channels;              // Samples per frame
+    int sample_rate;           // Frames per second
+    enum wav_format format;    // Format of a sample
+};
+
+/// Maps a WAV file and parses its header.
+///
+/// @param wav The WAV file.
+/// @param file The name of the file.
+/// @return 0 on success, -1 on error.
+/// @see wav_close()
+int wav_open(struct wav *wav, const char *file);
+
+/// Unmaps the WAV file.
+///
+/// @param wav The WAV file.
+/// @see wav_open()
+void wav_close(struct wav *wav);
+
+/// Asks the kernel to start reading frames in, without waiting for them.
+///
+/// @param wav The WAV file.
+/// @param frame The first frame.
+/// @param frames The number of frames, clamped to the end of the file.
+void wav_prefetch(const struct wav *wav, size_t frame, size_t frames);
+
+/// Tells the kernel that frames are no longer needed, so that their pages
+/// are the first to be reclaimed.
+///
+/// @param wav The WAV file.
+/// @param frame The first frame.
+/// @param frames The number of frames, clamped to the end of the file.
+void wav_release(const struct wav *wav, size_t frame, size_t frames);
+
+/// Converts frames to interleaved float stereo.  Mono is copied to both
+/// channels and channels past the second are dropped.
+///
+/// @param wav The WAV file.
+/// @param frame The first frame.
+/// @param out The frames to write, two samples each.
+/// @param frames The number of frames.
+/// @return The number of frames written, fewer at the end of the file.
+size_t wav_read_stereo(const struct wav *wav, size_t frame, float *out, size_t frames);
+
+/// A WAV file of 32-bit float frames being written.
+///
+/// The sizes in the header are only known once every frame is written,
+/// so they are patched in by wav_writer_close().
+struct wav_writer {
+    FILE *file;    // File being written
+    int channels;  // Samples per frame
+    size_t frames; // Number of frames written
+};
+
+/// Creates a WAV file and writes its header.
+///
+/// @param writer The writer.
+/// @param file The name of the file.
+/// @param sample_rate The frames per second.
+/// @param channels The samples per frame.
+/// @return 0 on success, -1 on error.
+/// @see wav_writer_close()
+int wav_writer_open(struct wav_writer *writer, const char *file, int sample_rate, int channels);
+
+/// Appends interleaved frames.
+///
+/// @param writer The writer.
+/// @param frames The frames, channels samples each.
+/// @param count The number of frames.
+/// @return 0 on success, -1 on error.
+int wav_writer_write(struct wav_writer *writer, const float *frames, size_t count);
+
+/// Patches the sizes into the header and closes the file.
+///
+/// @param writer The writer.
+/// @return 0 on success, -1 on error.
+/// @see wav_writer_open()
+int wav_writer_close(struct wav_writer *writer);
+
+#endif // SDL_BITS_INCLUDE_WAV_H
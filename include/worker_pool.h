@@ -0,0 +1,48 @@
+#ifndef SDL_BITS_INCLUDE_WORKER_POOL_H
+#define SDL_BITS_INCLUDE_WORKER_POOL_H
+
+#include <stddef.h>
+
+/// A fixed set of threads which run the iterations of a parallel loop.
+struct worker_pool;
+
+/// The body of a parallel loop.
+///
+/// @param data The data passed to worker_pool_run().
+/// @param index The iteration.
+typedef void worker_fn(void *data, size_t index);
+
+/// Creates a new pool.
+///
+/// The thread calling worker_pool_run() takes part in the loop, so a pool of
+/// n threads starts n - 1 new ones.
+///
+/// @param threads The number of threads, or 0 for one per CPU.
+/// @return A pointer to a new worker_pool, or NULL on error.
+/// @see worker_pool_destroy()
+struct worker_pool *worker_pool_create(int threads);
+
+/// Stops the threads and frees resources associated with the pool.
+///
+/// @param pool The pool.
+/// @see worker_pool_create()
+void worker_pool_destroy(struct worker_pool *pool);
+
+/// Returns the number of threads in the pool, including the caller.
+///
+/// @param pool The pool.
+/// @return The number of threads.
+int worker_pool_size(const struct worker_pool *pool);
+
+/// Runs fn(data, i) for every i in [0, count), and waits for all of them.
+///
+/// Iterations are handed out one at a time in order, so each should do a
+/// sizeable chunk of work.  Must not be called concurrently on one pool.
+///
+/// @param pool The pool.
+/// @param fn The loop body.
+/// @param data The data passed to fn.
+/// @param count The number of iterations.
+void worker_pool_run(struct worker_pool *pool, worker_fn *fn, void *data, size_t count);
+
+#endif // SDL_BITS_INCLUDE_WORKER_POOL_H
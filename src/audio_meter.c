@@ -0,0 +1,87 @@
+#include "audio_meter.h"
+
+#include <math.h>
+
+static const double LATE = 1.5; // Periods between callbacks beyond which one is late
+
+void audio_meter_init(struct audio_meter *meter, int sample_rate, int buffer_size, uint64_t frequency)
+{
+    meter->period = (double)buffer_size * (double)frequency / (double)sample_rate;
+    meter->frequency = (double)frequency;
+    meter->last_begin = 0;
+    atomic_init(&meter->callbacks, 0);
+    atomic_init(&meter->over, 0);
+    atomic_init(&meter->late, 0);
+    atomic_init(&meter->missed, 0);
+    atomic_init(&meter->busy, 0);
+    atomic_init(&meter->max_busy, 0);
+    for (size_t i = 0; i < AUDIO_METER_BINS; ++i) {
+        atomic_init(&meter->bins[i], 0);
+    }
+}
+
+/// Adds to a counter which only the audio thread writes, so that a plain
+/// load and store do without a locked instruction.
+static void bump(atomic_uint_fast64_t *counter, uint64_t n)
+{
+    const uint64_t value = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_store_explicit(counter, value + n, memory_order_relaxed);
+}
+
+void audio_meter_record(struct audio_meter *meter, uint64_t begin, uint64_t end)
+{
+    const uint64_t busy = end - begin;
+    const double share = (double)busy / meter->period;
+    size_t bin = (size_t)(share * (AUDIO_METER_BINS - 1));
+    if (bin >= AUDIO_METER_BINS - 1) {
+        // Exactly 100% still fits in the buffer
+        bin = (share > 1.0) ? AUDIO_METER_BINS - 1 : AUDIO_METER_BINS - 2;
+    }
+    bump(&meter->bins[bin], 1);
+    bump(&meter->busy, busy);
+    if (share > 1.0) {
+        bump(&meter->over, 1);
+    }
+    if (busy > atomic_load_explicit(&meter->max_busy, memory_order_relaxed)) {
+        atomic_store_explicit(&meter->max_busy, busy, memory_order_relaxed);
+    }
+    if (meter->last_begin != 0) {
+        const double periods = (double)(begin - meter->last_begin) / meter->period;
+        if (periods > LATE) {
+            bump(&meter->late, 1);
+            bump(&meter->missed, (uint64_t)lround(periods) - 1);
+        }
+    }
+    meter->last_begin = begin;
+    // Last, so a reader which sees the callback also sees its bin
+    atomic_store_explicit(&meter->callbacks, atomic_load_explicit(&meter->callbacks, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+void audio_meter_read(struct audio_meter *meter, struct audio_meter_stats *stats)
+{
+    stats->callbacks = atomic_load_explicit(&meter->callbacks, memory_order_acquire);
+    stats->period = 1000.0 * meter->period / meter->frequency;
+    stats->over = atomic_load_explicit(&meter->over, memory_order_relaxed);
+    stats->late = atomic_load_explicit(&meter->late, memory_order_relaxed);
+    stats->missed = atomic_load_explicit(&meter->missed, memory_order_relaxed);
+    const uint64_t busy = atomic_load_explicit(&meter->busy, memory_order_relaxed);
+    const uint64_t max_busy = atomic_load_explicit(&meter->max_busy, memory_order_relaxed);
+    uint64_t total = 0;
+    for (size_t i = 0; i < AUDIO_METER_BINS; ++i) {
+        stats->bins[i] = atomic_load_explicit(&meter->bins[i], memory_order_relaxed);
+        total += stats->bins[i];
+    }
+    stats->mean = (stats->callbacks > 0) ? (double)busy / (meter->period * (double)stats->callbacks) : 0.0;
+    stats->max = (double)max_busy / meter->period;
+    // The upper edge of the bin the 99th percentile falls in
+    stats->p99 = 0.0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < AUDIO_METER_BINS && total > 0; ++i) {
+        seen += stats->bins[i];
+        if ((double)seen >= 0.99 * (double)total) {
+            stats->p99 = (i < AUDIO_METER_BINS - 1) ? (double)(i + 1) / (AUDIO_METER_BINS - 1) : stats->max;
+            break;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#include "audio_queue.h"
+
+/// Rounds frames up to a whole number of granules.
+static size_t round_up(const struct audio_queue *queue, size_t frames)
+{
+    return ((frames + queue->granule - 1) / queue->granule) * queue->granule;
+}
+
+void audio_queue_init(struct audio_queue *queue, size_t granule, size_t target, size_t max_target)
+{
+    queue->granule = (granule > 0) ? granule : 1;
+    queue->min_target = queue->granule;
+    queue->max_target = round_up(queue, (max_target > target) ? max_target : target);
+    queue->target = round_up(queue, (target > queue->granule) ? target : queue->granule);
+    queue->low = SIZE_MAX;
+    queue->top_ups = 0;
+    queue->underruns = 0;
+    queue->started = 0;
+}
+
+size_t audio_queue_top_up(struct audio_queue *queue, size_t queued)
+{
+    if (queue->started && queued == 0) {
+        // The device ran dry, so the caller is slower to come back than the target allows
+        queue->underruns += 1;
+        queue->target += queue->granule;
+        if (queue->target > queue->max_target) {
+            queue->target = queue->max_target;
+        }
+        queue->low = SIZE_MAX;
+        queue->top_ups = 0;
+    } else if (queue->started) {
+        queue->low = (queued < queue->low) ? queued : queue->low;
+        queue->top_ups += 1;
+        if (queue->top_ups == AUDIO_QUEUE_WINDOW) {
+            if (queue->low > queue->granule) {
+                const size_t spare = (((queue->low - queue->granule) / 2) / queue->granule) * queue->granule;
+                queue->target = (queue->target > queue->min_target + spare) ? queue->target - spare : queue->min_target;
+            }
+            queue->low = SIZE_MAX;
+            queue->top_ups = 0;
+        }
+    }
+    queue->started = 1;
+    return (queued < queue->target) ? round_up(queue, queue->target - queued) : 0;
+}
@@ -0,0 +1,93 @@
+#include "damage.h"
+
+#include <assert.h>
+
+static int min(int a, int b) { return (a < b) ? a : b; }
+
+static int max(int a, int b) { return (a > b) ? a : b; }
+
+static int is_empty(const SDL_Rect *r) { return r->w <= 0 || r->h <= 0; }
+
+/// Returns whether two non-empty rectangles overlap or share an edge.
+static int touches(const SDL_Rect *a, const SDL_Rect *b)
+{
+    return a->x <= b->x + b->w && b->x <= a->x + a->w
+        && a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+static SDL_Rect bounding_box(const SDL_Rect *a, const SDL_Rect *b)
+{
+    const int x = min(a->x, b->x);
+    const int y = min(a->y, b->y);
+    return (SDL_Rect){
+        .x = x,
+        .y = y,
+        .w = max(a->x + a->w, b->x + b->w) - x,
+        .h = max(a->y + a->h, b->y + b->h) - y,
+    };
+}
+
+static SDL_Rect clip(const SDL_Rect *r, const SDL_Rect *bounds)
+{
+    const int x = max(r->x, bounds->x);
+    const int y = max(r->y, bounds->y);
+    return (SDL_Rect){
+        .x = x,
+        .y = y,
+        .w = min(r->x + r->w, bounds->x + bounds->w) - x,
+        .h = min(r->y + r->h, bounds->y + bounds->h) - y,
+    };
+}
+
+void damage_init(struct damage *damage, int width, int height)
+{
+    damage->bounds = (SDL_Rect){.x = 0, .y = 0, .w = width, .h = height};
+    damage_add_all(damage);
+}
+
+void damage_add(struct damage *damage, const SDL_Rect *rect)
+{
+    SDL_Rect r = clip(rect, &damage->bounds);
+    if (is_empty(&r)) {
+        return;
+    }
+    // Absorb every rectangle the new one touches.  The union may touch
+    // rectangles the original did not, so rescan after each merge.
+    for (int i = 0; i < damage->count;) {
+        if (touches(&r, &damage->rects[i])) {
+            r = bounding_box(&r, &damage->rects[i]);
+            damage->rects[i] = damage->rects[--damage->count];
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+    if (damage->count == DAMAGE_MAX_RECTS) {
+        for (int i = 0; i < damage->count; ++i) {
+            r = bounding_box(&r, &damage->rects[i]);
+        }
+        damage->count = 0;
+    }
+    damage->rects[damage->count++] = r;
+}
+
+void damage_add_all(struct damage *damage)
+{
+    damage->rects[0] = damage->bounds;
+    damage->count = is_empty(&damage->bounds) ? 0 : 1;
+}
+
+void damage_clear(struct damage *damage)
+{
+    damage->count = 0;
+}
+
+uint64_t damage_area(const struct damage *damage)
+{
+    uint64_t area = 0;
+    for (int i = 0; i < damage->count; ++i) {
+        assert(!is_empty(&damage->rects[i]));
+        area += (uint64_t)damage->rects[i].w * (uint64_t)damage->rects[i].h;
+    }
+    return area;
+}
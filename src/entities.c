@@ -0,0 +1,192 @@
+#include "entities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const unsigned GENERATION_SHIFT = 32U;
+
+static const uint32_t NO_SLOT = UINT32_MAX;
+
+int entities_init(struct entities *es, size_t cap)
+{
+    memset(es, 0, sizeof(*es));
+    if (cap == 0 || cap > ENTITY_MAX) {
+        return -1;
+    }
+    es->x = malloc(cap * sizeof(*es->x));
+    es->y = malloc(cap * sizeof(*es->y));
+    es->vx = malloc(cap * sizeof(*es->vx));
+    es->vy = malloc(cap * sizeof(*es->vy));
+    es->owner = malloc(cap * sizeof(*es->owner));
+    es->slots = malloc(cap * sizeof(*es->slots));
+    if (es->x == NULL || es->y == NULL || es->vx == NULL || es->vy == NULL
+        || es->owner == NULL || es->slots == NULL) {
+        entities_finish(es);
+        return -1;
+    }
+    es->cap = cap;
+    es->free = NO_SLOT;
+    return 0;
+}
+
+void entities_finish(struct entities *es)
+{
+    free(es->x);
+    free(es->y);
+    free(es->vx);
+    free(es->vy);
+    free(es->owner);
+    free(es->slots);
+    memset(es, 0, sizeof(*es));
+}
+
+entity entities_create(struct entities *es, float x, float y, float vx, float vy)
+{
+    if (es->count == es->cap) {
+        return ENTITY_NONE;
+    }
+    uint32_t slot = es->free;
+    if (slot != NO_SLOT) {
+        es->free = es->slots[slot].dense;
+    } else if (es->used == es->cap) {
+        return ENTITY_NONE;
+    } else {
+        slot = es->used++;
+        es->slots[slot].generation = 1;
+    }
+    const size_t i = es->count++;
+    es->x[i] = x;
+    es->y[i] = y;
+    es->vx[i] = vx;
+    es->vy[i] = vy;
+    es->owner[i] = slot;
+    es->slots[slot].dense = (uint32_t)i;
+    return ((entity)es->slots[slot].generation << GENERATION_SHIFT) | slot;
+}
+
+/// Returns the slot of a live entity, or NO_SLOT.
+static uint32_t lookup(const struct entities *es, entity e)
+{
+    const uint32_t slot = (uint32_t)e;
+    const uint32_t generation = (uint32_t)(e >> GENERATION_SHIFT);
+    if (slot >= es->used || generation == 0 || es->slots[slot].generation != generation) {
+        return NO_SLOT;
+    }
+    return slot;
+}
+
+int entities_destroy(struct entities *es, entity e)
+{
+    const uint32_t slot = lookup(es, e);
+    if (slot == NO_SLOT) {
+        return -1;
+    }
+    const size_t i = es->slots[slot].dense;
+    const size_t last = --es->count;
+    if (i != last) {
+        es->x[i] = es->x[last];
+        es->y[i] = es->y[last];
+        es->vx[i] = es->vx[last];
+        es->vy[i] = es->vy[last];
+        es->owner[i] = es->owner[last];
+        es->slots[es->owner[i]].dense = (uint32_t)i;
+    }
+    // A slot is retired rather than let its generation wrap back to one a
+    // stale handle may still hold.  Generation 0 matches no handle.
+    if (es->slots[slot].generation == UINT32_MAX) {
+        es->slots[slot].generation = 0;
+        return 0;
+    }
+    es->slots[slot].generation += 1;
+    es->slots[slot].dense = es->free;
+    es->free = slot;
+    return 0;
+}
+
+int entities_index(const struct entities *es, entity e, size_t *index)
+{
+    const uint32_t slot = lookup(es, e);
+    if (slot == NO_SLOT) {
+        return -1;
+    }
+    *index = es->slots[slot].dense;
+    return 0;
+}
+
+entity entities_handle(const struct entities *es, size_t index)
+{
+    const uint32_t slot = es->owner[index];
+    return ((entity)es->slots[slot].generation << GENERATION_SHIFT) | slot;
+}
+
+static inline float wrap(float p, float size)
+{
+    if (p < 0.0f) {
+        p += size;
+    } else if (p >= size) {
+        p -= size;
+    }
+    return p;
+}
+
+#ifdef __SSE2__
+static inline __m128 wrap4(__m128 p, __m128 size)
+{
+    const __m128 under = _mm_and_ps(_mm_cmplt_ps(p, _mm_setzero_ps()), size);
+    const __m128 over = _mm_and_ps(_mm_cmpge_ps(p, size), size);
+    return _mm_sub_ps(_mm_add_ps(p, under), over);
+}
+#endif
+
+void entities_integrate(struct entities *es, float dt, float width, float height, size_t begin, size_t end)
+{
+    float *restrict x = es->x;
+    float *restrict y = es->y;
+    const float *restrict vx = es->vx;
+    const float *restrict vy = es->vy;
+    size_t i = begin;
+#ifdef __SSE2__
+    const __m128 t = _mm_set1_ps(dt);
+    const __m128 w = _mm_set1_ps(width);
+    const __m128 h = _mm_set1_ps(height);
+    for (; i + 4 <= end; i += 4) {
+        const __m128 px = _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(_mm_loadu_ps(&vx[i]), t));
+        const __m128 py = _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(_mm_loadu_ps(&vy[i]), t));
+        _mm_storeu_ps(&x[i], wrap4(px, w));
+        _mm_storeu_ps(&y[i], wrap4(py, h));
+    }
+#endif
+    for (; i < end; ++i) {
+        x[i] = wrap(x[i] + (vx[i] * dt), width);
+        y[i] = wrap(y[i] + (vy[i] * dt), height);
+    }
+}
+
+struct update {
+    struct entities *es;
+    float dt;
+    float width;
+    float height;
+};
+
+static void update_chunk(void *data, size_t index)
+{
+    struct update *u = data;
+    const size_t begin = index * ENTITY_CHUNK;
+    const size_t end = (begin + ENTITY_CHUNK < u->es->count) ? begin + ENTITY_CHUNK : u->es->count;
+    entities_integrate(u->es, u->dt, u->width, u->height, begin, end);
+}
+
+void entities_update(struct entities *es, float dt, float width, float height, struct worker_pool *pool)
+{
+    if (pool == NULL || es->count <= ENTITY_CHUNK) {
+        entities_integrate(es, dt, width, height, 0, es->count);
+        return;
+    }
+    struct update u = {es, dt, width, height};
+    worker_pool_run(pool, update_chunk, &u, (es->count + ENTITY_CHUNK - 1) / ENTITY_CHUNK);
+}
@@ -1,12 +1,20 @@
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include "bmp.h"
+#include "glyph_index.h"
+#include "glyph_set.h"
+#include "mono_bitmap.h"
+#include "skyline.h"
 
 #define eprintf(...) (void)fprintf(stderr, __VA_ARGS__)
 
@@ -35,33 +43,18 @@ STATIC_ASSERT(CHAR_BIT == 8);
 SELECT_BIT_TESTS
 #undef X
 
-#define GET_BIT(c, pos) (((pos) >= CHAR_BIT) ? 0 : (((c) >> (CHAR_BIT + ~(pos)) & 1)))
-
-#define GET_BIT_TESTS            \
-    X(0b10000000, 0, 0b00000001) \
-    X(0b01000000, 1, 0b00000001) \
-    X(0b00100000, 2, 0b00000001) \
-    X(0b00010000, 3, 0b00000001) \
-    X(0b00001000, 4, 0b00000001) \
-    X(0b00000100, 5, 0b00000001) \
-    X(0b00000010, 6, 0b00000001) \
-    X(0b00000001, 7, 0b00000001) \
-    X(0b11111111, 0, 0b00000001) \
-    X(0b11111111, 7, 0b00000001) \
-    X(0b00000000, 0, 0b00000000) \
-    X(0b00000000, 7, 0b00000000) \
-    X(0b00000000, 8, 0b00000000)
-
-#define X(in, pos, out) STATIC_ASSERT(GET_BIT((in), (pos)) == (out));
-GET_BIT_TESTS
-#undef X
-
 enum {
     WIDTH = 10,
     HEIGHT = 20,
     LOW = '!',
     HIGH = '~',
     CODES_SIZE = (HIGH - LOW) + 1,
+    MAX_RANGES = 32, // Most codepoint ranges given
+    MAX_CODE = 0x10FFFF,
+    MIN_PAGE = 16,   // Width and height of the smallest page
+    MAX_PAGE = 1024, // Default largest width and height of a page
+    PADDING = 1,     // Empty columns and rows right of and below each glyph
+    MAX_THREADS = 64,
 };
 
 static const char *const FONT_FILE = "./assets/ucs-fonts/10x20.bdf";
@@ -71,30 +64,20 @@ static const bmp_pixel32 WHITE = {0xFF, 0xFF, 0xFF, 0x00};
 static const bmp_pixel32 BLACK = {0x00, 0x00, 0x00, 0xFF};
 
 // https://freetype.org/freetype2/docs/reference/ft2-basic_types.html#ft_bitmap
-static void render_bitmap_char(FT_GlyphSlot slot, char *target, const size_t code_size, const size_t offset)
+static void render_bitmap_char(const struct mono_bitmap_lut *lut, FT_GlyphSlot slot, bmp_pixel32 *target, const size_t code_size, const size_t offset)
 {
     const unsigned char *buffer = slot->bitmap.buffer;
     const size_t rows = (size_t)slot->bitmap.rows;
     const size_t width = (size_t)slot->bitmap.width;
     const size_t pitch = (size_t)abs(slot->bitmap.pitch);
-    const size_t stride = width * code_size;
 
     assert(width == WIDTH);
+    assert(rows <= HEIGHT);
 
-    for (size_t y = 0, p = 0; y < rows; ++y, p += pitch) {
-        for (size_t i = 0; i < pitch; ++i) {
-            for (size_t j = 0, x; j < CHAR_BIT; ++j) {
-                x = j + (i * CHAR_BIT);
-                if (x >= width) {
-                    continue;
-                }
-                target[(y * stride) + (x + (offset * width))] = GET_BIT(buffer[p + i], j);
-            }
-        }
-    }
+    mono_bitmap_expand(lut, buffer, pitch, width, rows, target, width * code_size, HEIGHT, offset * width, 0);
 }
 
-static int render_bitmap_chars(FT_Face face, const char codes[CODES_SIZE], char *image)
+static int render_bitmap_chars(FT_Face face, const struct mono_bitmap_lut *lut, const char codes[CODES_SIZE], bmp_pixel32 *image)
 {
     int rc = FT_Set_Pixel_Sizes(face, WIDTH, HEIGHT);
     if (rc != 0) {
@@ -117,13 +100,13 @@ static int render_bitmap_chars(FT_Face face, const char codes[CODES_SIZE], char
         }
         assert(slot->format == FT_GLYPH_FORMAT_BITMAP);
         assert(slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO);
-        render_bitmap_char(slot, image, CODES_SIZE, i);
+        render_bitmap_char(lut, slot, image, CODES_SIZE, i);
     }
 
     return 0;
 }
 
-static int render_chars(const char codes[CODES_SIZE], char *image)
+static int render_chars(const char *font_file, const struct mono_bitmap_lut *lut, const char codes[CODES_SIZE], bmp_pixel32 *image, int *ascent)
 {
     int ret = -1;
 
@@ -135,16 +118,17 @@ static int render_chars(const char codes[CODES_SIZE], char *image)
     }
 
     FT_Face face = NULL;
-    rc = FT_New_Face(lib, FONT_FILE, 0, &face);
+    rc = FT_New_Face(lib, font_file, 0, &face);
     if (rc != 0) {
         eprintf("FT_New_Face failed.  Error code: %d", rc);
         goto out_done_lib;
     }
 
-    rc = render_bitmap_chars(face, codes, image);
+    rc = render_bitmap_chars(face, lut, codes, image);
     if (rc != 0) {
         goto out_done_face;
     }
+    *ascent = (int)(face->size->metrics.ascender >> 6);
 
     ret = 0;
 out_done_face:
@@ -155,32 +139,171 @@ out_done_lib:
 }
 
 #ifdef DRAW_IMAGE
-static void draw_image(const char *image, const size_t width, const size_t height)
+static void draw_image(const bmp_pixel32 *image, const size_t width, const size_t height)
 {
+    extern const bmp_pixel32 BLACK;
+
     for (size_t y = 0; y < height; ++y) {
         printf("%2zd|", y);
         for (size_t x = 0; x < width; ++x) {
-            putchar(image[(y * width) + x] ? '*' : ' ');
+            putchar((image[((height - 1 - y) * width) + x].a == BLACK.a) ? '*' : ' ');
         }
         printf("|\n");
     }
 }
 #else
-static inline void draw_image(__attribute__((unused)) const char *image,
+static inline void draw_image(__attribute__((unused)) const bmp_pixel32 *image,
                               __attribute__((unused)) const size_t width,
                               __attribute__((unused)) const size_t height)
 {
 }
 #endif
 
-int main(void)
+struct args {
+    const char *font_file;
+    const char *bmp_file;
+    struct glyph_range ranges[MAX_RANGES];
+    size_t range_count;
+    int pack;
+    int max_page;
+    int threads;
+};
+
+struct page {
+    int width;
+    int height;
+    long area; // Area of the glyphs packed, without padding
+};
+
+static int parse_range(const char *arg, struct glyph_range *range)
+{
+    char *end = NULL;
+    range->low = strtoul(arg, &end, 0);
+    range->high = range->low;
+    if (*end == '-') {
+        range->high = strtoul(end + 1, &end, 0);
+    }
+    if (end == arg || *end != '\0' || range->low > range->high || range->high > MAX_CODE) {
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_args(int argc, char *argv[], struct args *as)
+{
+    char *arg = NULL;
+    int paging = 0; // Whether an option only packed pages use was given
+    for (int i = 1; i < argc;) {
+        arg = argv[i++];
+        if (strcmp(arg, "-f") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            as->font_file = argv[i++];
+        } else if (strcmp(arg, "-r") == 0) {
+            if (i >= argc || as->range_count == MAX_RANGES) {
+                return -1;
+            }
+            if (parse_range(argv[i++], &as->ranges[as->range_count]) != 0) {
+                return -1;
+            }
+            as->range_count += 1;
+            paging = 1;
+        } else if (strcmp(arg, "-p") == 0) {
+            as->pack = 1;
+        } else if (strcmp(arg, "-m") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            char *end = NULL;
+            const long max_page = strtol(argv[i++], &end, 10);
+            if (*end != '\0' || max_page < MIN_PAGE || max_page > UINT16_MAX) {
+                return -1;
+            }
+            as->max_page = (int)max_page;
+            paging = 1;
+        } else if (strcmp(arg, "-j") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            char *end = NULL;
+            const long threads = strtol(argv[i++], &end, 10);
+            if (*end != '\0' || threads < 1 || threads > MAX_THREADS) {
+                return -1;
+            }
+            as->threads = (int)threads;
+            paging = 1;
+        } else if (arg[0] != '-') {
+            as->bmp_file = arg;
+        } else {
+            return -1;
+        }
+    }
+    // The strip always holds LOW to HIGH, so a range given without -p
+    // would be ignored
+    if (paging && !as->pack) {
+        eprintf("-r, -m and -j need -p\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int write_bitmap(const bmp_pixel32 *image, const size_t width, const size_t height, const char *file)
+{
+    draw_image(image, width, height);
+
+    const int rc = bmp_v4_write(image, width, height, file);
+    if (rc != 0) {
+        eprintf("bmp_v4_write failed.  Error code: %d", rc);
+        return -1;
+    }
+    return 0;
+}
+
+static int write_index(const char *bmp_file, const struct glyph_index_page *pages, size_t page_count,
+                       const uint32_t *codes, const struct glyph_metrics *glyphs, size_t count, int ascent, int line_height)
+{
+    char *file = glyph_index_file_name(bmp_file);
+    if (file == NULL) {
+        return -1;
+    }
+    const int rc = glyph_index_write(file, pages, page_count, codes, glyphs, count, ascent, line_height);
+    if (rc != 0) {
+        eprintf("glyph_index_write failed for %s\n", file);
+    }
+    free(file);
+    return rc;
+}
+
+/// Indexes the strip: a blank space, then every cell from LOW, each with
+/// its top edge at the top of the line.
+static int write_strip_index(const char *bmp_file, int ascent)
+{
+    uint32_t codes[CODES_SIZE + 1];
+    struct glyph_metrics glyphs[CODES_SIZE + 1];
+    codes[0] = ' ';
+    glyphs[0] = (struct glyph_metrics){.advance = WIDTH};
+    for (int i = 0; i < CODES_SIZE; ++i) {
+        codes[i + 1] = (uint32_t)(LOW + i);
+        glyphs[i + 1] = (struct glyph_metrics){
+            .x = (uint16_t)(i * WIDTH),
+            .width = WIDTH,
+            .height = HEIGHT,
+            .top = (int16_t)ascent,
+            .advance = WIDTH,
+        };
+    }
+    const struct glyph_index_page page = {.width = WIDTH * CODES_SIZE, .height = HEIGHT};
+    return write_index(bmp_file, &page, 1, codes, glyphs, CODES_SIZE + 1, ascent, HEIGHT);
+}
+
+/// Renders the printable ASCII characters of a 10x20 font side by side.
+static int write_strip(const struct args *as)
 {
-    extern const char *const FONT_FILE;
-    extern const char *const BMP_FILE;
     extern const bmp_pixel32 WHITE;
     extern const bmp_pixel32 BLACK;
 
-    int ret = EXIT_FAILURE;
+    int ret = -1;
 
     char codes[CODES_SIZE] = {0};
     for (int i = 0; i < CODES_SIZE; ++i) {
@@ -189,40 +312,337 @@ int main(void)
 
     const size_t width = (size_t)WIDTH * CODES_SIZE;
     const size_t height = HEIGHT;
-    char *image = calloc(width * height, sizeof(*image));
+    bmp_pixel32 *image = malloc(width * height * sizeof(*image));
     if (image == NULL) {
         eprintf("alloc_image failed.");
-        return EXIT_FAILURE;
+        return -1;
     }
+    mono_bitmap_fill(image, width * height, WHITE);
 
-    int rc = render_chars(codes, image);
+    struct mono_bitmap_lut lut;
+    mono_bitmap_lut_init(&lut, BLACK, WHITE);
+    int ascent = 0;
+    int rc = render_chars(as->font_file, &lut, codes, image, &ascent);
     if (rc != 0) {
         goto out_free_image;
     }
 
-    draw_image(image, width, height);
+    rc = write_bitmap(image, width, height, as->bmp_file);
+    if (rc != 0) {
+        goto out_free_image;
+    }
 
-    bmp_pixel32 *buffer = calloc(width * height, sizeof(*buffer));
-    if (buffer == NULL) {
+    rc = write_strip_index(as->bmp_file, ascent);
+    if (rc != 0) {
         goto out_free_image;
     }
 
-    for (size_t y = height, i = 0; y-- > 0;) {
-        for (size_t x = 0; x < width; ++x, ++i) {
-            buffer[i] = image[(y * width) + x] ? BLACK : WHITE;
+    ret = 0;
+out_free_image:
+    free(image);
+    return ret;
+}
+
+static int compare_code(const void *a, const void *b)
+{
+    const struct glyph *ga = a;
+    const struct glyph *gb = b;
+    return (ga->code > gb->code) - (ga->code < gb->code);
+}
+
+static int compare_size(const void *a, const void *b)
+{
+    const struct glyph *ga = a;
+    const struct glyph *gb = b;
+    if (ga->rows != gb->rows) {
+        return gb->rows - ga->rows;
+    }
+    if (ga->width != gb->width) {
+        return gb->width - ga->width;
+    }
+    return compare_code(a, b);
+}
+
+/// Packs the glyphs not yet on a page into a page of the given size,
+/// tallest first.
+///
+/// @return The number of glyphs packed, or -1 on error.
+static long fill_page(struct glyph *glyphs, size_t count, int page, int width, int height)
+{
+    struct skyline sky;
+    if (skyline_init(&sky, width, height) != 0) {
+        return -1;
+    }
+    long packed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        struct glyph *g = &glyphs[i];
+        if (g->page >= 0) {
+            continue;
+        }
+        // Blank glyphs take no room
+        if (g->width == 0 || g->rows == 0) {
+            g->page = page;
+            g->x = 0;
+            g->y = 0;
+            packed += 1;
+            continue;
+        }
+        if (skyline_insert(&sky, g->width + PADDING, g->rows + PADDING, &g->x, &g->y) == 0) {
+            g->page = page;
+            packed += 1;
         }
     }
+    skyline_finish(&sky);
+    return packed;
+}
 
-    rc = bmp_v4_write(buffer, width, height, BMP_FILE);
-    if (rc != 0) {
-        eprintf("bmp_v4_write failed.  Error code: %d", rc);
-        goto out_free_buffer;
+static void unfill_page(struct glyph *glyphs, size_t count, int page)
+{
+    for (size_t i = 0; i < count; ++i) {
+        glyphs[i].page = (glyphs[i].page == page) ? -1 : glyphs[i].page;
     }
+}
 
-    ret = EXIT_SUCCESS;
-out_free_buffer:
-    free(buffer);
-out_free_image:
+/// Packs the glyphs into as few pages as it can.  Each page is the
+/// smallest power-of-two size that holds all the glyphs left, or if none
+/// does, the largest size filled as far as it goes.
+static int pack_glyphs(struct glyph *glyphs, size_t count, int max_page, struct page **pages_out, size_t *page_count_out)
+{
+    struct page *pages = NULL;
+    size_t page_count = 0;
+    size_t left = count;
+    while (left > 0) {
+        struct page *grown = realloc(pages, (page_count + 1) * sizeof(*pages));
+        if (grown == NULL) {
+            free(pages);
+            return -1;
+        }
+        pages = grown;
+        const int page = (int)page_count;
+        int width = MIN_PAGE;
+        int height = MIN_PAGE;
+        long packed = 0;
+        for (;;) {
+            packed = fill_page(glyphs, count, page, width, height);
+            if (packed < 0) {
+                free(pages);
+                return -1;
+            }
+            if ((size_t)packed == left || (width >= max_page && height >= max_page)) {
+                break;
+            }
+            unfill_page(glyphs, count, page);
+            // Wider first, so that pages are never taller than they are wide
+            if (width == height && width < max_page) {
+                width = (width * 2 > max_page) ? max_page : width * 2;
+            } else {
+                height = (height * 2 > max_page) ? max_page : height * 2;
+            }
+        }
+        if (packed == 0) {
+            free(pages);
+            return -1;
+        }
+        pages[page_count++] = (struct page){.width = width, .height = height};
+        left -= (size_t)packed;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pages[glyphs[i].page].area += (long)glyphs[i].width * glyphs[i].rows;
+    }
+    *pages_out = pages;
+    *page_count_out = page_count;
+    return 0;
+}
+
+/// Names page 0 after the output file, and page n after it with .n
+/// before the extension.
+static char *page_file_name(const char *bmp_file, size_t page)
+{
+    const size_t length = strlen(bmp_file);
+    char *name = malloc(length + 32);
+    if (name == NULL) {
+        return NULL;
+    }
+    if (page == 0) {
+        memcpy(name, bmp_file, length + 1);
+        return name;
+    }
+    const char *dot = strrchr(bmp_file, '.');
+    const char *slash = strrchr(bmp_file, '/');
+    const size_t stem = (dot != NULL && (slash == NULL || dot > slash)) ? (size_t)(dot - bmp_file) : length;
+    (void)snprintf(name, length + 32, "%.*s.%zu%s", (int)stem, bmp_file, page, &bmp_file[stem]);
+    return name;
+}
+
+static int write_page(const struct mono_bitmap_lut *lut, const struct glyph *glyphs, size_t count,
+                      const struct page *page, int index, const char *file)
+{
+    extern const bmp_pixel32 WHITE;
+
+    const size_t width = (size_t)page->width;
+    const size_t height = (size_t)page->height;
+    bmp_pixel32 *image = malloc(width * height * sizeof(*image));
+    if (image == NULL) {
+        eprintf("alloc_image failed.\n");
+        return -1;
+    }
+    mono_bitmap_fill(image, width * height, WHITE);
+    for (size_t i = 0; i < count; ++i) {
+        const struct glyph *g = &glyphs[i];
+        if (g->page != index || g->bits == NULL) {
+            continue;
+        }
+        mono_bitmap_expand(lut, g->bits, g->pitch, (size_t)g->width, (size_t)g->rows, image, width, height,
+                           (size_t)g->x, (size_t)g->y);
+    }
+    const int rc = write_bitmap(image, width, height, file);
     free(image);
+    return rc;
+}
+
+/// Indexes the packed glyphs, putting them back in order of codepoint.
+static int write_pages_index(const char *bmp_file, struct glyph *glyphs, size_t count, const struct page *pages,
+                             size_t page_count, int ascent, int line_height)
+{
+    int ret = -1;
+    qsort(glyphs, count, sizeof(*glyphs), compare_code);
+    struct glyph_index_page *sizes = calloc(page_count + 1, sizeof(*sizes));
+    uint32_t *codes = calloc(count + 1, sizeof(*codes));
+    struct glyph_metrics *metrics = calloc(count + 1, sizeof(*metrics));
+    if (sizes == NULL || codes == NULL || metrics == NULL) {
+        goto out_free;
+    }
+    for (size_t p = 0; p < page_count; ++p) {
+        sizes[p] = (struct glyph_index_page){.width = (uint16_t)pages[p].width, .height = (uint16_t)pages[p].height};
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const struct glyph *g = &glyphs[i];
+        codes[i] = (uint32_t)g->code;
+        metrics[i] = (struct glyph_metrics){
+            .page = (uint16_t)g->page,
+            .x = (uint16_t)g->x,
+            .y = (uint16_t)g->y,
+            .width = (uint16_t)g->width,
+            .height = (uint16_t)g->rows,
+            .left = (int16_t)g->left,
+            .top = (int16_t)g->top,
+            .advance = (int16_t)g->advance,
+        };
+    }
+    ret = write_index(bmp_file, sizes, page_count, codes, metrics, count, ascent, line_height);
+out_free:
+    free(metrics);
+    free(codes);
+    free(sizes);
     return ret;
 }
+
+static double elapsed_ms(const struct timespec *begin, const struct timespec *end)
+{
+    return ((double)(end->tv_sec - begin->tv_sec) * 1e3) + ((double)(end->tv_nsec - begin->tv_nsec) / 1e6);
+}
+
+/// Packs the glyphs of the ranges into pages and writes each page.
+static int write_pages(const struct args *as)
+{
+    extern const bmp_pixel32 WHITE;
+    extern const bmp_pixel32 BLACK;
+
+    int ret = -1;
+
+    struct timespec begin;
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    struct glyph_set set;
+    int rc = glyph_set_load(&set, as->font_file, as->ranges, as->range_count, as->threads);
+    if (rc != 0) {
+        eprintf("glyph_set_load failed.\n");
+        return -1;
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Rendered %zu glyphs on %d threads in %.2f ms\n", set.count, as->threads, elapsed_ms(&begin, &end));
+
+    struct glyph *glyphs = set.glyphs;
+    const size_t count = set.count;
+    struct page *pages = NULL;
+    size_t page_count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (glyphs[i].width + PADDING > as->max_page || glyphs[i].rows + PADDING > as->max_page) {
+            eprintf("U+%04lX is %dx%d, too big for a %dx%d page\n", glyphs[i].code,
+                    glyphs[i].width, glyphs[i].rows, as->max_page, as->max_page);
+            goto out_free_glyphs;
+        }
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    qsort(glyphs, count, sizeof(*glyphs), compare_size);
+    rc = pack_glyphs(glyphs, count, as->max_page, &pages, &page_count);
+    if (rc != 0) {
+        eprintf("pack_glyphs failed.\n");
+        goto out_free_glyphs;
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Packed %zu glyphs into %zu pages in %.2f ms\n", count, page_count, elapsed_ms(&begin, &end));
+    struct mono_bitmap_lut lut;
+    mono_bitmap_lut_init(&lut, BLACK, WHITE);
+    long area = 0;
+    long page_area = 0;
+    for (size_t p = 0; p < page_count; ++p) {
+        char *file = page_file_name(as->bmp_file, p);
+        if (file == NULL) {
+            goto out_free_pages;
+        }
+        rc = write_page(&lut, glyphs, count, &pages[p], (int)p, file);
+        const long size = (long)pages[p].width * pages[p].height;
+        printf("  %s: %dx%d, %.1f%% occupied\n", file, pages[p].width, pages[p].height,
+               (100.0 * (double)pages[p].area) / (double)size);
+        free(file);
+        if (rc != 0) {
+            goto out_free_pages;
+        }
+        area += pages[p].area;
+        page_area += size;
+    }
+    if (page_area > 0) {
+        printf("Occupancy: %.1f%%\n", (100.0 * (double)area) / (double)page_area);
+    }
+
+    rc = write_pages_index(as->bmp_file, glyphs, count, pages, page_count, set.ascent, set.line_height);
+    if (rc != 0) {
+        goto out_free_pages;
+    }
+
+    ret = 0;
+out_free_pages:
+    free(pages);
+out_free_glyphs:
+    glyph_set_finish(&set);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    extern const char *const FONT_FILE;
+    extern const char *const BMP_FILE;
+
+    struct args as = {
+        .font_file = FONT_FILE,
+        .bmp_file = BMP_FILE,
+        .max_page = MAX_PAGE,
+    };
+    if (parse_args(argc, argv, &as) != 0) {
+        eprintf("Usage: %s [-f FONT] [-p] [-r LOW-HIGH]... [-m MAX_PAGE] [-j THREADS] [OUT]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (as.range_count == 0) {
+        as.ranges[as.range_count++] = (struct glyph_range){.low = LOW, .high = HIGH};
+    }
+    if (as.threads == 0) {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        as.threads = (online < 1) ? 1 : (online > MAX_THREADS) ? MAX_THREADS : (int)online;
+    }
+
+    const int rc = as.pack ? write_pages(&as) : write_strip(&as);
+    return (rc == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
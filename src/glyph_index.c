@@ -0,0 +1,227 @@
+#include "glyph_index.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Finds the longest run of codepoints that has a glyph for at least
+/// every other codepoint, keeping the run from i to j as short as that
+/// allows for each j.
+static void find_dense(const uint32_t *codes, size_t count, size_t *first, size_t *last)
+{
+    *first = 0;
+    *last = 0;
+    size_t best = 0;
+    for (size_t i = 0, j = 0; j < count; ++j) {
+        while ((uint64_t)(codes[j] - codes[i]) + 1 > 2 * (uint64_t)(j - i + 1)) {
+            i += 1;
+        }
+        if (j - i + 1 > best) {
+            best = j - i + 1;
+            *first = i;
+            *last = j;
+        }
+    }
+}
+
+int glyph_index_write(const char *file, const struct glyph_index_page *pages, size_t page_count, const uint32_t *codes,
+                      const struct glyph_metrics *glyphs, size_t count, int ascent, int line_height)
+{
+    if (page_count > UINT16_MAX || count >= GLYPH_INDEX_NONE) {
+        return -1;
+    }
+    size_t first = 0;
+    size_t last = 0;
+    find_dense(codes, count, &first, &last);
+    const uint32_t dense_low = (count > 0) ? codes[first] : 0;
+    const size_t dense_count = (count > 0) ? (size_t)(codes[last] - dense_low) + 1 : 0;
+    const size_t sparse_count = (count > 0) ? count - (last - first + 1) : 0;
+
+    struct glyph_index_header header = {
+        .magic = GLYPH_INDEX_MAGIC,
+        .version = GLYPH_INDEX_VERSION,
+        .page_count = (uint16_t)page_count,
+        .ascent = (int16_t)ascent,
+        .line_height = (int16_t)line_height,
+        .glyph_count = (uint32_t)count,
+        .dense_low = dense_low,
+        .dense_count = (uint32_t)dense_count,
+        .sparse_count = (uint32_t)sparse_count,
+    };
+    size_t offset = sizeof(header);
+    header.pages_offset = (uint32_t)offset;
+    offset += page_count * sizeof(*pages);
+    header.glyphs_offset = (uint32_t)offset;
+    offset += count * sizeof(*glyphs);
+    header.dense_offset = (uint32_t)offset;
+    offset += dense_count * sizeof(uint32_t);
+    header.sparse_offset = (uint32_t)offset;
+    offset += sparse_count * sizeof(struct glyph_index_entry);
+    if (offset > UINT32_MAX) {
+        return -1;
+    }
+    header.file_size = (uint32_t)offset;
+
+    int ret = -1;
+    uint32_t *dense = malloc((dense_count + 1) * sizeof(*dense));
+    struct glyph_index_entry *sparse = malloc((sparse_count + 1) * sizeof(*sparse));
+    if (dense == NULL || sparse == NULL) {
+        goto out_free;
+    }
+    for (size_t i = 0; i < dense_count; ++i) {
+        dense[i] = GLYPH_INDEX_NONE;
+    }
+    for (size_t i = 0, s = 0; i < count; ++i) {
+        if (i >= first && i <= last) {
+            dense[codes[i] - dense_low] = (uint32_t)i;
+        } else {
+            sparse[s++] = (struct glyph_index_entry){.code = codes[i], .glyph = (uint32_t)i};
+        }
+    }
+
+    FILE *out = fopen(file, "wb");
+    if (out == NULL) {
+        goto out_free;
+    }
+    if (fwrite(&header, sizeof(header), 1, out) == 1
+        && fwrite(pages, sizeof(*pages), page_count, out) == page_count
+        && fwrite(glyphs, sizeof(*glyphs), count, out) == count
+        && fwrite(dense, sizeof(*dense), dense_count, out) == dense_count
+        && fwrite(sparse, sizeof(*sparse), sparse_count, out) == sparse_count) {
+        ret = 0;
+    }
+    if (fclose(out) != 0) {
+        ret = -1;
+    }
+out_free:
+    free(sparse);
+    free(dense);
+    return ret;
+}
+
+char *glyph_index_file_name(const char *atlas_file)
+{
+    static const char extension[] = ".glyphs";
+    const size_t length = strlen(atlas_file);
+    const char *dot = strrchr(atlas_file, '.');
+    const char *slash = strrchr(atlas_file, '/');
+    const size_t stem = (dot != NULL && (slash == NULL || dot > slash)) ? (size_t)(dot - atlas_file) : length;
+    char *name = malloc(stem + sizeof(extension));
+    if (name == NULL) {
+        return NULL;
+    }
+    memcpy(name, atlas_file, stem);
+    memcpy(&name[stem], extension, sizeof(extension));
+    return name;
+}
+
+/// Checks that an array lies within the file and is aligned for its type.
+static int check_array(const struct glyph_index_header *header, uint32_t offset, uint32_t count, size_t size)
+{
+    return (offset % 4 == 0 && offset >= sizeof(*header) && (uint64_t)offset + ((uint64_t)count * size) <= header->file_size) ? 0 : -1;
+}
+
+static int parse(struct glyph_index *index)
+{
+    const struct glyph_index_header *header = index->map;
+    if (index->map_size < sizeof(*header) || header->magic != GLYPH_INDEX_MAGIC || header->version != GLYPH_INDEX_VERSION
+        || header->file_size != index->map_size) {
+        return -1;
+    }
+    if (check_array(header, header->pages_offset, header->page_count, sizeof(struct glyph_index_page)) != 0
+        || check_array(header, header->glyphs_offset, header->glyph_count, sizeof(struct glyph_metrics)) != 0
+        || check_array(header, header->dense_offset, header->dense_count, sizeof(uint32_t)) != 0
+        || check_array(header, header->sparse_offset, header->sparse_count, sizeof(struct glyph_index_entry)) != 0) {
+        return -1;
+    }
+    const unsigned char *base = index->map;
+    index->header = header;
+    index->pages = (const struct glyph_index_page *)(base + header->pages_offset);
+    index->glyphs = (const struct glyph_metrics *)(base + header->glyphs_offset);
+    index->dense = (const uint32_t *)(base + header->dense_offset);
+    index->sparse = (const struct glyph_index_entry *)(base + header->sparse_offset);
+
+    // Checked once here, so that lookups need not
+    for (uint32_t i = 0; i < header->dense_count; ++i) {
+        if (index->dense[i] != GLYPH_INDEX_NONE && index->dense[i] >= header->glyph_count) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->sparse_count; ++i) {
+        if (index->sparse[i].glyph >= header->glyph_count || (i > 0 && index->sparse[i].code <= index->sparse[i - 1].code)) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->glyph_count; ++i) {
+        if (index->glyphs[i].page >= header->page_count && index->glyphs[i].width > 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int glyph_index_open(struct glyph_index *index, const char *file)
+{
+    memset(index, 0, sizeof(*index));
+    const int fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        goto out_close_fd;
+    }
+    index->map_size = (size_t)st.st_size;
+    index->map = mmap(NULL, index->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (index->map == MAP_FAILED) {
+        index->map = NULL;
+        goto out_close_fd;
+    }
+    if (parse(index) != 0) {
+        glyph_index_close(index);
+        goto out_close_fd;
+    }
+    ret = 0;
+out_close_fd:
+    // The mapping keeps the file open
+    (void)close(fd);
+    return ret;
+}
+
+void glyph_index_close(struct glyph_index *index)
+{
+    if (index->map != NULL) {
+        (void)munmap(index->map, index->map_size);
+    }
+    memset(index, 0, sizeof(*index));
+}
+
+const struct glyph_metrics *glyph_index_find(const struct glyph_index *index, uint32_t code)
+{
+    const struct glyph_index_header *header = index->header;
+    // Codepoints below the table wrap around to past its end
+    const uint32_t offset = code - header->dense_low;
+    if (offset < header->dense_count) {
+        const uint32_t glyph = index->dense[offset];
+        return (glyph == GLYPH_INDEX_NONE) ? NULL : &index->glyphs[glyph];
+    }
+    size_t low = 0;
+    size_t high = header->sparse_count;
+    while (low < high) {
+        const size_t mid = low + ((high - low) / 2);
+        if (index->sparse[mid].code < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < header->sparse_count && index->sparse[low].code == code) {
+        return &index->glyphs[index->sparse[low].glyph];
+    }
+    return NULL;
+}
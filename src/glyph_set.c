@@ -0,0 +1,207 @@
+#include "glyph_set.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+/// Codepoints handed out to the workers, a chunk at a time.
+struct queue {
+    atomic_size_t next; // First glyph of the next chunk
+    atomic_int failed;  // Set when a worker fails, to stop the others
+};
+
+struct worker {
+    pthread_t thread;
+    const char *font_file;
+    struct glyph *glyphs;
+    size_t count;
+    struct queue *queue;
+};
+
+static int open_face(const char *font_file, FT_Library *lib, FT_Face *face)
+{
+    if (FT_Init_FreeType(lib) != 0) {
+        return -1;
+    }
+    if (FT_New_Face(*lib, font_file, 0, face) != 0) {
+        goto out_done_lib;
+    }
+    // A BDF font has just the one size it was drawn at
+    const int rc = ((*face)->num_fixed_sizes > 0) ? FT_Select_Size(*face, 0) : FT_Set_Pixel_Sizes(*face, 0, GLYPH_SET_PIXELS);
+    if (rc != 0) {
+        goto out_done_face;
+    }
+    return 0;
+out_done_face:
+    FT_Done_Face(*face);
+out_done_lib:
+    FT_Done_FreeType(*lib);
+    return -1;
+}
+
+static int in_ranges(unsigned long code, const struct glyph_range *ranges, size_t range_count)
+{
+    for (size_t r = 0; r < range_count; ++r) {
+        if (code >= ranges[r].low && code <= ranges[r].high) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// Lists the codepoints the font has in the ranges, from its character
+/// map rather than by probing every codepoint of the ranges.
+static int list_codes(FT_Face face, const struct glyph_range *ranges, size_t range_count, struct glyph_set *set)
+{
+    size_t capacity = 0;
+    FT_UInt index = 0;
+    for (FT_ULong code = FT_Get_First_Char(face, &index); index != 0; code = FT_Get_Next_Char(face, code, &index)) {
+        if (!in_ranges((unsigned long)code, ranges, range_count)) {
+            continue;
+        }
+        if (set->count == capacity) {
+            capacity = (capacity == 0) ? 256 : capacity * 2;
+            struct glyph *grown = realloc(set->glyphs, capacity * sizeof(*grown));
+            if (grown == NULL) {
+                return -1;
+            }
+            set->glyphs = grown;
+        }
+        set->glyphs[set->count++] = (struct glyph){.code = (unsigned long)code, .page = -1};
+    }
+    return 0;
+}
+
+static int load_glyph(FT_Face face, struct glyph *glyph)
+{
+    if (FT_Load_Char(face, (FT_ULong)glyph->code, FT_LOAD_RENDER | FT_LOAD_TARGET_MONO) != 0) {
+        return -1;
+    }
+    const FT_GlyphSlot slot = face->glyph;
+    const size_t pitch = (size_t)abs(slot->bitmap.pitch);
+    const size_t rows = (size_t)slot->bitmap.rows;
+    if (slot->bitmap.pixel_mode != FT_PIXEL_MODE_MONO && rows > 0) {
+        return -1;
+    }
+    glyph->width = (int)slot->bitmap.width;
+    glyph->rows = (int)rows;
+    glyph->left = slot->bitmap_left;
+    glyph->top = slot->bitmap_top;
+    glyph->advance = (int)(slot->advance.x >> 6);
+    glyph->pitch = pitch;
+    if (rows == 0 || pitch == 0) {
+        return 0;
+    }
+    glyph->bits = malloc(rows * pitch);
+    if (glyph->bits == NULL) {
+        return -1;
+    }
+    // A negative pitch means the buffer holds the rows bottom first
+    for (size_t y = 0; y < rows; ++y) {
+        const size_t from = (slot->bitmap.pitch < 0) ? rows - 1 - y : y;
+        memcpy(&glyph->bits[y * pitch], &slot->bitmap.buffer[from * pitch], pitch);
+    }
+    return 0;
+}
+
+/// Renders chunks of glyphs until none are left.  Each chunk is only
+/// ever taken by one worker, so the glyphs need no locking.
+static void *render_chunks(void *data)
+{
+    struct worker *worker = data;
+    struct queue *queue = worker->queue;
+
+    FT_Library lib = NULL;
+    FT_Face face = NULL;
+    if (open_face(worker->font_file, &lib, &face) != 0) {
+        atomic_store(&queue->failed, 1);
+        return NULL;
+    }
+    while (atomic_load_explicit(&queue->failed, memory_order_relaxed) == 0) {
+        const size_t begin = atomic_fetch_add_explicit(&queue->next, GLYPH_SET_CHUNK, memory_order_relaxed);
+        if (begin >= worker->count) {
+            break;
+        }
+        const size_t end = (worker->count - begin < GLYPH_SET_CHUNK) ? worker->count : begin + GLYPH_SET_CHUNK;
+        for (size_t i = begin; i < end; ++i) {
+            if (load_glyph(face, &worker->glyphs[i]) != 0) {
+                atomic_store(&queue->failed, 1);
+                break;
+            }
+        }
+    }
+    FT_Done_Face(face);
+    FT_Done_FreeType(lib);
+    return NULL;
+}
+
+int glyph_set_load(struct glyph_set *set, const char *font_file, const struct glyph_range *ranges, size_t range_count, int threads)
+{
+    memset(set, 0, sizeof(*set));
+    if (threads < 1) {
+        return -1;
+    }
+
+    FT_Library lib = NULL;
+    FT_Face face = NULL;
+    if (open_face(font_file, &lib, &face) != 0) {
+        return -1;
+    }
+    set->ascent = (int)(face->size->metrics.ascender >> 6);
+    set->line_height = (int)(face->size->metrics.height >> 6);
+    int rc = list_codes(face, ranges, range_count, set);
+    FT_Done_Face(face);
+    FT_Done_FreeType(lib);
+    if (rc != 0) {
+        goto out_finish;
+    }
+
+    struct worker *workers = calloc((size_t)threads, sizeof(*workers));
+    if (workers == NULL) {
+        goto out_finish;
+    }
+    struct queue queue;
+    atomic_init(&queue.next, 0);
+    atomic_init(&queue.failed, 0);
+    int started = 0;
+    for (int i = 0; i < threads; ++i) {
+        workers[i] = (struct worker){
+            .font_file = font_file,
+            .glyphs = set->glyphs,
+            .count = set->count,
+            .queue = &queue,
+        };
+    }
+    // The caller's thread is the first worker
+    for (int i = 1; i < threads; ++i, ++started) {
+        if (pthread_create(&workers[i].thread, NULL, render_chunks, &workers[i]) != 0) {
+            atomic_store(&queue.failed, 1);
+            break;
+        }
+    }
+    (void)render_chunks(&workers[0]);
+    for (int i = 1; i <= started; ++i) {
+        (void)pthread_join(workers[i].thread, NULL);
+    }
+    free(workers);
+    if (atomic_load(&queue.failed) != 0) {
+        goto out_finish;
+    }
+    return 0;
+out_finish:
+    glyph_set_finish(set);
+    return -1;
+}
+
+void glyph_set_finish(struct glyph_set *set)
+{
+    for (size_t i = 0; i < set->count; ++i) {
+        free(set->glyphs[i].bits);
+    }
+    free(set->glyphs);
+    memset(set, 0, sizeof(*set));
+}
@@ -0,0 +1,118 @@
+#include "governor.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double SECOND = 1000.0;
+
+static const double HEADROOM = 0.75; // Fraction of the faster budget the cost must fit in to step up
+
+/// Returns the smallest divisor of the refresh rate giving at most rate.
+static int divisor_for(int refresh_rate, int rate)
+{
+    const int divisor = (refresh_rate + rate - 1) / rate;
+    return (divisor > 0) ? divisor : 1;
+}
+
+void governor_init(struct governor *gov, int refresh_rate, int max_rate, int idle_rate, double idle_timeout)
+{
+    assert(refresh_rate > 0 && max_rate > 0 && idle_rate > 0);
+    memset(gov, 0, sizeof(*gov));
+    gov->refresh_rate = refresh_rate;
+    gov->min_divisor = divisor_for(refresh_rate, max_rate);
+    gov->idle_divisor = divisor_for(refresh_rate, idle_rate);
+    if (gov->idle_divisor < gov->min_divisor) {
+        gov->idle_divisor = gov->min_divisor;
+    }
+    gov->divisor = gov->min_divisor;
+    gov->idle_timeout = idle_timeout;
+}
+
+void governor_input(struct governor *gov)
+{
+    gov->since_input = 0.0;
+}
+
+static int compare_costs(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/// Returns the nearest-rank GOVERNOR_PERCENT percentile of the costs.
+static double percentile(const struct governor *gov)
+{
+    assert(gov->count > 0);
+    double sorted[GOVERNOR_WINDOW];
+    memcpy(sorted, gov->costs, gov->count * sizeof(*sorted));
+    qsort(sorted, gov->count, sizeof(*sorted), compare_costs);
+    size_t rank = (GOVERNOR_PERCENT * gov->count + 99) / 100;
+    if (rank > 0) {
+        rank -= 1;
+    }
+    return sorted[rank];
+}
+
+static double budget(const struct governor *gov, int divisor)
+{
+    return (SECOND * (double)divisor) / (double)gov->refresh_rate;
+}
+
+/// Moves to another rate.  Costs measured before the move are dropped so
+/// that one overrun is not counted against several rates.
+static void step(struct governor *gov, int divisor)
+{
+    gov->divisor = divisor;
+    gov->headroom = 0;
+    gov->count = 0;
+    gov->next = 0;
+}
+
+static void evaluate(struct governor *gov)
+{
+    const double cost = percentile(gov);
+    if (cost > budget(gov, gov->divisor)) {
+        if (gov->divisor < gov->idle_divisor) {
+            step(gov, gov->divisor + 1);
+        }
+        gov->headroom = 0;
+        return;
+    }
+    if (gov->divisor > gov->min_divisor && cost < budget(gov, gov->divisor - 1) * HEADROOM) {
+        gov->headroom += 1;
+        if (gov->headroom >= GOVERNOR_HOLD) {
+            step(gov, gov->divisor - 1);
+        }
+        return;
+    }
+    gov->headroom = 0;
+}
+
+static int is_idle(const struct governor *gov)
+{
+    return gov->idle_timeout > 0.0 && gov->since_input >= gov->idle_timeout;
+}
+
+double governor_frame(struct governor *gov, double cost, double delta)
+{
+    gov->since_input += delta;
+    gov->costs[gov->next] = cost;
+    gov->next = (gov->next + 1) % GOVERNOR_WINDOW;
+    if (gov->count < GOVERNOR_WINDOW) {
+        gov->count += 1;
+    }
+    gov->frames += 1;
+    if (gov->frames >= GOVERNOR_PERIOD && gov->count >= GOVERNOR_PERIOD) {
+        gov->frames = 0;
+        evaluate(gov);
+    }
+    return budget(gov, is_idle(gov) ? gov->idle_divisor : gov->divisor);
+}
+
+double governor_rate(const struct governor *gov)
+{
+    const int divisor = is_idle(gov) ? gov->idle_divisor : gov->divisor;
+    return (double)gov->refresh_rate / (double)divisor;
+}
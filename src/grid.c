@@ -0,0 +1,233 @@
+#include "grid.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint32_t ABSENT = UINT32_MAX;
+
+static const float SLACK = 1e-3f; // Fraction of a cell by which covered cells clear a query's edges
+
+struct grid_cell {
+    uint32_t *ids;  // Points in the cell
+    uint32_t count; // Number of points
+    uint32_t cap;   // Capacity of ids
+};
+
+struct grid {
+    float cell;              // Width and height of a cell
+    float inv_cell;          // Reciprocal of cell
+    int cols;                // Number of columns of cells
+    int rows;                // Number of rows of cells
+    struct grid_cell *cells; // Cells, row by row
+    uint32_t cap;            // Number of ids
+    float *x;                // Horizontal position of each id
+    float *y;                // Vertical position of each id
+    uint32_t *cell_of;       // Cell of each id, or ABSENT
+    uint32_t *slot_of;       // Index of each id in its cell's ids
+};
+
+struct grid *grid_create(float width, float height, float cell, uint32_t cap)
+{
+    if (!(width > 0.0f && height > 0.0f && cell > 0.0f) || cap == 0 || cap == ABSENT) {
+        return NULL;
+    }
+    struct grid *grid = calloc(1, sizeof(*grid));
+    if (grid == NULL) {
+        return NULL;
+    }
+    grid->cell = cell;
+    grid->inv_cell = 1.0f / cell;
+    grid->cols = (int)(width / cell) + 1;
+    grid->rows = (int)(height / cell) + 1;
+    grid->cap = cap;
+    grid->cells = calloc((size_t)grid->cols * (size_t)grid->rows, sizeof(*grid->cells));
+    grid->x = malloc(cap * sizeof(*grid->x));
+    grid->y = malloc(cap * sizeof(*grid->y));
+    grid->cell_of = malloc(cap * sizeof(*grid->cell_of));
+    grid->slot_of = malloc(cap * sizeof(*grid->slot_of));
+    if (grid->cells == NULL || grid->x == NULL || grid->y == NULL
+        || grid->cell_of == NULL || grid->slot_of == NULL) {
+        grid_destroy(grid);
+        return NULL;
+    }
+    memset(grid->cell_of, 0xFF, cap * sizeof(*grid->cell_of));
+    return grid;
+}
+
+void grid_destroy(struct grid *grid)
+{
+    if (grid == NULL) {
+        return;
+    }
+    if (grid->cells != NULL) {
+        for (size_t i = 0; i < (size_t)grid->cols * (size_t)grid->rows; ++i) {
+            free(grid->cells[i].ids);
+        }
+    }
+    free(grid->cells);
+    free(grid->x);
+    free(grid->y);
+    free(grid->cell_of);
+    free(grid->slot_of);
+    free(grid);
+}
+
+void grid_clear(struct grid *grid)
+{
+    for (size_t i = 0; i < (size_t)grid->cols * (size_t)grid->rows; ++i) {
+        grid->cells[i].count = 0;
+    }
+    memset(grid->cell_of, 0xFF, grid->cap * sizeof(*grid->cell_of));
+}
+
+/// Returns the column or row containing p, clamped to [0, n).
+static inline int coord(const struct grid *grid, float p, int n)
+{
+    const float c = p * grid->inv_cell;
+    // Also catches NaN
+    if (!(c >= 0.0f)) {
+        return 0;
+    }
+    if (c >= (float)n) {
+        return n - 1;
+    }
+    return (int)c;
+}
+
+static inline uint32_t cell_at(const struct grid *grid, float x, float y)
+{
+    return (uint32_t)((coord(grid, y, grid->rows) * grid->cols) + coord(grid, x, grid->cols));
+}
+
+static int push(struct grid *grid, uint32_t c, uint32_t id)
+{
+    struct grid_cell *cell = &grid->cells[c];
+    if (cell->count == cell->cap) {
+        const uint32_t cap = (cell->cap == 0) ? 8 : cell->cap * 2;
+        uint32_t *tmp = realloc(cell->ids, cap * sizeof(*tmp));
+        if (tmp == NULL) {
+            return -1;
+        }
+        cell->ids = tmp;
+        cell->cap = cap;
+    }
+    grid->cell_of[id] = c;
+    grid->slot_of[id] = cell->count;
+    cell->ids[cell->count++] = id;
+    return 0;
+}
+
+/// Takes a point out of its cell, moving the cell's last point into its place.
+static void pop(struct grid *grid, uint32_t id)
+{
+    struct grid_cell *cell = &grid->cells[grid->cell_of[id]];
+    const uint32_t slot = grid->slot_of[id];
+    const uint32_t last = cell->ids[--cell->count];
+    cell->ids[slot] = last;
+    grid->slot_of[last] = slot;
+    grid->cell_of[id] = ABSENT;
+}
+
+int grid_move(struct grid *grid, uint32_t id, float x, float y)
+{
+    if (id >= grid->cap) {
+        return -1;
+    }
+    grid->x[id] = x;
+    grid->y[id] = y;
+    const uint32_t c = cell_at(grid, x, y);
+    if (grid->cell_of[id] == c) {
+        return 0;
+    }
+    if (grid->cell_of[id] != ABSENT) {
+        pop(grid, id);
+    }
+    return push(grid, c, id);
+}
+
+void grid_remove(struct grid *grid, uint32_t id)
+{
+    if (id < grid->cap && grid->cell_of[id] != ABSENT) {
+        pop(grid, id);
+    }
+}
+
+/// Returns whether every point the column or row can hold lies in [lo, hi).
+static inline int covers(const struct grid *grid, int c, int n, float lo, float hi)
+{
+    // Edge cells also hold the points beyond the area, and the slack absorbs
+    // rounding in coord() near cell boundaries
+    return c > 0 && c < n - 1
+           && ((float)c - SLACK) * grid->cell >= lo && ((float)(c + 1) + SLACK) * grid->cell <= hi;
+}
+
+size_t grid_query_rect(const struct grid *grid, float x, float y, float w, float h, uint32_t *out, size_t cap)
+{
+    if (!(w > 0.0f && h > 0.0f)) {
+        return 0;
+    }
+    const float x1 = x + w;
+    const float y1 = y + h;
+    const int c0 = coord(grid, x, grid->cols);
+    const int c1 = coord(grid, x1, grid->cols);
+    const int r0 = coord(grid, y, grid->rows);
+    const int r1 = coord(grid, y1, grid->rows);
+    size_t found = 0;
+    for (int r = r0; r <= r1; ++r) {
+        const int row_inside = covers(grid, r, grid->rows, y, y1);
+        for (int c = c0; c <= c1; ++c) {
+            const struct grid_cell *cell = &grid->cells[(r * grid->cols) + c];
+            if (row_inside && covers(grid, c, grid->cols, x, x1)) {
+                // Interior cells need no test per point
+                for (uint32_t i = 0; i < cell->count; ++i, ++found) {
+                    if (found < cap) {
+                        out[found] = cell->ids[i];
+                    }
+                }
+                continue;
+            }
+            for (uint32_t i = 0; i < cell->count; ++i) {
+                const uint32_t id = cell->ids[i];
+                const float px = grid->x[id];
+                const float py = grid->y[id];
+                if (px >= x && px < x1 && py >= y && py < y1) {
+                    if (found < cap) {
+                        out[found] = id;
+                    }
+                    found += 1;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+size_t grid_query_radius(const struct grid *grid, float x, float y, float radius, uint32_t *out, size_t cap)
+{
+    if (!(radius >= 0.0f)) {
+        return 0;
+    }
+    const float r2 = radius * radius;
+    const int c0 = coord(grid, x - radius, grid->cols);
+    const int c1 = coord(grid, x + radius, grid->cols);
+    const int r0 = coord(grid, y - radius, grid->rows);
+    const int r1 = coord(grid, y + radius, grid->rows);
+    size_t found = 0;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const struct grid_cell *cell = &grid->cells[(r * grid->cols) + c];
+            for (uint32_t i = 0; i < cell->count; ++i) {
+                const uint32_t id = cell->ids[i];
+                const float dx = grid->x[id] - x;
+                const float dy = grid->y[id] - y;
+                if ((dx * dx) + (dy * dy) <= r2) {
+                    if (found < cap) {
+                        out[found] = id;
+                    }
+                    found += 1;
+                }
+            }
+        }
+    }
+    return found;
+}
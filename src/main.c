@@ -1,6 +1,8 @@
 #include <assert.h>
 #include <float.h>
+#include <inttypes.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -11,10 +13,29 @@
 #include <lua.h>
 #include <lualib.h>
 
+#include "audio_meter.h"
+#include "audio_queue.h"
+#include "bmp.h"
+#include "damage.h"
+#include "entities.h"
+#include "governor.h"
+#include "grid.h"
 #include "macro.h"
 #include "message_queue.h"
+#include "mixer.h"
+#include "oscillator.h"
+#include "pacer.h"
 #include "prelude_sdl.h"
 #include "prelude_stdlib.h"
+#include "profiler.h"
+#include "raster.h"
+#include "render_list.h"
+#include "sprite_batch.h"
+#include "streamer.h"
+#include "text.h"
+#include "trace.h"
+#include "wav.h"
+#include "worker_pool.h"
 
 enum {
     AUDIO_NUM_CHANNELS = 2,
@@ -28,6 +49,12 @@ enum events {
 
 struct args {
     char *config_file;
+    char *profile_file;
+    char *trace_file;
+    uint64_t headless_frames;
+    char *dump_dir;
+    char *render_file;     // WAV file to render audio to instead of playing it
+    double render_seconds; // Length of the audio to render
 };
 
 #define WINDOW_TYPE_VARIANTS                                                 \
@@ -60,15 +87,41 @@ struct config {
     int width;
     int height;
     int frame_rate;
+    int tick_rate;
+    int max_ticks;
+    int damage_tracking;
+    int software_raster;
+    int governor;
+    int idle_rate;
+    int idle_timeout;
+    int render_thread;
+    int entities;
+    int sample_rate;
+    int audio_latency;
+    int audio_push;
+    char *music;
     char *asset_dir;
 };
 
+/// State shared between the main thread and the audio callback.
+///
+/// The main thread never locks the audio device.  It controls the voices
+/// of the mixer, which the callback drains commands for at the start of
+/// each buffer.  In push mode there is no callback, and the main thread
+/// renders buffers itself and queues them on the device.
 struct audio_state {
-    const int sample_rate;      // Samples per second
-    const uint16_t buffer_size; // Samples per buffer
+    int sample_rate;            // Samples per second, as the device granted
+    uint16_t buffer_size;       // Samples per buffer, as the device granted
     const double frequency;     // Frequency of the sine wave
     const double max_volume;    // Maximum volume
-    double volume;              // Current volume, 0.0 to max_volume
+    struct mixer *mixer;        // Voices mixed into the stream
+    struct streamer *streamer;  // Reader of the music ahead of the mixer
+    struct mixer_sample blip;   // Sample played on a key press
+    struct audio_meter meter;   // Timings of the callback against its budget
+    struct audio_queue queue;   // Latency of the device's queue in push mode
+    float *chunk;               // Buffer rendered in push mode
+    struct trace_buffer *trace; // Trace buffer of the callback, allocated ahead of it
+    size_t next_voice;          // Voice the next blip plays on, owned by the main thread
     uint64_t elapsed;           // Number of buffer fills
 };
 
@@ -77,20 +130,127 @@ struct state {
     struct audio_state audio;
     int loop_stat;
     int tone_stat;
+    int music_stat; // 1 when playing, 2 when waiting for the stream to close to play again
+    int overlay_stat;
+    int display_stat; // Whether the window may be on another display
+    int resize_stat;  // Whether the window's size changed
+};
+
+struct sim_clock {
+    double tick_time;   // Time in milliseconds for a simulation tick
+    double accumulator; // Unsimulated time in milliseconds
+    int max_ticks;      // Maximum number of ticks per frame
+};
+
+struct scene {
+    SDL_Texture *texture;       // Full-window background texture
+    SDL_Rect win_rect;          // Window rectangle
+    struct text *text;          // Text object, or NULL
+    struct sprite_batch *batch; // Batch collecting the frame's quads
+    const char *overlay;        // Overlay text, or NULL to hide the overlay
+    SDL_Rect overlay_rect;      // Extent of the overlay, empty when hidden
+    SDL_Texture *backbuffer;    // Copy of the last frame, or NULL to redraw everything
+    struct damage damage;       // Regions of the backbuffer to redraw
+    uint64_t redrawn;           // Pixels redrawn by the last frame
+    struct worker_pool *pool;   // Threads of the raster
+    struct raster *raster;      // CPU rasterizer drawing into texture, or NULL
+    SDL_Surface *background;    // Background pixels read by the raster
+    const struct world *world;  // Entities drawn over the background, or NULL
+};
+
+struct world {
+    struct entities entities; // Moving objects
+    struct worker_pool *pool; // Threads moving the entities, or NULL
+    float width;              // Width of the area the entities wrap around
+    float height;             // Height of the area the entities wrap around
+    struct grid *grid;        // Positions of the entities, by slot
+    SDL_FRect view;           // Part of the area shown in the window
+    uint32_t *visible;        // Slots of the entities in view
+    size_t visible_count;     // Number of entities in view
+    SDL_Texture *dot;         // White texel the entities are drawn with
+    float tick;               // Length of a simulation tick in seconds
 };
 
 struct window {
-    SDL_Window *window;
+    SDL_Window *window;   // The window, or NULL when offscreen
+    SDL_Surface *surface; // The render target when offscreen, or NULL
     SDL_Renderer *renderer;
 };
 
+/// State shared between the main thread and the render thread.
+///
+/// Polling events runs the renderer's window event watch on the main
+/// thread, which updates the viewport, so the render thread holds the lock
+/// while it replays a frame and the main thread holds it while it polls or
+/// resizes.  Presenting runs outside of it.  The main thread reads what the
+/// render thread measures from snapshots, and asks it to change its pacer
+/// and profiler through atomics it applies between frames.
+struct presenter {
+    SDL_Renderer *renderer;        // Renderer, used only by the render thread while it runs
+    struct sprite_batch *batch;    // Batch, used only by the render thread while it runs
+    struct render_queue queue;     // Frames recorded by the main thread
+    SDL_mutex *lock;               // Lock on the renderer's state, or NULL without a render thread
+    SDL_mutex *snapshot_lock;      // Lock on the snapshots, or NULL without a render thread
+    struct pacer pacer;            // Present intervals, measured on the render thread
+    struct profiler prof;          // Render phases, timed on the render thread
+    struct pacer pacer_snapshot;   // Copy of pacer, taken after each present
+    struct profiler prof_snapshot; // Copy of prof, taken after each present while profiling
+    uint64_t epoch;                // Start of the main loop
+    atomic_int refresh_rate;       // Refresh rate to pace on
+    atomic_int profiling;          // Whether to time the render phases
+    atomic_int failed;             // Set when the render thread stops on an error
+};
+
 static const double SECOND = 1000.0;
 
 static const uint32_t QUEUE_CAP = 4U;
 
+static const uint64_t OVERLAY_REFRESH = 16U; // Frames between overlay updates
+
+static const int OVERLAY_MARGIN = 8;
+
+static const int BATCH_CAP = 4096; // Quads per submission
+
+static const size_t AUDIO_VOICES = 32U; // Voices of the mixer
+
+static const size_t TONE_VOICE = 0U; // Voice of the sine wave
+
+static const size_t MUSIC_VOICE = 1U; // Voice of the music
+
+static const size_t BLIP_VOICE = 2U; // First of the voices blips play on
+
+static const size_t MUSIC_FRAMES = 16384U; // Frames of music read ahead of the mixer
+
+static const double BLIP_LENGTH = 150.0; // Milliseconds of the blip sample
+
+static const double AUDIO_RAMP = 5.0; // Milliseconds a volume change is spread over
+
+static const uint64_t RENDER_BLIP_EVERY = 4U; // Buffers between blips when rendering audio offline
+
+static const uint16_t AUDIO_MIN_BUFFER = 64U; // Least samples per buffer asked of the device
+
+static const uint16_t AUDIO_MAX_BUFFER = 32768U; // Most samples per buffer asked of the device
+
+static const int AUDIO_PUSH_GRANULES = 4; // Buffers the latency is split into in push mode
+
+static const size_t AUDIO_PUSH_HEADROOM = 4U; // Most queued latency in push mode, in multiples of the configured latency or the longest frame
+
+static const size_t RENDER_LIST_CAP = 64U; // Commands per frame before a render list grows
+
+static const int WORLD_SCALE = 3; // Width and height of the world in windows
+
+static const float GRID_CELL = 64.0f; // Width and height of a cell of the world's grid
+
+static const float DOT_SIZE = 4.0f; // Width and height of an entity in pixels
+
+static const SDL_Color DOT_COLOR = {0xFF, 0xC0, 0x40, 0xFF};
+
+static const SDL_Color OVERLAY_FG = {0xFF, 0xFF, 0xFF, 0xFF};
+static const SDL_Color OVERLAY_BG = {0x00, 0x00, 0x00, 0xC0};
+
 static uint64_t perf_freq = 0;
 
-static struct args as = {.config_file = "config.lua"};
+static struct args as = {.config_file = "config.lua", .profile_file = NULL, .trace_file = NULL, .headless_frames = 0, .dump_dir = NULL, .render_file = NULL, .render_seconds = 10.0};
 
 static struct config cfg = {
     .window_type = WINDOWED,
@@ -99,23 +259,56 @@ static struct config cfg = {
     .width = 1280,
     .height = 720,
     .frame_rate = 60,
+    .tick_rate = 60,
+    .max_ticks = 5,
+    .damage_tracking = 0,
+    .software_raster = 0,
+    .governor = 0,
+    .idle_rate = 10,
+    .idle_timeout = 5000,
+    .render_thread = 0,
+    .entities = 0,
+    .sample_rate = 48000,
+    .audio_latency = 20,
+    .audio_push = 0,
+    .music = NULL,
     .asset_dir = "./assets",
 };
 
 static struct state st = {
     .audio_device = 0,
     .audio = {
-        .sample_rate = 48000,
-        .buffer_size = 2048,
         .frequency = 440.0,
         .max_volume = 0.25,
-        .volume = 0.0,
+        .mixer = NULL,
+        .streamer = NULL,
+        .chunk = NULL,
+        .trace = NULL,
+        .next_voice = 0,
         .elapsed = 0,
     },
     .loop_stat = 1,
     .tone_stat = 0,
+    .music_stat = 0,
+    .overlay_stat = 0,
+    .display_stat = 0,
+    .resize_stat = 0,
 };
 
+static struct profiler prof = {0};
+
+static struct profiler snapshot_prof = {0};
+
+static struct governor gov = {0};
+
+static struct pacer pacer = {0};
+
+static struct scene scene = {0};
+
+static struct presenter presenter = {0};
+
+static struct world world = {0};
+
 /// Parses command line arguments and populates args with the results.
 ///
 /// @param argc The number of arguments
@@ -127,10 +320,48 @@ static int parse_args(int argc, char *argv[], struct args *as)
     for (int i = 0; i < argc;) {
         arg = argv[i++];
         if (strcmp(arg, "-c") == 0 || strcmp(arg, "--config") == 0) {
-            if (i + 1 >= argc) {
+            if (i >= argc) {
                 return -1;
             }
             as->config_file = argv[i++];
+        } else if (strcmp(arg, "-p") == 0 || strcmp(arg, "--profile") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            as->profile_file = argv[i++];
+        } else if (strcmp(arg, "-t") == 0 || strcmp(arg, "--trace") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            as->trace_file = argv[i++];
+        } else if (strcmp(arg, "--headless") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            char *end = NULL;
+            as->headless_frames = strtoull(argv[i++], &end, 10);
+            if (*end != '\0' || as->headless_frames == 0) {
+                return -1;
+            }
+        } else if (strcmp(arg, "--dump") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            as->dump_dir = argv[i++];
+        } else if (strcmp(arg, "--render-audio") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            as->render_file = argv[i++];
+        } else if (strcmp(arg, "--render-seconds") == 0) {
+            if (i >= argc) {
+                return -1;
+            }
+            char *end = NULL;
+            as->render_seconds = strtod(argv[i++], &end);
+            if (*end != '\0' || !(as->render_seconds > 0.0)) {
+                return -1;
+            }
         }
     }
     return 0;
@@ -150,6 +381,114 @@ static char *joinpath2(const char *a, const char *b)
     return ret;
 }
 
+/// Reads a numeric global from a Lua state.
+///
+/// @param state The Lua state
+/// @param name The name of the global
+/// @param out The location to store the value
+/// @return 0 on success, -1 on failure
+static int load_int(lua_State *state, const char *name, int *out)
+{
+    lua_getglobal(state, name);
+    if (!lua_isnumber(state, -1)) {
+        SDL_LogError(ERR, "%s: %s is not a number", __func__, name);
+        lua_pop(state, 1);
+        return -1;
+    }
+    *out = (int)lua_tonumber(state, -1);
+    lua_pop(state, 1);
+    return 0;
+}
+
+/// Reads a numeric global from a Lua state, if it is set, so that config
+/// files written before the setting existed still load.
+///
+/// @param state The Lua state
+/// @param name The name of the global
+/// @param out The location to store the value, left as it is if the global is nil
+/// @return 0 on success, -1 on failure
+static int load_opt_int(lua_State *state, const char *name, int *out)
+{
+    lua_getglobal(state, name);
+    const int unset = lua_isnil(state, -1);
+    lua_pop(state, 1);
+    return unset ? 0 : load_int(state, name, out);
+}
+
+/// Reads a boolean global from a Lua state.
+///
+/// @param state The Lua state
+/// @param name The name of the global
+/// @param out The location to store the value
+/// @return 0 on success, -1 on failure
+static int load_bool(lua_State *state, const char *name, int *out)
+{
+    lua_getglobal(state, name);
+    if (!lua_isboolean(state, -1)) {
+        SDL_LogError(ERR, "%s: %s is not a boolean", __func__, name);
+        lua_pop(state, 1);
+        return -1;
+    }
+    *out = lua_toboolean(state, -1);
+    lua_pop(state, 1);
+    return 0;
+}
+
+/// Reads a boolean global from a Lua state, if it is set.
+///
+/// @param state The Lua state
+/// @param name The name of the global
+/// @param out The location to store the value, left as it is if the global is nil
+/// @return 0 on success, -1 on failure
+static int load_opt_bool(lua_State *state, const char *name, int *out)
+{
+    lua_getglobal(state, name);
+    const int unset = lua_isnil(state, -1);
+    lua_pop(state, 1);
+    return unset ? 0 : load_bool(state, name, out);
+}
+
+/// Reads a string global from a Lua state.  Caller is responsible for
+/// freeing the returned string.
+///
+/// @param state The Lua state
+/// @param name The name of the global
+/// @param out The location to store the string, or NULL if it is empty
+/// @return 0 on success, -1 on failure
+static int load_string(lua_State *state, const char *name, char **out)
+{
+    lua_getglobal(state, name);
+    if (!lua_isstring(state, -1)) {
+        SDL_LogError(ERR, "%s: %s is not a string", __func__, name);
+        lua_pop(state, 1);
+        return -1;
+    }
+    size_t len = 0;
+    const char *str = lua_tolstring(state, -1, &len);
+    *out = NULL;
+    if (len > 0) {
+        *out = ecalloc(len + 1, sizeof(**out)); // incr for terminator
+        memcpy(*out, str, len);
+    }
+    lua_pop(state, 1);
+    return 0;
+}
+
+/// Reads a string global from a Lua state, if it is set.  Caller is
+/// responsible for freeing the returned string.
+///
+/// @param state The Lua state
+/// @param name The name of the global
+/// @param out The location to store the string, left as it is if the global is nil
+/// @return 0 on success, -1 on failure
+static int load_opt_string(lua_State *state, const char *name, char **out)
+{
+    lua_getglobal(state, name);
+    const int unset = lua_isnil(state, -1);
+    lua_pop(state, 1);
+    return unset ? 0 : load_string(state, name, out);
+}
+
 /// Loads and parses a config file and populate config with the results.
 ///
 /// @param file The config file to load
@@ -158,6 +497,7 @@ static char *joinpath2(const char *a, const char *b)
 static int load_config(const char *file, struct config *cfg)
 {
     int ret = -1;
+    struct config tmp = *cfg;
     lua_State *state = luaL_newstate();
     if (state == NULL) {
         SDL_LogError(ERR, "%s: luaL_newstate failed", __func__);
@@ -169,57 +509,155 @@ static int load_config(const char *file, struct config *cfg)
                      file, lua_tostring(state, -1));
         goto out_close_state;
     }
-    lua_getglobal(state, "width");
-    lua_getglobal(state, "height");
-    lua_getglobal(state, "framerate");
-    if (!lua_isnumber(state, -3)) {
-        SDL_LogError(ERR, "%s: width is not a number", __func__);
-        goto out_close_state;
+    if (load_int(state, "width", &tmp.width) != 0
+        || load_int(state, "height", &tmp.height) != 0
+        || load_int(state, "framerate", &tmp.frame_rate) != 0
+        || load_opt_int(state, "tickrate", &tmp.tick_rate) != 0
+        || load_opt_int(state, "maxticks", &tmp.max_ticks) != 0
+        || load_opt_bool(state, "damagetracking", &tmp.damage_tracking) != 0
+        || load_opt_bool(state, "softwareraster", &tmp.software_raster) != 0
+        || load_opt_bool(state, "governor", &tmp.governor) != 0
+        || load_opt_int(state, "idlerate", &tmp.idle_rate) != 0
+        || load_opt_int(state, "idletimeout", &tmp.idle_timeout) != 0
+        || load_opt_bool(state, "renderthread", &tmp.render_thread) != 0
+        || load_opt_int(state, "entities", &tmp.entities) != 0
+        || load_opt_int(state, "samplerate", &tmp.sample_rate) != 0
+        || load_opt_int(state, "audiolatency", &tmp.audio_latency) != 0
+        || load_opt_bool(state, "audiopush", &tmp.audio_push) != 0
+        || load_opt_string(state, "music", &tmp.music) != 0) {
+        goto out_free_music;
     }
-    if (!lua_isnumber(state, -2)) {
-        SDL_LogError(ERR, "%s: height is not a number", __func__);
-        goto out_close_state;
+    if (tmp.frame_rate <= 0 || tmp.tick_rate <= 0 || tmp.max_ticks <= 0) {
+        SDL_LogError(ERR, "%s: framerate, tickrate and maxticks must be positive", __func__);
+        goto out_free_music;
     }
-    if (!lua_isnumber(state, -1)) {
-        SDL_LogError(ERR, "%s: framerate is not a number", __func__);
-        goto out_close_state;
+    if (tmp.idle_rate <= 0 || tmp.idle_timeout < 0) {
+        SDL_LogError(ERR, "%s: idlerate must be positive and idletimeout not negative", __func__);
+        goto out_free_music;
+    }
+    if (tmp.entities < 0 || tmp.entities > ENTITY_MAX) {
+        SDL_LogError(ERR, "%s: entities must be between 0 and %d", __func__, ENTITY_MAX);
+        goto out_free_music;
     }
-    cfg->width = (int)lua_tonumber(state, -3);
-    cfg->height = (int)lua_tonumber(state, -2);
-    cfg->frame_rate = (int)lua_tonumber(state, -1);
+    if (tmp.sample_rate < 8000 || tmp.sample_rate > 192000 || tmp.audio_latency < 1 || tmp.audio_latency > 1000) {
+        SDL_LogError(ERR, "%s: samplerate must be between 8000 and 192000 and audiolatency between 1 and 1000", __func__);
+        goto out_free_music;
+    }
+    *cfg = tmp;
     ret = 0;
+out_free_music:
+    if (ret != 0 && tmp.music != cfg->music) {
+        free(tmp.music);
+    }
 out_close_state:
     lua_close(state);
     return ret;
 }
 
-/// Calculates a sine wave and write it to the stream.
+/// Mixes the playing voices into a buffer of the granted size.
+///
+/// @param as The audio state
+/// @param out The buffer to write to
+static void mix_buffer(struct audio_state *as, float *out)
+{
+    trace_begin("mix_audio");
+    mixer_render(as->mixer, out, (size_t)as->buffer_size);
+    as->elapsed += 1;
+    trace_end("mix_audio");
+}
+
+/// Mixes the playing voices and writes them to the stream.
 ///
 /// @param userdata The userdata passed to SDL_OpenAudioDevice
 /// @param stream The stream to write to
 /// @param len The length of the stream
-static void calc_sine(void *userdata, uint8_t *stream, int len)
+static void mix_audio(void *userdata, uint8_t *stream, int len)
 {
     struct audio_state *as = userdata;
     float *fstream = (float *)stream;
 
     _Static_assert(sizeof(*fstream) == 4, "sizeof(*fstream) != 4");
-    _Static_assert(AUDIO_NUM_CHANNELS != 0, "AUDIO_NUM_CHANNELS == 0");
+    _Static_assert(AUDIO_NUM_CHANNELS == 2, "AUDIO_NUM_CHANNELS != 2");
     assert((len / ((int)sizeof(*fstream) * AUDIO_NUM_CHANNELS)) == as->buffer_size);
     (void)len;
 
-    const double sample_rate = (double)as->sample_rate;
-    const uint64_t buffer_size = (uint64_t)as->buffer_size;
-    const uint64_t offset = as->elapsed * buffer_size;
+    if (as->elapsed == 0) {
+        trace_thread_attach(as->trace);
+    }
+    const uint64_t begin = now();
+    mix_buffer(as, fstream);
+    audio_meter_record(&as->meter, begin, now());
+}
+
+/// Calculates the buffer size to ask the device for, as the power of two
+/// nearest a latency.
+///
+/// @param sample_rate The sample rate.
+/// @param latency The latency in milliseconds.
+/// @return The samples per buffer.
+static uint16_t calc_audio_buffer(int sample_rate, double latency)
+{
+    extern const double SECOND;
+    extern const uint16_t AUDIO_MIN_BUFFER;
+    extern const uint16_t AUDIO_MAX_BUFFER;
+
+    const double frames = (sample_rate * latency) / SECOND;
+    uint16_t ret = AUDIO_MIN_BUFFER;
+    while (ret < AUDIO_MAX_BUFFER && (double)ret * 1.5 < frames) {
+        ret = (uint16_t)(ret * 2);
+    }
+    return ret;
+}
 
-    for (uint64_t i = 0; i < buffer_size; ++i) {
-        const double time = (double)(offset + i) / sample_rate;
-        const double x = 2.0 * M_PI * time * as->frequency;
-        const double y = as->volume * sin(x);
-        fstream[AUDIO_NUM_CHANNELS * i + 0] = (float)y;
-        fstream[AUDIO_NUM_CHANNELS * i + 1] = (float)y;
+/// Tops up the device's queue in push mode, a buffer at a time.
+///
+/// @param as The audio state.
+/// @param device The audio device.
+/// @return 0 on success, -1 on error.
+static int push_audio(struct audio_state *as, SDL_AudioDeviceID device)
+{
+    const size_t frame_size = AUDIO_NUM_CHANNELS * sizeof(*as->chunk);
+    const size_t queued = SDL_GetQueuedAudioSize(device) / frame_size;
+    trace_counter("audio_queued", (double)queued);
+    size_t n = audio_queue_top_up(&as->queue, queued);
+    trace_begin("push_audio");
+    for (; n > 0; n -= as->buffer_size) {
+        mix_buffer(as, as->chunk);
+        if (SDL_QueueAudio(device, as->chunk, (uint32_t)(as->buffer_size * frame_size)) != 0) {
+            log_sdl_error("SDL_QueueAudio failed");
+            trace_end("push_audio");
+            return -1;
+        }
     }
-    as->elapsed += 1;
+    trace_end("push_audio");
+    return 0;
+}
+
+/// Creates a short sine which decays away, to play on many voices at once.
+///
+/// @param sample_rate The sample rate in Hz.
+/// @param blip The sample to describe it with.
+/// @return The samples, or NULL on error.
+static float *create_blip(int sample_rate, struct mixer_sample *blip)
+{
+    extern const double SECOND;
+    extern const double BLIP_LENGTH;
+
+    const size_t count = (size_t)((BLIP_LENGTH * sample_rate) / SECOND);
+    float *samples = malloc(count * sizeof(*samples));
+    if (samples == NULL) {
+        SDL_LogError(ERR, "%s: malloc failed", __func__);
+        return NULL;
+    }
+    struct oscillator osc = {0};
+    oscillator_init(&osc, 880.0, sample_rate);
+    oscillator_sine(&osc, samples, count, 1.0f);
+    // Falls by 1/e every eighth of the length, ending close enough to 0 not to click
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] *= (float)exp(-8.0 * (double)i / (double)count);
+    }
+    *blip = (struct mixer_sample){.samples = samples, .count = count, .loop = 0};
+    return samples;
 }
 
 /// Calculates the time in milliseconds for a frame.
@@ -250,21 +688,48 @@ static double calc_delta(const uint64_t begin, const uint64_t end)
     return (delta_ticks * SECOND) / (double)perf_freq;
 }
 
-/// Waits until the current frame end before returning.
+/// Advances the simulation by as many fixed ticks as fit in the elapsed time.
+///
+/// At most max_ticks ticks are run per call.  If the simulation still lags
+/// behind after that, the remaining backlog is dropped rather than carried
+/// into the next frame, so a slow frame cannot snowball into ever longer
+/// ones.
+///
+/// @param clock The simulation clock
+/// @param delta The time in milliseconds since the last call
+/// @param update The function advancing the simulation by one tick
+/// @return The interpolation factor between the last two ticks, 0.0 to 1.0
+static double step_simulation(struct sim_clock *clock, double delta, void (*update)(double))
+{
+    assert(clock->tick_time > 0);
+    clock->accumulator += delta;
+    int ticks = 0;
+    while (clock->accumulator >= clock->tick_time && ticks < clock->max_ticks) {
+        update(clock->tick_time);
+        clock->accumulator -= clock->tick_time;
+        ++ticks;
+    }
+    if (clock->accumulator >= clock->tick_time) {
+        SDL_LogDebug(APP, "%s: dropped %.3f ms of simulation", __func__, clock->accumulator);
+        clock->accumulator = fmod(clock->accumulator, clock->tick_time);
+    }
+    return clock->accumulator / clock->tick_time;
+}
+
+/// Waits until a deadline before returning.
 ///
-/// @param frame_time The desired time in milliseconds for a frame
-/// @param begin The timestamp in ticks when the frame started
-static void delay_frame(const double frame_time, const uint64_t begin)
+/// @param deadline The deadline in milliseconds after epoch
+/// @param epoch The timestamp in ticks the deadline is relative to
+static void delay_until(const double deadline, const uint64_t epoch)
 {
-    assert(frame_time > 0);
-    if (calc_delta(begin, now()) >= frame_time) {
+    if (calc_delta(epoch, now()) >= deadline) {
         return;
     }
-    const uint32_t time = (uint32_t)(frame_time - calc_delta(begin, now()) - 1.0);
+    const uint32_t time = (uint32_t)(deadline - calc_delta(epoch, now()) - 1.0);
     if (time > 0) {
         SDL_Delay(time);
     }
-    while (calc_delta(begin, now()) < frame_time) {}
+    while (calc_delta(epoch, now()) < deadline) {}
 }
 
 /// Initializes a window and renderer.
@@ -317,6 +782,9 @@ static void window_finish(struct window *win)
     if (win->window != NULL) {
         SDL_DestroyWindow(win->window);
     }
+    if (win->surface != NULL) {
+        SDL_FreeSurface(win->surface);
+    }
 }
 
 /// Creates a window and renderer.
@@ -326,7 +794,7 @@ static void window_finish(struct window *win)
 /// @return The window on success, NULL on failure.
 static struct window *window_create(struct config *cfg, const char *title)
 {
-    struct window *win = emalloc(sizeof(*win));
+    struct window *win = ecalloc(1, sizeof(*win));
     const int rc = window_init(cfg, title, win);
     if (rc != 0) {
         free(win);
@@ -347,6 +815,82 @@ static void window_destroy(struct window *win)
     free(win);
 }
 
+/// Creates an offscreen surface with a software renderer drawing into it.
+///
+/// @param cfg The configuration.
+/// @return The window on success, NULL on failure.
+static struct window *offscreen_create(struct config *cfg)
+{
+    struct window *win = ecalloc(1, sizeof(*win));
+    win->surface = SDL_CreateRGBSurfaceWithFormat(0, cfg->width, cfg->height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (win->surface == NULL) {
+        log_sdl_error("SDL_CreateRGBSurfaceWithFormat failed");
+        free(win);
+        return NULL;
+    }
+    win->renderer = SDL_CreateSoftwareRenderer(win->surface);
+    if (win->renderer == NULL) {
+        log_sdl_error("SDL_CreateSoftwareRenderer failed");
+        window_destroy(win);
+        return NULL;
+    }
+    const int rc = SDL_SetRenderDrawColor(win->renderer, 0x00, 0x00, 0x00, 0xFF);
+    if (rc != 0) {
+        log_sdl_error("SDL_SetRenderDrawColor failed");
+        window_destroy(win);
+        return NULL;
+    }
+    return win;
+}
+
+/// Writes the contents of an offscreen surface to a bitmap file.
+///
+/// @param surface An ARGB8888 surface.
+/// @param file The path to the bitmap file.
+/// @return 0 on success, -1 on failure.
+static int dump_surface(SDL_Surface *surface, const char *file)
+{
+    assert(surface->format->format == SDL_PIXELFORMAT_ARGB8888);
+    _Static_assert(sizeof(bmp_pixel32) == sizeof(uint32_t), "sizeof(bmp_pixel32) != sizeof(uint32_t)");
+
+    const size_t width = (size_t)surface->w;
+    const size_t height = (size_t)surface->h;
+    bmp_pixel32 *buffer = ecalloc(width * height, sizeof(*buffer));
+    if (SDL_LockSurface(surface) != 0) {
+        log_sdl_error("SDL_LockSurface failed");
+        free(buffer);
+        return -1;
+    }
+    // Bitmaps are stored bottom-up
+    for (size_t y = height, i = 0; y-- > 0; i += width) {
+        const uint8_t *row = (const uint8_t *)surface->pixels + (y * (size_t)surface->pitch);
+        memcpy(&buffer[i], row, width * sizeof(*buffer));
+    }
+    SDL_UnlockSurface(surface);
+    const int rc = bmp_v4_write(buffer, width, height, file);
+    free(buffer);
+    return rc;
+}
+
+/// Writes a numbered frame to a bitmap file in a directory.
+///
+/// @param surface An ARGB8888 surface.
+/// @param dir The directory.
+/// @param frame The frame number.
+/// @return 0 on success, -1 on failure.
+static int dump_frame(SDL_Surface *surface, const char *dir, uint64_t frame)
+{
+    char name[32] = {0};
+    (void)snprintf(name, sizeof(name), "frame_%06" PRIu64 ".bmp", frame);
+    char *file = joinpath2(dir, name);
+    const int rc = dump_surface(surface, file);
+    if (rc != 0) {
+        SDL_LogError(ERR, "%s: failed to write %s", __func__, file);
+    }
+    free(file);
+    return rc;
+}
+
 /// Gets the window's rectangle.
 ///
 /// @param win The window.
@@ -365,6 +909,25 @@ static int get_rect(struct window *win, SDL_Rect *rect)
     return 0;
 }
 
+/// Gets the refresh rate of the display showing the window.
+///
+/// @param win The window
+/// @param fallback The rate to return if the refresh rate is unknown
+/// @return The refresh rate.
+static int get_refresh_rate(struct window *win, int fallback)
+{
+    if (win->window == NULL) {
+        return fallback;
+    }
+    const int display = SDL_GetWindowDisplayIndex(win->window);
+    SDL_DisplayMode mode = {0};
+    if (display < 0 || SDL_GetCurrentDisplayMode(display, &mode) != 0) {
+        log_sdl_error("Failed to get the display mode");
+        return fallback;
+    }
+    return (mode.refresh_rate > 0) ? mode.refresh_rate : fallback;
+}
+
 /// Creates a texture from a bitmap file.
 ///
 /// @param win The window.
@@ -386,6 +949,217 @@ static SDL_Texture *create_texture(struct window *win, const char *path)
     return texture;
 }
 
+/// Sets up the scene to rasterize its background on the CPU.
+///
+/// @param scene The scene
+/// @param renderer The renderer
+/// @param rect The window rectangle
+/// @param path The path of the background image
+/// @return The streaming texture the raster is drawn into, or NULL on failure.
+static SDL_Texture *scene_raster_init(struct scene *scene, SDL_Renderer *renderer,
+                                      const SDL_Rect *rect, const char *path)
+{
+    SDL_Surface *loaded = SDL_LoadBMP(path);
+    if (loaded == NULL) {
+        log_sdl_error("SDL_LoadBMP failed");
+        return NULL;
+    }
+    scene->background = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (scene->background == NULL) {
+        log_sdl_error("SDL_ConvertSurfaceFormat failed");
+        return NULL;
+    }
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_STREAMING, rect->w, rect->h);
+    if (texture == NULL) {
+        log_sdl_error("SDL_CreateTexture failed");
+        goto out_free_background;
+    }
+    scene->pool = worker_pool_create(0);
+    if (scene->pool == NULL) {
+        goto out_destroy_texture;
+    }
+    scene->raster = raster_create(rect->w, rect->h, scene->pool);
+    if (scene->raster == NULL) {
+        goto out_destroy_pool;
+    }
+    SDL_LogInfo(APP, "Rasterizing with %d threads", worker_pool_size(scene->pool));
+    return texture;
+out_destroy_pool:
+    worker_pool_destroy(scene->pool);
+    scene->pool = NULL;
+out_destroy_texture:
+    SDL_DestroyTexture(texture);
+out_free_background:
+    SDL_FreeSurface(scene->background);
+    scene->background = NULL;
+    return NULL;
+}
+
+/// Frees the scene's rasterizer, if any.
+///
+/// @param scene The scene
+static void scene_raster_finish(struct scene *scene)
+{
+    raster_destroy(scene->raster);
+    worker_pool_destroy(scene->pool);
+    if (scene->background != NULL) {
+        SDL_FreeSurface(scene->background);
+    }
+    scene->raster = NULL;
+    scene->pool = NULL;
+    scene->background = NULL;
+}
+
+/// Frees the world's entities.
+///
+/// @param world The world
+static void world_finish(struct world *world)
+{
+    worker_pool_destroy(world->pool);
+    if (world->dot != NULL) {
+        SDL_DestroyTexture(world->dot);
+    }
+    free(world->visible);
+    grid_destroy(world->grid);
+    entities_finish(&world->entities);
+    world->pool = NULL;
+    world->dot = NULL;
+    world->visible = NULL;
+    world->visible_count = 0;
+    world->grid = NULL;
+}
+
+/// Creates the white texel entities are drawn with.
+///
+/// @param renderer The renderer
+/// @return The texture on success, NULL on failure.
+static SDL_Texture *create_dot(SDL_Renderer *renderer)
+{
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 1, 1);
+    if (texture == NULL) {
+        log_sdl_error("SDL_CreateTexture failed");
+        return NULL;
+    }
+    const uint32_t white = 0xFFFFFFFF;
+    if (SDL_UpdateTexture(texture, NULL, &white, sizeof(white)) != 0) {
+        log_sdl_error("SDL_UpdateTexture failed");
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+    return texture;
+}
+
+/// Spawns entities at pseudo-random positions and velocities across an
+/// area of WORLD_SCALE by WORLD_SCALE windows, viewed through the middle
+/// one.
+///
+/// The same entities are spawned on every run, so headless runs stay
+/// reproducible.
+///
+/// @param world The world
+/// @param count The number of entities
+/// @param rect The window rectangle
+/// @param renderer The renderer
+/// @return 0 on success, -1 on failure.
+static int world_init(struct world *world, int count, const SDL_Rect *rect, SDL_Renderer *renderer)
+{
+    extern const int WORLD_SCALE;
+    extern const float GRID_CELL;
+
+    world->width = (float)(rect->w * WORLD_SCALE);
+    world->height = (float)(rect->h * WORLD_SCALE);
+    world->view = (SDL_FRect){(float)rect->w, (float)rect->h, (float)rect->w, (float)rect->h};
+    if (count == 0) {
+        return 0;
+    }
+    if (entities_init(&world->entities, (size_t)count) != 0) {
+        SDL_LogError(ERR, "%s: failed to allocate %d entities", __func__, count);
+        return -1;
+    }
+    world->grid = grid_create(world->width, world->height, GRID_CELL, (uint32_t)count);
+    world->visible = malloc((size_t)count * sizeof(*world->visible));
+    if (world->grid == NULL || world->visible == NULL) {
+        SDL_LogError(ERR, "%s: failed to allocate the grid", __func__);
+        goto out_finish;
+    }
+    world->dot = create_dot(renderer);
+    if (world->dot == NULL) {
+        goto out_finish;
+    }
+    // Small worlds move faster on one thread than on several
+    if (count > ENTITY_CHUNK) {
+        world->pool = worker_pool_create(0);
+        if (world->pool == NULL) {
+            goto out_finish;
+        }
+    }
+    uint32_t state = 1;
+    for (int i = 0; i < count; ++i) {
+        float r[4];
+        for (size_t j = 0; j < 4; ++j) {
+            state = state * 1664525U + 1013904223U;
+            r[j] = (float)(state >> 8) / (float)(1U << 24);
+        }
+        (void)entities_create(&world->entities, r[0] * world->width, r[1] * world->height,
+                              (r[2] * 200.0f) - 100.0f, (r[3] * 200.0f) - 100.0f);
+    }
+    return 0;
+out_finish:
+    world_finish(world);
+    return -1;
+}
+
+/// Re-buckets the entities which moved to another cell and finds the ones
+/// in view.
+///
+/// @param world The world
+/// @return 0 on success, -1 on failure.
+static int world_cull(struct world *world)
+{
+    extern const float DOT_SIZE;
+
+    const struct entities *es = &world->entities;
+    if (es->count == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < es->count; ++i) {
+        if (grid_move(world->grid, es->owner[i], es->x[i], es->y[i]) != 0) {
+            SDL_LogError(ERR, "%s: grid_move failed", __func__);
+            return -1;
+        }
+    }
+    // Entities are drawn from their position down and right, so those just
+    // above and left of the view overlap it
+    const SDL_FRect *view = &world->view;
+    world->visible_count = grid_query_rect(world->grid, view->x - DOT_SIZE, view->y - DOT_SIZE,
+                                           view->w + DOT_SIZE, view->h + DOT_SIZE,
+                                           world->visible, es->count);
+    return 0;
+}
+
+/// Returns where a visible entity is drawn in the window.
+///
+/// The entity is carried along its velocity by the part of a tick elapsed
+/// since the last one, so that it moves smoothly when frames and ticks do
+/// not line up.
+///
+/// @param world The world
+/// @param i The index in the world's visible entities
+/// @param alpha The interpolation factor between the last two simulation ticks
+/// @param dst The rectangle to fill
+static void world_dot(const struct world *world, size_t i, double alpha, SDL_FRect *dst)
+{
+    extern const float DOT_SIZE;
+
+    const struct entities *es = &world->entities;
+    const size_t index = es->slots[world->visible[i]].dense;
+    const float lead = (float)alpha * world->tick;
+    *dst = (SDL_FRect){es->x[index] + (es->vx[index] * lead) - world->view.x,
+                       es->y[index] + (es->vy[index] * lead) - world->view.y, DOT_SIZE, DOT_SIZE};
+}
+
 /// Handles events.
 ///
 /// @param data The data passed to the thread.
@@ -395,6 +1169,9 @@ static int handle(void *data)
     struct message_queue *queue = data;
     (void)queue;
 
+    trace_thread_name("handler");
+    trace_begin("handle");
+
     SDL_Event event = {
         .user = {
             .type = EVENT_0,
@@ -404,6 +1181,8 @@ static int handle(void *data)
         },
     };
     const int rc = SDL_PushEvent(&event);
+    trace_instant("push_event");
+    trace_end("handle");
     if (rc == 0) {
         SDL_LogDebug(APP, "SDL_PushEvent filtered");
     } else if (rc < 0) {
@@ -413,22 +1192,203 @@ static int handle(void *data)
     return 0;
 }
 
-/// Handles keydown events.
+/// Plays the blip sample on the next of the voices set aside for it,
+/// panning each further right.
 ///
-/// @param key The keydown event.
-/// @param st The state.
+/// @param as The audio state.
+/// @return 0 on success, -1 on error.
+static int play_blip(struct audio_state *as)
+{
+    extern const size_t BLIP_VOICE;
+
+    const size_t voices = mixer_voices(as->mixer) - BLIP_VOICE;
+    const size_t n = as->next_voice;
+    const float pan = (voices > 1) ? ((2.0f * (float)n) / (float)(voices - 1)) - 1.0f : 0.0f;
+    as->next_voice = (n + 1) % voices;
+    return mixer_play_sample(as->mixer, BLIP_VOICE + n, &as->blip, (float)as->max_volume, pan);
+}
+
+/// Renders audio as fast as the mixer can go and writes it to a WAV
+/// file, reporting the throughput.  The tone plays throughout, with a
+/// blip every few buffers, so the same run always renders the same file.
+///
+/// @param as The audio state.
+/// @param file The WAV file to write.
+/// @param seconds The length of the audio to render.
+/// @return 0 on success, -1 on error.
+static int render_audio(struct audio_state *as, const char *file, double seconds)
+{
+    extern uint64_t perf_freq;
+    extern const size_t TONE_VOICE;
+    extern const uint64_t RENDER_BLIP_EVERY;
+
+    const size_t frames = (size_t)as->buffer_size;
+    float *buffer = ecalloc(frames * AUDIO_NUM_CHANNELS, sizeof(*buffer));
+    int ret = -1;
+    struct wav_writer writer;
+    if (wav_writer_open(&writer, file, as->sample_rate, AUDIO_NUM_CHANNELS) != 0) {
+        SDL_LogError(ERR, "%s: failed to create %s", __func__, file);
+        goto out_free_buffer;
+    }
+    (void)mixer_play_tone(as->mixer, TONE_VOICE, as->frequency, (float)as->max_volume, 0.0f);
+    const uint64_t buffers = (uint64_t)ceil((seconds * as->sample_rate) / (double)frames);
+    uint64_t busy = 0;
+    for (uint64_t i = 0; i < buffers; ++i) {
+        if (i % RENDER_BLIP_EVERY == 0) {
+            (void)play_blip(as);
+        }
+        // The mixing alone is timed, leaving out writing the file
+        const uint64_t begin = now();
+        mix_buffer(as, buffer);
+        busy += now() - begin;
+        if (wav_writer_write(&writer, buffer, frames) != 0) {
+            SDL_LogError(ERR, "%s: failed to write %s", __func__, file);
+            (void)wav_writer_close(&writer);
+            goto out_free_buffer;
+        }
+    }
+    if (wav_writer_close(&writer) != 0) {
+        SDL_LogError(ERR, "%s: failed to write %s", __func__, file);
+        goto out_free_buffer;
+    }
+    const double elapsed = (double)busy / (double)perf_freq;
+    const double rendered = (double)(buffers * frames) / as->sample_rate;
+    SDL_LogInfo(APP, "Rendered %.3f s of audio in %.3f s: %.0f samples/s, %.1fx real time",
+                rendered, elapsed, (double)(buffers * frames * AUDIO_NUM_CHANNELS) / elapsed, rendered / elapsed);
+    ret = 0;
+out_free_buffer:
+    free(buffer);
+    return ret;
+}
+
+/// Starts streaming the music file from the config, looping, once the
+/// stream has closed since the music last stopped.
+///
+/// @param st The state.
+/// @return 0 on success or while still waiting, -1 on error.
+static int play_music(struct state *st)
+{
+    extern struct config cfg;
+    extern const size_t MUSIC_VOICE;
+
+    if (!streamer_idle(st->audio.streamer, 0)) {
+        return 0;
+    }
+    st->music_stat = 0;
+    struct mixer_stream stream = {0};
+    if (streamer_open(st->audio.streamer, 0, cfg.music, 1, &stream) != 0) {
+        return -1;
+    }
+    st->music_stat = 1;
+    return mixer_play_stream(st->audio.mixer, MUSIC_VOICE, &stream, (float)st->audio.max_volume, 0.0f);
+}
+
+/// Starts or stops streaming the music file from the config, looping.
+///
+/// Starting only asks for the music, which play_music() starts once the
+/// stream has closed, as it may still be closing if the music was just
+/// stopped.
+///
+/// @param st The state.
+/// @return 0 on success, -1 on error.
+static int toggle_music(struct state *st)
+{
+    extern struct config cfg;
+    extern const size_t MUSIC_VOICE;
+
+    if (st->music_stat == 2) {
+        st->music_stat = 0;
+        return 0;
+    }
+    if (st->music_stat == 1) {
+        st->music_stat = 0;
+        // The voice fades out on what the ring already holds
+        const int rc = mixer_stop(st->audio.mixer, MUSIC_VOICE);
+        streamer_close(st->audio.streamer, 0);
+        return rc;
+    }
+    if (cfg.music == NULL) {
+        SDL_LogWarn(APP, "No music file in the config");
+        return -1;
+    }
+    st->music_stat = 2;
+    return play_music(st);
+}
+
+/// Logs the audio callback's use of its budget so far, or in push mode
+/// the latency of the device's queue.
+///
+/// @param as The audio state.
+static void log_audio_meter(struct audio_state *as)
+{
+    extern const double SECOND;
+    extern struct config cfg;
+
+    if (cfg.audio_push) {
+        SDL_LogInfo(APP, "Audio queue target %.1f ms over %" PRIu64 " buffers, %" PRIu64 " underruns",
+                    ((double)as->queue.target * SECOND) / as->sample_rate, as->elapsed, as->queue.underruns);
+        return;
+    }
+    struct audio_meter_stats stats;
+    audio_meter_read(&as->meter, &stats);
+    SDL_LogInfo(APP, "Audio callback used %.1f%% (p99 %.0f%%, max %.1f%%) of %.3f ms over %" PRIu64 " buffers, %" PRIu64 " over budget, %" PRIu64 " late, %" PRIu64 " missed",
+                100.0 * stats.mean, 100.0 * stats.p99, 100.0 * stats.max, stats.period, stats.callbacks, stats.over, stats.late, stats.missed);
+    char line[AUDIO_METER_BINS * 24] = {0};
+    size_t len = 0;
+    for (size_t i = 0; i < AUDIO_METER_BINS; ++i) {
+        if (stats.bins[i] == 0) {
+            continue;
+        }
+        const int n = (i < AUDIO_METER_BINS - 1)
+                          ? snprintf(&line[len], sizeof(line) - len, " <%zu%%:%" PRIu64, 5 * (i + 1), stats.bins[i])
+                          : snprintf(&line[len], sizeof(line) - len, " >100%%:%" PRIu64, stats.bins[i]);
+        if (n < 0 || (size_t)n >= sizeof(line) - len) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    SDL_LogInfo(APP, "Audio callback utilisation:%s", line);
+}
+
+/// Handles keydown events.
+///
+/// @param key The keydown event.
+/// @param st The state.
 static void handle_keydown(SDL_KeyboardEvent *key, struct state *st)
 {
+    extern const size_t TONE_VOICE;
+
+    int rc = 0;
+
     switch (key->keysym.sym) {
     case SDLK_ESCAPE:
         st->loop_stat = 0;
         break;
     case SDLK_F1:
         st->tone_stat = (st->tone_stat == 1) ? 0 : 1;
-        SDL_LockAudioDevice(st->audio_device);
-        st->audio.volume = st->tone_stat * st->audio.max_volume;
-        st->audio.elapsed = 0;
-        SDL_UnlockAudioDevice(st->audio_device);
+        rc = (st->tone_stat == 1)
+                 ? mixer_play_tone(st->audio.mixer, TONE_VOICE, st->audio.frequency, (float)st->audio.max_volume, 0.0f)
+                 : mixer_stop(st->audio.mixer, TONE_VOICE);
+        if (rc != 0) {
+            SDL_LogWarn(APP, "Audio command ring full");
+        }
+        break;
+    case SDLK_F2:
+        if (play_blip(&st->audio) != 0) {
+            SDL_LogWarn(APP, "Audio command ring full");
+        }
+        break;
+    case SDLK_F3:
+        // The profiler follows at the end of the frame
+        st->overlay_stat = (st->overlay_stat == 1) ? 0 : 1;
+        break;
+    case SDLK_F4:
+        if (toggle_music(st) != 0) {
+            SDL_LogWarn(APP, "Failed to toggle the music");
+        }
+        break;
+    case SDLK_F5:
+        log_audio_meter(&st->audio);
         break;
     }
 }
@@ -442,17 +1402,115 @@ static void handle_user(SDL_UserEvent *event, __attribute__((unused)) struct sta
     SDL_LogDebug(APP, "EVENT_0: %d", event->timestamp);
 }
 
+/// Handles window events.
+///
+/// @param event The window event.
+/// @param st The state.
+static void handle_window(SDL_WindowEvent *event, struct state *st)
+{
+    extern struct scene scene;
+
+    switch (event->event) {
+    case SDL_WINDOWEVENT_EXPOSED:
+        damage_add_all(&scene.damage);
+        break;
+    case SDL_WINDOWEVENT_SIZE_CHANGED:
+        st->resize_stat = 1;
+        break;
+    case SDL_WINDOWEVENT_MOVED:
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    case SDL_WINDOWEVENT_DISPLAY_CHANGED:
+#endif
+        st->display_stat = 1;
+        break;
+    }
+}
+
+/// Takes a lock, unless there is none.
+///
+/// @param lock The lock, or NULL
+static void lock_mutex(SDL_mutex *lock)
+{
+    if (lock != NULL && SDL_LockMutex(lock) != 0) {
+        log_sdl_error("SDL_LockMutex failed");
+    }
+}
+
+/// Releases a lock, unless there is none.
+///
+/// @param lock The lock, or NULL
+static void unlock_mutex(SDL_mutex *lock)
+{
+    if (lock != NULL && SDL_UnlockMutex(lock) != 0) {
+        log_sdl_error("SDL_UnlockMutex failed");
+    }
+}
+
+/// Re-queries the refresh rate after the window may have moved to another
+/// display, and restarts pacing if it changed.
+///
+/// @param win The window
+/// @param refresh_rate The current refresh rate, updated in place
+/// @param governing Whether the governor picks the frame rate
+static void requery_refresh_rate(struct window *win, int *refresh_rate, int governing)
+{
+    extern struct config cfg;
+    extern struct pacer pacer;
+    extern struct governor gov;
+    extern struct presenter presenter;
+
+    const int rate = get_refresh_rate(win, *refresh_rate);
+    if (rate == *refresh_rate) {
+        return;
+    }
+    SDL_LogInfo(APP, "Display refresh rate changed from %d Hz to %d Hz", *refresh_rate, rate);
+    *refresh_rate = rate;
+    pacer_set_refresh(&pacer, rate);
+    atomic_store(&presenter.refresh_rate, rate);
+    if (governing) {
+        governor_init(&gov, rate, cfg.frame_rate, cfg.idle_rate, (double)cfg.idle_timeout);
+    }
+}
+
+/// Returns whether an event comes from the user.
+///
+/// @param type The event type
+/// @return 1 if the event is input, 0 otherwise.
+static int is_input(uint32_t type)
+{
+    return type == SDL_WINDOWEVENT
+        || (type >= SDL_KEYDOWN && type <= SDL_MOUSEWHEEL)
+        || (type >= SDL_JOYAXISMOTION && type <= SDL_CONTROLLERDEVICEREMAPPED)
+        || (type >= SDL_FINGERDOWN && type <= SDL_FINGERMOTION);
+}
+
 /// Handles SDL events.
 ///
 /// @param st The state.
 static void handle_events(struct state *st)
 {
+    extern struct scene scene;
+    extern struct governor gov;
+
     SDL_Event event = {0};
     while (SDL_PollEvent(&event) != 0) {
+        if (is_input(event.type)) {
+            governor_input(&gov);
+        }
         switch (event.type) {
         case SDL_QUIT:
             st->loop_stat = 0;
             break;
+        case SDL_WINDOWEVENT:
+            handle_window(&event.window, st);
+            break;
+        case SDL_DISPLAYEVENT:
+            st->display_stat = 1;
+            break;
+        case SDL_RENDER_TARGETS_RESET:
+            // The backbuffer's contents are lost
+            damage_add_all(&scene.damage);
+            break;
         case SDL_KEYDOWN:
             handle_keydown(&event.key, st);
             break;
@@ -463,27 +1521,487 @@ static void handle_events(struct state *st)
     }
 }
 
-static void update(__attribute__((unused)) double delta) {}
+/// Advances the simulation by one tick.
+///
+/// @param delta The fixed tick time in milliseconds
+static void update(double delta)
+{
+    extern struct world world;
+    extern const double SECOND;
+
+    if (world.entities.count > 0) {
+        entities_update(&world.entities, (float)(delta / SECOND), world.width, world.height, world.pool);
+    }
+}
+
+/// Formats the profiler statistics for the overlay.
+///
+/// @param prof The profiler
+/// @param render_prof The render thread's profiler, which the render phases are taken from, or NULL
+/// @param pacer The pacer
+/// @param redrawn The number of pixels redrawn by the last frame
+/// @param buf The buffer to write to
+/// @param len The length of the buffer
+static void format_overlay(const struct profiler *prof, const struct profiler *render_prof, const struct pacer *pacer,
+                           uint64_t redrawn, char *buf, size_t len)
+{
+    struct profiler_stats stats = {0};
+    size_t off = (size_t)snprintf(buf, len, "%-8s %7s %7s %7s %7s\n", "ms", "p50", "p95", "p99", "max");
+    for (int phase = 0; phase <= PHASE_FRAME && off < len; ++phase) {
+        const int rendering = phase >= PHASE_RENDER_CLEAR && phase <= PHASE_RENDER_PRESENT;
+        const struct profiler *from = (render_prof != NULL && rendering) ? render_prof : prof;
+        if (profiler_stats(from, phase, &stats) != 0) {
+            continue;
+        }
+        off += (size_t)snprintf(buf + off, len - off, "%-8s %7.3f %7.3f %7.3f %7.3f\n",
+                                profiler_phase_str(phase), stats.p50, stats.p95, stats.p99, stats.max);
+    }
+    struct pacer_stats present = {0};
+    if (off < len && pacer_stats(pacer, &present) == 0) {
+        off += (size_t)snprintf(buf + off, len - off, "%-8s %7.3f +/- %.3f ms\n", "present", present.mean, present.stddev);
+    }
+    if (off < len) {
+        (void)snprintf(buf + off, len - off, "%-8s %" PRIu64 " px\n", "redrawn", redrawn);
+    }
+}
+
+/// Calculates the extent of the overlay.
+///
+/// @param text The text object
+/// @param str The overlay text
+/// @param rect The rectangle to fill
+static void overlay_rect(const struct text *text, const char *str, SDL_Rect *rect)
+{
+    extern const int OVERLAY_MARGIN;
+
+    rect->x = 0;
+    rect->y = 0;
+    text_measure(text, str, rect);
+    rect->w += 2 * OVERLAY_MARGIN;
+    rect->h += 2 * OVERLAY_MARGIN;
+}
+
+/// Shows, changes or hides the overlay, marking the affected regions dirty.
+///
+/// @param scene The scene
+/// @param overlay The overlay text, or NULL to hide the overlay
+static void set_overlay(struct scene *scene, const char *overlay)
+{
+    damage_add(&scene->damage, &scene->overlay_rect);
+    scene->overlay = overlay;
+    scene->overlay_rect = (SDL_Rect){0};
+    if (overlay != NULL && scene->text != NULL) {
+        overlay_rect(scene->text, overlay, &scene->overlay_rect);
+        damage_add(&scene->damage, &scene->overlay_rect);
+    }
+}
+
+/// Draws the overlay text on a translucent background.
+///
+/// @param renderer The renderer
+/// @param batch The batch to add the glyphs to
+/// @param text The text object
+/// @param str The overlay text
+/// @param rect The extent of the overlay
+/// @return 0 on success, -1 on failure.
+static int draw_overlay(SDL_Renderer *renderer, struct sprite_batch *batch,
+                        struct text *text, const char *str, const SDL_Rect *rect)
+{
+    extern const SDL_Color OVERLAY_FG;
+    extern const SDL_Color OVERLAY_BG;
+    extern const int OVERLAY_MARGIN;
+
+    int rc = SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    if (rc != 0) {
+        log_sdl_error("SDL_SetRenderDrawBlendMode failed");
+        return -1;
+    }
+    rc = SDL_SetRenderDrawColor(renderer, OVERLAY_BG.r, OVERLAY_BG.g, OVERLAY_BG.b, OVERLAY_BG.a);
+    if (rc != 0) {
+        log_sdl_error("SDL_SetRenderDrawColor failed");
+        return -1;
+    }
+    rc = SDL_RenderFillRect(renderer, rect);
+    if (rc != 0) {
+        log_sdl_error("SDL_RenderFillRect failed");
+        return -1;
+    }
+    rc = SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xFF);
+    if (rc != 0) {
+        log_sdl_error("SDL_SetRenderDrawColor failed");
+        return -1;
+    }
+    text_set_color(text, OVERLAY_FG);
+    return text_draw(text, batch, rect->x + OVERLAY_MARGIN, rect->y + OVERLAY_MARGIN, str);
+}
+
+/// Creates a render target texture to hold the last rendered frame.
+///
+/// @param renderer The renderer
+/// @param rect The window rectangle
+/// @return The texture on success, NULL on failure.
+static SDL_Texture *create_backbuffer(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_TARGET, rect->w, rect->h);
+    if (texture == NULL) {
+        log_sdl_error("SDL_CreateTexture failed");
+    }
+    return texture;
+}
+
+/// Resizes the scene to the window after its size changed.  The damage is
+/// clipped to the new size, all of it dirty, and the backbuffer, if any,
+/// is recreated at that size.
+///
+/// @param win The window
+/// @param scene The scene
+/// @return 0 on success, -1 on failure.
+static int resize_scene(struct window *win, struct scene *scene)
+{
+    SDL_Rect rect = {0};
+    if (get_rect(win, &rect) != 0) {
+        return -1;
+    }
+    SDL_LogDebug(APP, "Window resized from %dx%d to %dx%d", scene->win_rect.w, scene->win_rect.h, rect.w, rect.h);
+    scene->win_rect = rect;
+    damage_init(&scene->damage, rect.w, rect.h);
+    if (scene->backbuffer != NULL) {
+        SDL_DestroyTexture(scene->backbuffer);
+        scene->backbuffer = create_backbuffer(win->renderer, &rect);
+        if (scene->backbuffer == NULL) {
+            SDL_LogWarn(APP, "Damage tracking disabled");
+        }
+    }
+    return 0;
+}
 
-/// Renders the texture to the window.
+/// Clears the current render target.
 ///
 /// @param renderer The renderer
-/// @param texture The texture
-/// @param win_rect The window rectangle
 /// @return 0 on success, -1 on failure.
-static int render(SDL_Renderer *renderer, SDL_Texture *texture, SDL_Rect *win_rect)
+static int clear(SDL_Renderer *renderer)
 {
-    int rc = SDL_RenderClear(renderer);
+    extern struct profiler prof;
+
+    profiler_begin(&prof, PHASE_RENDER_CLEAR);
+    const int rc = SDL_RenderClear(renderer);
     if (rc != 0) {
         log_sdl_error("SDL_RenderClear failed");
         return -1;
     }
-    rc = SDL_RenderCopy(renderer, texture, NULL, win_rect);
+    profiler_end(&prof, PHASE_RENDER_CLEAR);
+    return 0;
+}
+
+/// Rasterizes the background into the scene's texture.
+///
+/// @param scene The scene
+/// @return 0 on success, -1 on failure.
+static int draw_raster(struct scene *scene)
+{
+    const bmp_pixel32 black = {.b = 0, .g = 0, .r = 0, .a = 0xFF};
+    const struct raster_image background = {
+        .pixels = scene->background->pixels,
+        .width = scene->background->w,
+        .height = scene->background->h,
+        .pitch = scene->background->pitch / (int)sizeof(bmp_pixel32),
+    };
+    if (raster_fill(scene->raster, NULL, black) != 0
+        || raster_blit(scene->raster, &background, NULL, 0, 0) != 0) {
+        return -1;
+    }
+    return raster_draw(scene->raster, scene->texture);
+}
+
+/// Draws the entities in view.
+///
+/// @param batch The batch to add the entities to
+/// @param world The world
+/// @param alpha The interpolation factor between the last two simulation ticks
+/// @return 0 on success, -1 on failure.
+static int draw_world(struct sprite_batch *batch, const struct world *world, double alpha)
+{
+    extern const SDL_Color DOT_COLOR;
+
+    const SDL_Rect src = {0, 0, 1, 1};
+    for (size_t i = 0; i < world->visible_count; ++i) {
+        SDL_FRect dst = {0};
+        world_dot(world, i, alpha, &dst);
+        if (sprite_batch_draw(batch, world->dot, &src, &dst, DOT_COLOR) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/// Draws the scene to the current render target.
+///
+/// Everything queued in the scene's batch is submitted at the end.
+///
+/// @param renderer The renderer
+/// @param scene The scene
+/// @param alpha The interpolation factor between the last two simulation ticks
+/// @return 0 on success, -1 on failure.
+static int draw_scene(SDL_Renderer *renderer, struct scene *scene, double alpha)
+{
+    extern struct profiler prof;
+
+    profiler_begin(&prof, PHASE_RENDER_COPY);
+    int rc = SDL_RenderCopy(renderer, scene->texture, NULL, &scene->win_rect);
     if (rc != 0) {
         log_sdl_error("SDL_RenderCopy failed");
         return -1;
     }
-    SDL_RenderPresent(renderer);
+    if (scene->world != NULL) {
+        // The overlay's background is filled right away, so the entities
+        // must be submitted before it
+        rc = draw_world(scene->batch, scene->world, alpha);
+        if (rc == 0) {
+            rc = sprite_batch_flush(scene->batch);
+        }
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    if (scene->text != NULL && scene->overlay != NULL) {
+        rc = draw_overlay(renderer, scene->batch, scene->text, scene->overlay, &scene->overlay_rect);
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    rc = sprite_batch_flush(scene->batch);
+    if (rc != 0) {
+        return -1;
+    }
+    profiler_end(&prof, PHASE_RENDER_COPY);
+    return 0;
+}
+
+/// Redraws the dirty regions of the scene into the backbuffer.
+///
+/// @param renderer The renderer
+/// @param scene The scene
+/// @param alpha The interpolation factor between the last two simulation ticks
+/// @return 0 on success, -1 on failure.
+static int draw_damage(SDL_Renderer *renderer, struct scene *scene, double alpha)
+{
+    int rc = SDL_SetRenderTarget(renderer, scene->backbuffer);
+    if (rc != 0) {
+        log_sdl_error("SDL_SetRenderTarget failed");
+        return -1;
+    }
+    for (int i = 0; i < scene->damage.count && rc == 0; ++i) {
+        rc = SDL_RenderSetClipRect(renderer, &scene->damage.rects[i]);
+        if (rc != 0) {
+            log_sdl_error("SDL_RenderSetClipRect failed");
+            break;
+        }
+        rc = clear(renderer);
+        if (rc == 0) {
+            rc = draw_scene(renderer, scene, alpha);
+        }
+    }
+    if (SDL_RenderSetClipRect(renderer, NULL) != 0 || SDL_SetRenderTarget(renderer, NULL) != 0) {
+        log_sdl_error("Failed to restore render target");
+        return -1;
+    }
+    return rc;
+}
+
+/// Renders the scene to the window.
+///
+/// With a backbuffer, only the dirty regions are redrawn, and nothing is
+/// presented when nothing is dirty.  The backbuffer is copied whole, as the
+/// contents of the window are undefined after presenting.
+///
+/// @param renderer The renderer
+/// @param scene The scene
+/// @param alpha The interpolation factor between the last two simulation ticks
+/// @return 0 on success, -1 on failure.
+static int render(SDL_Renderer *renderer, struct scene *scene, double alpha)
+{
+    extern struct profiler prof;
+
+    if (scene->backbuffer == NULL) {
+        damage_add_all(&scene->damage);
+    }
+    scene->redrawn = damage_area(&scene->damage);
+    if (scene->redrawn == 0) {
+        return 0;
+    }
+    int rc = 0;
+    if (scene->raster != NULL) {
+        PROFILE_SCOPE(&prof, PHASE_RENDER_RASTER)
+        {
+            rc = draw_raster(scene);
+        }
+        if (rc != 0) {
+            damage_clear(&scene->damage);
+            return -1;
+        }
+    }
+    if (scene->backbuffer == NULL) {
+        rc = clear(renderer);
+        if (rc == 0) {
+            rc = draw_scene(renderer, scene, alpha);
+        }
+    } else {
+        rc = draw_damage(renderer, scene, alpha);
+        if (rc == 0) {
+            PROFILE_SCOPE(&prof, PHASE_RENDER_COPY)
+            {
+                rc = SDL_RenderCopy(renderer, scene->backbuffer, NULL, NULL);
+            }
+            if (rc != 0) {
+                log_sdl_error("SDL_RenderCopy failed");
+            }
+        }
+    }
+    damage_clear(&scene->damage);
+    if (rc != 0) {
+        return -1;
+    }
+    PROFILE_SCOPE(&prof, PHASE_RENDER_PRESENT)
+    {
+        SDL_RenderPresent(renderer);
+    }
+    return 0;
+}
+
+/// Rasterizes the background on the render thread.
+///
+/// @param renderer The renderer
+/// @param data The scene
+/// @return 0 on success, -1 on failure.
+static int replay_raster(__attribute__((unused)) SDL_Renderer *renderer, void *data)
+{
+    return draw_raster(data);
+}
+
+/// Records the scene for the render thread and hands it over.
+///
+/// The whole window is redrawn every frame.  Only the text object's metrics
+/// are used here, as it is drawn with on the render thread.
+///
+/// @param queue The queue to the render thread
+/// @param scene The scene
+/// @param alpha The interpolation factor between the last two simulation ticks
+/// @return 0 on success, -1 on failure.
+static int publish_scene(struct render_queue *queue, struct scene *scene, double alpha)
+{
+    extern const SDL_Color OVERLAY_FG;
+    extern const SDL_Color OVERLAY_BG;
+    extern const int OVERLAY_MARGIN;
+    extern const SDL_Color DOT_COLOR;
+
+    const SDL_Color black = {0x00, 0x00, 0x00, 0xFF};
+    struct render_list *list = render_queue_begin(queue);
+    if (render_list_clear(list, black) != 0) {
+        return -1;
+    }
+    if (scene->raster != NULL && render_list_call(list, replay_raster, scene) != 0) {
+        return -1;
+    }
+    if (render_list_copy(list, scene->texture, NULL, &scene->win_rect) != 0) {
+        return -1;
+    }
+    if (scene->world != NULL) {
+        const SDL_Rect src = {0, 0, 1, 1};
+        for (size_t i = 0; i < scene->world->visible_count; ++i) {
+            SDL_FRect dst = {0};
+            world_dot(scene->world, i, alpha, &dst);
+            if (render_list_sprite(list, scene->world->dot, &src, &dst, DOT_COLOR) != 0) {
+                return -1;
+            }
+        }
+    }
+    if (scene->text != NULL && scene->overlay != NULL) {
+        const SDL_Rect *rect = &scene->overlay_rect;
+        if (render_list_fill(list, rect, OVERLAY_BG) != 0
+            || render_list_text(list, scene->text, rect->x + OVERLAY_MARGIN, rect->y + OVERLAY_MARGIN,
+                                OVERLAY_FG, scene->overlay) != 0) {
+            return -1;
+        }
+    }
+    render_queue_publish(queue);
+    damage_clear(&scene->damage);
+    scene->redrawn = (uint64_t)scene->win_rect.w * (uint64_t)scene->win_rect.h;
+    return 0;
+}
+
+/// Copies what the render thread measures for the main thread to read.
+///
+/// @param presenter The presenter
+static void take_snapshot(struct presenter *presenter)
+{
+    lock_mutex(presenter->snapshot_lock);
+    presenter->pacer_snapshot = presenter->pacer;
+    if (presenter->prof.enabled) {
+        presenter->prof_snapshot = presenter->prof;
+    }
+    unlock_mutex(presenter->snapshot_lock);
+}
+
+/// Reads the last snapshot of what the render thread measures.
+///
+/// @param presenter The presenter
+/// @param prof The profiler to copy the render phases into
+/// @param pacer The pacer to copy the present intervals into
+static void read_snapshot(struct presenter *presenter, struct profiler *prof, struct pacer *pacer)
+{
+    lock_mutex(presenter->snapshot_lock);
+    *prof = presenter->prof_snapshot;
+    *pacer = presenter->pacer_snapshot;
+    unlock_mutex(presenter->snapshot_lock);
+}
+
+/// Replays and presents the frames recorded by the main thread, until the
+/// queue is closed.  The replay is timed as the copy phase.
+///
+/// @param data The presenter
+/// @return 0 on success, -1 on failure.
+static int present_frames(void *data)
+{
+    struct presenter *presenter = data;
+
+    trace_thread_name("render");
+
+    int refresh_rate = atomic_load(&presenter->refresh_rate);
+    const struct render_list *list = NULL;
+    while ((list = render_queue_wait(&presenter->queue)) != NULL) {
+        // Between frames, no phase is open
+        const int rate = atomic_load(&presenter->refresh_rate);
+        if (rate != refresh_rate) {
+            refresh_rate = rate;
+            pacer_set_refresh(&presenter->pacer, rate);
+        }
+        const int profiling = atomic_load(&presenter->profiling);
+        if (presenter->prof.enabled != profiling) {
+            profiler_enable(&presenter->prof, profiling);
+        }
+
+        int rc = 0;
+        PROFILE_SCOPE(&presenter->prof, PHASE_RENDER_COPY)
+        TRACE_SCOPE("replay")
+        {
+            lock_mutex(presenter->lock);
+            rc = render_list_replay(list, presenter->renderer, presenter->batch);
+            unlock_mutex(presenter->lock);
+        }
+        if (rc != 0) {
+            atomic_store(&presenter->failed, 1);
+            return -1;
+        }
+        PROFILE_SCOPE(&presenter->prof, PHASE_RENDER_PRESENT)
+        TRACE_SCOPE("present")
+        {
+            SDL_RenderPresent(presenter->renderer);
+        }
+        pacer_present(&presenter->pacer, calc_delta(presenter->epoch, now()));
+        profiler_frame(&presenter->prof);
+        take_snapshot(presenter);
+    }
     return 0;
 }
 
@@ -493,7 +2011,23 @@ int main(int argc, char *argv[])
     extern struct args as;
     extern struct config cfg;
     extern struct state st;
+    extern struct profiler prof;
+    extern struct profiler snapshot_prof;
+    extern struct governor gov;
+    extern struct pacer pacer;
+    extern struct scene scene;
+    extern struct presenter presenter;
+    extern struct world world;
+    extern const double SECOND;
     extern const uint32_t QUEUE_CAP;
+    extern const uint64_t OVERLAY_REFRESH;
+    extern const int BATCH_CAP;
+    extern const size_t AUDIO_VOICES;
+    extern const size_t MUSIC_FRAMES;
+    extern const double AUDIO_RAMP;
+    extern const int AUDIO_PUSH_GRANULES;
+    extern const size_t AUDIO_PUSH_HEADROOM;
+    extern const size_t RENDER_LIST_CAP;
 
     int ret = EXIT_FAILURE;
 
@@ -501,6 +2035,12 @@ int main(int argc, char *argv[])
     (void)parse_args(argc, argv, &as);
     (void)load_config(as.config_file, &cfg);
 
+    if (as.headless_frames > 0 || as.render_file != NULL) {
+        // Nothing is displayed or played, so no display or sound hardware is needed
+        (void)SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        (void)SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+    }
+
     int rc = SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
     if (rc != 0) {
         log_sdl_error("init failed");
@@ -518,25 +2058,79 @@ int main(int argc, char *argv[])
     }
     assert(event_start == EVENT_0);
 
+    if (as.trace_file != NULL) {
+        rc = trace_start(as.trace_file);
+        if (rc != 0) {
+            return EXIT_FAILURE;
+        }
+        trace_thread_name("main");
+        // The callback must not allocate, so its buffer is allocated here
+        st.audio.trace = trace_buffer_create("audio");
+    }
+
+    // Push mode renders smaller buffers, several of which make up the latency
+    const double buffer_latency = (cfg.audio_push) ? (double)cfg.audio_latency / AUDIO_PUSH_GRANULES : (double)cfg.audio_latency;
     SDL_AudioSpec want = {
-        .freq = st.audio.sample_rate,
+        .freq = cfg.sample_rate,
         .format = AUDIO_F32,
-        .channels = 2,
-        .samples = st.audio.buffer_size,
-        .callback = calc_sine,
+        .channels = AUDIO_NUM_CHANNELS,
+        .samples = calc_audio_buffer(cfg.sample_rate, buffer_latency),
+        .callback = (cfg.audio_push) ? NULL : mix_audio,
         .userdata = (void *)&st.audio,
     };
-    SDL_AudioSpec have = {0};
-    st.audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
-    if (st.audio_device < 2) {
-        log_sdl_error("SDL_OpenAudio failed");
-        return EXIT_FAILURE;
+    SDL_AudioSpec have = want;
+    if (as.render_file == NULL) {
+        // SDL converts formats and channels cheaply, but the rate and buffer size are the device's to pick
+        st.audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+        if (st.audio_device < 2) {
+            log_sdl_error("SDL_OpenAudio failed");
+            goto out_stop_trace;
+        }
+    }
+    st.audio.sample_rate = have.freq;
+    st.audio.buffer_size = have.samples;
+    SDL_LogInfo(APP, "Audio at %d Hz (asked for %d) in buffers of %u samples (asked for %u), %.1f ms each%s",
+                have.freq, want.freq, have.samples, want.samples, ((double)have.samples * SECOND) / have.freq,
+                (cfg.audio_push) ? ", pushed" : "");
+    if (cfg.audio_push) {
+        // The queue is topped up once a frame, so it must be able to outlast
+        // the longest frame, which the governor stretches when idle
+        const int slowest = (cfg.governor && cfg.idle_rate < cfg.frame_rate) ? cfg.idle_rate : cfg.frame_rate;
+        const double longest = fmax((double)cfg.audio_latency, calc_frame_time(slowest));
+        const size_t target = (size_t)(((double)cfg.audio_latency * have.freq) / SECOND);
+        const size_t max_target = (size_t)((longest * have.freq) / SECOND);
+        audio_queue_init(&st.audio.queue, have.samples, target, AUDIO_PUSH_HEADROOM * max_target);
+        st.audio.chunk = ecalloc((size_t)have.samples * AUDIO_NUM_CHANNELS, sizeof(*st.audio.chunk));
+    }
+
+    const uint32_t ramp = (uint32_t)((AUDIO_RAMP * st.audio.sample_rate) / SECOND);
+    st.audio.mixer = mixer_create(st.audio.sample_rate, AUDIO_VOICES, ramp);
+    if (st.audio.mixer == NULL) {
+        SDL_LogError(ERR, "Failed to create the mixer");
+        goto out_close_audio_device;
+    }
+    float *blip = create_blip(st.audio.sample_rate, &st.audio.blip);
+    if (blip == NULL) {
+        goto out_destroy_mixer;
+    }
+    st.audio.streamer = streamer_create(st.audio.sample_rate, 1, MUSIC_FRAMES);
+    if (st.audio.streamer == NULL) {
+        SDL_LogError(ERR, "Failed to create the streamer");
+        goto out_free_blip;
+    }
+
+    audio_meter_init(&st.audio.meter, st.audio.sample_rate, st.audio.buffer_size, perf_freq);
+    if (as.render_file != NULL) {
+        ret = (render_audio(&st.audio, as.render_file, as.render_seconds) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+        goto out_destroy_streamer;
     }
 
     const char *const win_title = "Hello, world!";
-    struct window *win = window_create(&cfg, win_title);
+    struct window *win = (as.headless_frames > 0)
+                             ? offscreen_create(&cfg)
+                             : window_create(&cfg, win_title);
     if (win == NULL) {
-        goto out_close_audio_device;
+        goto out_destroy_streamer;
     }
 
     SDL_Rect win_rect = {0};
@@ -551,15 +2145,54 @@ int main(int argc, char *argv[])
         goto out_destroy_window;
     }
 
-    SDL_Texture *texture = create_texture(win, bmp_file);
+    SDL_Texture *texture = (cfg.software_raster)
+                               ? scene_raster_init(&scene, win->renderer, &win_rect, bmp_file)
+                               : create_texture(win, bmp_file);
     free(bmp_file);
     if (texture == NULL) {
         goto out_destroy_window;
     }
 
+    const char *const atlas_bmp = "10x20.bmp";
+    char *atlas_file = joinpath2(cfg.asset_dir, atlas_bmp);
+    struct text *text = text_create(win->renderer, atlas_file);
+    if (text == NULL) {
+        SDL_LogWarn(APP, "Failed to load %s, overlay disabled", atlas_file);
+    }
+    free(atlas_file);
+
+    struct sprite_batch *batch = sprite_batch_create(win->renderer, BATCH_CAP);
+    if (batch == NULL) {
+        goto out_destroy_text;
+    }
+
+    scene.texture = texture;
+    scene.batch = batch;
+    scene.win_rect = win_rect;
+    scene.text = text;
+    damage_init(&scene.damage, win_rect.w, win_rect.h);
+    // Headless frames are dumped right after rendering, so they are drawn in place
+    const int threaded = cfg.render_thread && as.headless_frames == 0;
+    if (cfg.damage_tracking && threaded) {
+        SDL_LogWarn(APP, "Damage tracking disabled, the render thread redraws every frame");
+    } else if (cfg.damage_tracking) {
+        scene.backbuffer = create_backbuffer(win->renderer, &win_rect);
+        if (scene.backbuffer == NULL) {
+            SDL_LogWarn(APP, "Damage tracking disabled");
+        }
+    }
+
+    rc = world_init(&world, cfg.entities, &win_rect, win->renderer);
+    if (rc != 0) {
+        goto out_destroy_text;
+    }
+    if (world.entities.count > 0) {
+        scene.world = &world;
+    }
+
     struct message_queue *queue = message_queue_create(QUEUE_CAP);
     if (queue == NULL) {
-        goto out_destroy_texture;
+        goto out_destroy_text;
     }
 
     SDL_Thread *handler = SDL_CreateThread(handle, "handler", queue);
@@ -567,42 +2200,270 @@ int main(int argc, char *argv[])
         goto out_message_queue_destroy;
     }
 
-    const double frame_time = calc_frame_time(cfg.frame_rate);
+    double frame_time = calc_frame_time(cfg.frame_rate);
+    int refresh_rate = get_refresh_rate(win, cfg.frame_rate);
+    pacer_init(&pacer, refresh_rate);
+    // Headless frames are not paced, so there is nothing to govern
+    const int governing = cfg.governor && as.headless_frames == 0;
+    if (governing) {
+        governor_init(&gov, refresh_rate, cfg.frame_rate, cfg.idle_rate, (double)cfg.idle_timeout);
+        frame_time = SECOND / governor_rate(&gov);
+        SDL_LogInfo(APP, "Governing frame rate at up to %.1f Hz on a %d Hz display",
+                    governor_rate(&gov), refresh_rate);
+    }
+
+    struct sim_clock clock = {
+        .tick_time = calc_frame_time(cfg.tick_rate),
+        .accumulator = 0.0,
+        .max_ticks = cfg.max_ticks,
+    };
+    world.tick = (float)(clock.tick_time / SECOND);
 
+    // Push mode starts with the queue primed
+    if (cfg.audio_push && push_audio(&st.audio, st.audio_device) != 0) {
+        goto out_wait_thread;
+    }
     SDL_PauseAudioDevice(st.audio_device, 0);
 
+    if (as.profile_file != NULL) {
+        profiler_enable(&prof, 1);
+    }
+
+    char overlay_buf[1024] = {0};
+    struct pacer snapshot_pacer = {0};
+    uint64_t frame_count = 0;
+
     double delta = frame_time;
     uint64_t begin = now();
     uint64_t end = 0;
+    const uint64_t loop_begin = begin;
+
+    SDL_Thread *render_thread = NULL;
+    if (threaded) {
+        presenter.renderer = win->renderer;
+        presenter.batch = batch;
+        presenter.epoch = loop_begin;
+        pacer_init(&presenter.pacer, refresh_rate);
+        profiler_enable(&presenter.prof, prof.enabled);
+        atomic_store(&presenter.refresh_rate, refresh_rate);
+        atomic_store(&presenter.profiling, prof.enabled);
+        rc = render_queue_init(&presenter.queue, RENDER_LIST_CAP, sizeof(overlay_buf));
+        if (rc != 0) {
+            goto out_wait_thread;
+        }
+        presenter.lock = SDL_CreateMutex();
+        if (presenter.lock == NULL) {
+            log_sdl_error("SDL_CreateMutex failed");
+            goto out_stop_render_thread;
+        }
+        presenter.snapshot_lock = SDL_CreateMutex();
+        if (presenter.snapshot_lock == NULL) {
+            log_sdl_error("SDL_CreateMutex failed");
+            goto out_stop_render_thread;
+        }
+        render_thread = SDL_CreateThread(present_frames, "render", &presenter);
+        if (render_thread == NULL) {
+            log_sdl_error("SDL_CreateThread failed");
+            goto out_stop_render_thread;
+        }
+    }
 
     while (st.loop_stat == 1) {
-        handle_events(&st);
+        trace_begin("frame");
+        trace_counter("delta", delta);
+
+        PROFILE_SCOPE(&prof, PHASE_EVENTS)
+        TRACE_SCOPE("handle_events")
+        {
+            lock_mutex(presenter.lock);
+            handle_events(&st);
+            unlock_mutex(presenter.lock);
+        }
 
-        update(delta);
+        if (cfg.audio_push && push_audio(&st.audio, st.audio_device) != 0) {
+            goto out_stop_render_thread;
+        }
 
-        rc = render(win->renderer, texture, &win_rect);
-        if (rc != 0) {
-            goto out_wait_thread;
+        if (st.music_stat == 2 && play_music(&st) != 0) {
+            SDL_LogWarn(APP, "Failed to play the music");
+        }
+
+        if (st.display_stat == 1) {
+            st.display_stat = 0;
+            requery_refresh_rate(win, &refresh_rate, governing);
+        }
+
+        if (st.resize_stat == 1) {
+            st.resize_stat = 0;
+            lock_mutex(presenter.lock);
+            rc = resize_scene(win, &scene);
+            unlock_mutex(presenter.lock);
+            if (rc != 0) {
+                goto out_stop_render_thread;
+            }
+        }
+
+        double alpha = 0.0;
+        PROFILE_SCOPE(&prof, PHASE_UPDATE)
+        TRACE_SCOPE("update")
+        {
+            alpha = step_simulation(&clock, delta, update);
         }
 
-        delay_frame(frame_time, begin);
+        if (scene.world != NULL) {
+            TRACE_SCOPE("cull")
+            {
+                rc = world_cull(&world);
+            }
+            if (rc != 0) {
+                goto out_stop_render_thread;
+            }
+            // Entities move every tick, so the whole window changes
+            damage_add_all(&scene.damage);
+        }
+
+        if (st.overlay_stat == 1 && (frame_count % OVERLAY_REFRESH) == 0) {
+            if (threaded) {
+                read_snapshot(&presenter, &snapshot_prof, &snapshot_pacer);
+            }
+            format_overlay(&prof, (threaded) ? &snapshot_prof : NULL, (threaded) ? &snapshot_pacer : &pacer,
+                           scene.redrawn, overlay_buf, sizeof(overlay_buf));
+            set_overlay(&scene, overlay_buf);
+        } else if (st.overlay_stat == 0 && scene.overlay != NULL) {
+            set_overlay(&scene, NULL);
+        }
+
+        trace_begin("render");
+        rc = (threaded)
+                 ? publish_scene(&presenter.queue, &scene, alpha)
+                 : render(win->renderer, &scene, alpha);
+        trace_end("render");
+        trace_counter("redrawn_px", (double)scene.redrawn);
+        if (rc != 0 || atomic_load(&presenter.failed) != 0) {
+            goto out_stop_render_thread;
+        }
+        if (!threaded) {
+            if (scene.redrawn > 0) {
+                pacer_present(&pacer, calc_delta(loop_begin, now()));
+            } else {
+                pacer_skip(&pacer);
+            }
+        }
+
+        if (as.headless_frames > 0) {
+            if (as.dump_dir != NULL) {
+                rc = dump_frame(win->surface, as.dump_dir, frame_count);
+                if (rc != 0) {
+                    goto out_stop_render_thread;
+                }
+            }
+            if (frame_count + 1 >= as.headless_frames) {
+                st.loop_stat = 0;
+            }
+        } else {
+            if (governing) {
+                frame_time = governor_frame(&gov, calc_delta(begin, now()), delta);
+                trace_counter("frame_rate", governor_rate(&gov));
+            }
+            const double deadline = pacer_next(&pacer, calc_delta(loop_begin, now()), frame_time);
+            PROFILE_SCOPE(&prof, PHASE_DELAY)
+            TRACE_SCOPE("delay_until")
+            {
+                delay_until(deadline, loop_begin);
+            }
+        }
+        profiler_frame(&prof);
+        if (as.profile_file == NULL && prof.enabled != st.overlay_stat) {
+            profiler_enable(&prof, st.overlay_stat);
+            atomic_store(&presenter.profiling, st.overlay_stat);
+        }
+        trace_end("frame");
+        frame_count += 1;
         end = now();
-        delta = calc_delta(begin, end);
+        // Headless frames run uncapped but simulate as if paced, to stay reproducible
+        delta = (as.headless_frames > 0) ? frame_time : calc_delta(begin, end);
         begin = end;
     }
 
+    if (as.headless_frames > 0) {
+        const double elapsed = calc_delta(loop_begin, end);
+        SDL_LogInfo(APP, "Rendered %" PRIu64 " frames in %.3f ms (%.1f frames/s)",
+                    frame_count, elapsed, ((double)frame_count * SECOND) / elapsed);
+    }
+
+    if (render_thread != NULL) {
+        render_queue_close(&presenter.queue);
+        SDL_WaitThread(render_thread, NULL);
+        render_thread = NULL;
+    }
+
+    struct pacer_stats present = {0};
+    if (as.headless_frames == 0 && pacer_stats((threaded) ? &presenter.pacer : &pacer, &present) == 0) {
+        SDL_LogInfo(APP, "Present interval %.3f +/- %.3f ms (min %.3f, max %.3f) over %" PRIu64 " frames, %" PRIu64 " missed deadlines",
+                    present.mean, present.stddev, present.min, present.max, present.count, present.missed);
+    }
+
     SDL_PauseAudioDevice(st.audio_device, 1);
 
+    const size_t underruns = mixer_underruns(st.audio.mixer);
+    if (underruns > 0) {
+        SDL_LogWarn(APP, "Audio streams ran dry in %zu buffers", underruns);
+    }
+    struct audio_meter_stats meter;
+    audio_meter_read(&st.audio.meter, &meter);
+    if (meter.over > 0 || meter.late > 0 || st.audio.queue.underruns > 0) {
+        log_audio_meter(&st.audio);
+    }
+
+    if (as.profile_file != NULL) {
+        rc = profiler_dump(&prof, as.profile_file);
+        if (rc != 0) {
+            SDL_LogError(ERR, "Failed to write profile to %s", as.profile_file);
+        }
+    }
+
     ret = EXIT_SUCCESS;
+out_stop_render_thread:
+    if (render_thread != NULL) {
+        render_queue_close(&presenter.queue);
+        SDL_WaitThread(render_thread, NULL);
+    }
+    render_queue_finish(&presenter.queue);
+    if (presenter.snapshot_lock != NULL) {
+        SDL_DestroyMutex(presenter.snapshot_lock);
+        presenter.snapshot_lock = NULL;
+    }
+    if (presenter.lock != NULL) {
+        SDL_DestroyMutex(presenter.lock);
+        presenter.lock = NULL;
+    }
 out_wait_thread:
     SDL_WaitThread(handler, NULL);
 out_message_queue_destroy:
     message_queue_destroy(queue);
-out_destroy_texture:
+out_destroy_text:
+    world_finish(&world);
+    if (scene.backbuffer != NULL) {
+        SDL_DestroyTexture(scene.backbuffer);
+    }
+    sprite_batch_destroy(batch);
+    text_destroy(text);
     SDL_DestroyTexture(texture);
+    scene_raster_finish(&scene);
 out_destroy_window:
     window_destroy(win);
+out_destroy_streamer:
+    // The callback must be stopped before the voices it mixes are freed
+    SDL_PauseAudioDevice(st.audio_device, 1);
+    streamer_destroy(st.audio.streamer);
+out_free_blip:
+    free(blip);
+out_destroy_mixer:
+    mixer_destroy(st.audio.mixer);
 out_close_audio_device:
     SDL_CloseAudioDevice(st.audio_device);
+    free(st.audio.chunk);
+out_stop_trace:
+    trace_stop();
     return ret;
 }
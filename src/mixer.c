@@ -0,0 +1,455 @@
+#include "mixer.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "oscillator.h"
+#include "ramp.h"
+#include "spsc_ring.h"
+
+enum {
+    CHUNK = 256,        // Frames of a sine rendered at a time
+    LIMITER_BLOCK = 32, // Frames sharing one limiter gain target
+};
+
+static const float LIMITER_CEILING = 0.98f; // Peak the limiter holds the mix to
+
+static const double LIMITER_RELEASE = 100.0; // Milliseconds for the limiter to recover by 1 - 1/e
+
+enum voice_kind {
+    VOICE_IDLE,
+    VOICE_TONE,
+    VOICE_SAMPLE,
+    VOICE_STREAM,
+};
+
+enum command_type {
+    COMMAND_TONE,
+    COMMAND_SAMPLE,
+    COMMAND_STREAM,
+    COMMAND_GAIN,
+    COMMAND_STOP,
+};
+
+struct command {
+    enum command_type type;
+    uint32_t voice;             // Index of the voice
+    uint32_t increment;         // Phase advance of a tone
+    float left;                 // Gain of the left channel
+    float right;                // Gain of the right channel
+    struct mixer_sample sample; // Sample to play
+    struct mixer_stream stream; // Stream to play
+};
+
+struct voice {
+    enum voice_kind kind;
+    int stopping;               // Whether to go idle once silent
+    struct ramp left;           // Gain of the left channel
+    struct ramp right;          // Gain of the right channel
+    struct oscillator osc;      // Oscillator of a tone
+    struct mixer_sample sample; // Sample being played
+    size_t position;            // Next sample to play
+    struct mixer_stream stream; // Stream being played
+};
+
+struct mixer {
+    int sample_rate;         // Samples per second
+    size_t count;            // Number of voices
+    struct voice *voices;    // Voices, owned by the audio thread
+    struct spsc_ring ring;   // Commands from the controlling thread
+    float limit;             // Gain the limiter applied last
+    float release;           // Fraction of the way back to unity per limiter block
+    atomic_size_t active;    // Voices playing after the last render
+    atomic_size_t underruns; // Renders in which a stream ran dry
+};
+
+struct mixer *mixer_create(int sample_rate, size_t voices, uint32_t ramp)
+{
+    if (sample_rate <= 0 || voices == 0 || voices > UINT32_MAX || ramp == 0) {
+        return NULL;
+    }
+    struct mixer *mixer = calloc(1, sizeof(*mixer));
+    if (mixer == NULL) {
+        return NULL;
+    }
+    mixer->voices = calloc(voices, sizeof(*mixer->voices));
+    if (mixer->voices == NULL) {
+        free(mixer);
+        return NULL;
+    }
+    // Room for a few commands per voice between two renders
+    size_t cap = 1;
+    while (cap < 4 * voices) {
+        cap *= 2;
+    }
+    if (spsc_ring_init(&mixer->ring, sizeof(struct command), cap) != 0) {
+        free(mixer->voices);
+        free(mixer);
+        return NULL;
+    }
+    mixer->sample_rate = sample_rate;
+    mixer->count = voices;
+    for (size_t i = 0; i < voices; ++i) {
+        mixer->voices[i].kind = VOICE_IDLE;
+        ramp_init(&mixer->voices[i].left, 0.0f, ramp);
+        ramp_init(&mixer->voices[i].right, 0.0f, ramp);
+    }
+    mixer->limit = 1.0f;
+    mixer->release = (float)(1.0 - exp(-(LIMITER_BLOCK * 1000.0) / (LIMITER_RELEASE * sample_rate)));
+    atomic_init(&mixer->active, 0);
+    atomic_init(&mixer->underruns, 0);
+    return mixer;
+}
+
+void mixer_destroy(struct mixer *mixer)
+{
+    if (mixer == NULL) {
+        return;
+    }
+    spsc_ring_finish(&mixer->ring);
+    free(mixer->voices);
+    free(mixer);
+}
+
+size_t mixer_voices(const struct mixer *mixer)
+{
+    return mixer->count;
+}
+
+size_t mixer_active(struct mixer *mixer)
+{
+    return atomic_load_explicit(&mixer->active, memory_order_relaxed);
+}
+
+size_t mixer_underruns(struct mixer *mixer)
+{
+    return atomic_load_explicit(&mixer->underruns, memory_order_relaxed);
+}
+
+/// Splits a gain between the channels so that the power stays the same
+/// across the stereo field.
+static void pan_gains(struct command *command, float gain, float pan)
+{
+    if (pan < -1.0f) {
+        pan = -1.0f;
+    } else if (pan > 1.0f) {
+        pan = 1.0f;
+    }
+    const double angle = (pan + 1.0) * M_PI / 4.0;
+    command->left = gain * (float)cos(angle);
+    command->right = gain * (float)sin(angle);
+}
+
+static int send(struct mixer *mixer, const struct command *command)
+{
+    if (command->voice >= mixer->count) {
+        return -1;
+    }
+    return (spsc_ring_push(&mixer->ring, command, 1) == 1) ? 0 : -1;
+}
+
+int mixer_play_tone(struct mixer *mixer, size_t voice, double frequency, float gain, float pan)
+{
+    struct oscillator osc = {0};
+    oscillator_init(&osc, frequency, mixer->sample_rate);
+    struct command command = {.type = COMMAND_TONE, .voice = (uint32_t)voice, .increment = osc.increment};
+    pan_gains(&command, gain, pan);
+    return send(mixer, &command);
+}
+
+int mixer_play_sample(struct mixer *mixer, size_t voice, const struct mixer_sample *sample, float gain, float pan)
+{
+    if (sample->samples == NULL || sample->count == 0) {
+        return -1;
+    }
+    struct command command = {.type = COMMAND_SAMPLE, .voice = (uint32_t)voice, .sample = *sample};
+    pan_gains(&command, gain, pan);
+    return send(mixer, &command);
+}
+
+int mixer_play_stream(struct mixer *mixer, size_t voice, const struct mixer_stream *stream, float gain, float pan)
+{
+    if (stream->ring == NULL || stream->ring->size != 2 * sizeof(float) || stream->end == NULL) {
+        return -1;
+    }
+    struct command command = {.type = COMMAND_STREAM, .voice = (uint32_t)voice, .stream = *stream};
+    pan_gains(&command, gain, pan);
+    return send(mixer, &command);
+}
+
+int mixer_set_gain(struct mixer *mixer, size_t voice, float gain, float pan)
+{
+    struct command command = {.type = COMMAND_GAIN, .voice = (uint32_t)voice};
+    pan_gains(&command, gain, pan);
+    return send(mixer, &command);
+}
+
+int mixer_stop(struct mixer *mixer, size_t voice)
+{
+    const struct command command = {.type = COMMAND_STOP, .voice = (uint32_t)voice};
+    return send(mixer, &command);
+}
+
+static int silent(const struct voice *voice)
+{
+    return voice->left.value == 0.0f && voice->left.remaining == 0
+           && voice->right.value == 0.0f && voice->right.remaining == 0;
+}
+
+/// Drops what is left of an earlier stream on the same ring.
+static void skip_stale(const struct mixer_stream *stream)
+{
+    const size_t tail = atomic_load_explicit(&stream->ring->tail, memory_order_relaxed);
+    const size_t stale = stream->start - tail;
+    // A voice still fading out may already have taken frames of this stream
+    if (stale <= stream->ring->cap) {
+        (void)spsc_ring_drop(stream->ring, stale);
+    }
+}
+
+static void apply(struct mixer *mixer, const struct command *command)
+{
+    struct voice *voice = &mixer->voices[command->voice];
+    switch (command->type) {
+    case COMMAND_TONE:
+        // Jumping the phase of an audible wave would click
+        if (voice->kind != VOICE_TONE || silent(voice)) {
+            voice->osc.phase = 0;
+        }
+        voice->kind = VOICE_TONE;
+        voice->osc.increment = command->increment;
+        break;
+    case COMMAND_SAMPLE:
+        voice->kind = VOICE_SAMPLE;
+        voice->sample = command->sample;
+        voice->position = 0;
+        break;
+    case COMMAND_STREAM:
+        voice->kind = VOICE_STREAM;
+        voice->stream = command->stream;
+        skip_stale(&voice->stream);
+        break;
+    case COMMAND_GAIN:
+        break;
+    case COMMAND_STOP:
+        voice->stopping = 1;
+        ramp_set(&voice->left, 0.0f);
+        ramp_set(&voice->right, 0.0f);
+        return;
+    }
+    voice->stopping = 0;
+    ramp_set(&voice->left, command->left);
+    ramp_set(&voice->right, command->right);
+}
+
+/// Adds mono samples to both channels of interleaved stereo frames, at the
+/// gains of the voice's ramps.
+static void mix_mono(struct voice *voice, float *out, const float *in, size_t frames)
+{
+    size_t i = 0;
+    for (; i < frames && (voice->left.remaining > 0 || voice->right.remaining > 0); ++i) {
+        out[2 * i] += in[i] * ramp_step(&voice->left);
+        out[(2 * i) + 1] += in[i] * ramp_step(&voice->right);
+    }
+    const float left = voice->left.value;
+    const float right = voice->right.value;
+    if (left == 0.0f && right == 0.0f) {
+        return;
+    }
+#ifdef __SSE2__
+    const __m128 gains = _mm_setr_ps(left, right, left, right);
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 x = _mm_loadu_ps(&in[i]);
+        float *dst = &out[2 * i];
+        // (x0, x0, x1, x1) and (x2, x2, x3, x3) line up with the frames
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(_mm_unpacklo_ps(x, x), gains)));
+        _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_mul_ps(_mm_unpackhi_ps(x, x), gains)));
+    }
+#endif
+    for (; i < frames; ++i) {
+        out[2 * i] += in[i] * left;
+        out[(2 * i) + 1] += in[i] * right;
+    }
+}
+
+/// Adds stereo frames to interleaved stereo frames, at the gains of the
+/// voice's ramps.
+static void mix_stereo(struct voice *voice, float *out, const float *in, size_t frames)
+{
+    size_t i = 0;
+    for (; i < frames && (voice->left.remaining > 0 || voice->right.remaining > 0); ++i) {
+        out[2 * i] += in[2 * i] * ramp_step(&voice->left);
+        out[(2 * i) + 1] += in[(2 * i) + 1] * ramp_step(&voice->right);
+    }
+    const float left = voice->left.value;
+    const float right = voice->right.value;
+    if (left == 0.0f && right == 0.0f) {
+        return;
+    }
+    size_t j = 2 * i;
+    const size_t n = 2 * frames;
+#ifdef __SSE2__
+    const __m128 gains = _mm_setr_ps(left, right, left, right);
+    for (; j + 4 <= n; j += 4) {
+        _mm_storeu_ps(&out[j], _mm_add_ps(_mm_loadu_ps(&out[j]), _mm_mul_ps(_mm_loadu_ps(&in[j]), gains)));
+    }
+#endif
+    for (; j < n; j += 2) {
+        out[j] += in[j] * left;
+        out[j + 1] += in[j + 1] * right;
+    }
+}
+
+static void render_tone(struct voice *voice, float *out, size_t frames)
+{
+    float chunk[CHUNK];
+    for (size_t done = 0; done < frames;) {
+        const size_t n = (frames - done < CHUNK) ? frames - done : CHUNK;
+        if (silent(voice)) {
+            // Keep the phase moving so an unmuted tone carries on in time
+            voice->osc.phase += (uint32_t)((uint64_t)voice->osc.increment * n);
+        } else {
+            oscillator_sine(&voice->osc, chunk, n, 1.0f);
+            mix_mono(voice, out + (2 * done), chunk, n);
+        }
+        done += n;
+    }
+}
+
+/// @return Whether the sample is still playing.
+static int render_sample(struct voice *voice, float *out, size_t frames)
+{
+    const struct mixer_sample *sample = &voice->sample;
+    for (size_t done = 0; done < frames;) {
+        if (voice->position == sample->count) {
+            if (!sample->loop) {
+                return 0;
+            }
+            voice->position = 0;
+        }
+        const size_t left = sample->count - voice->position;
+        const size_t n = (frames - done < left) ? frames - done : left;
+        mix_mono(voice, out + (2 * done), sample->samples + voice->position, n);
+        voice->position += n;
+        done += n;
+    }
+    return voice->position < sample->count || sample->loop;
+}
+
+/// @return Whether the stream is still playing.
+static int render_stream(struct mixer *mixer, struct voice *voice, float *out, size_t frames)
+{
+    const struct mixer_stream *stream = &voice->stream;
+    float chunk[2 * CHUNK];
+    for (size_t done = 0; done < frames;) {
+        const size_t want = (frames - done < CHUNK) ? frames - done : CHUNK;
+        const size_t n = spsc_ring_pop(stream->ring, chunk, want);
+        mix_stereo(voice, out + (2 * done), chunk, n);
+        done += n;
+        if (n < want) {
+            const size_t tail = atomic_load_explicit(&stream->ring->tail, memory_order_relaxed);
+            if (tail == atomic_load_explicit(stream->end, memory_order_acquire)) {
+                return 0;
+            }
+            atomic_fetch_add_explicit(&mixer->underruns, 1, memory_order_relaxed);
+            break;
+        }
+    }
+    return 1;
+}
+
+/// Returns the largest magnitude among n samples.
+static float peak(const float *in, size_t n)
+{
+    size_t i = 0;
+    float max = 0.0f;
+#ifdef __SSE2__
+    const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 m = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(&in[i]), mask));
+    }
+    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    max = _mm_cvtss_f32(m);
+#endif
+    for (; i < n; ++i) {
+        const float a = fabsf(in[i]);
+        max = (a > max) ? a : max;
+    }
+    return max;
+}
+
+/// Holds the mix under the ceiling.  The gain drops at once to what each
+/// block needs, sliding across the block so the drop does not click, and
+/// recovers exponentially.  Samples still over full scale while the gain
+/// slides down are clipped.
+static void limit(struct mixer *mixer, float *out, size_t frames)
+{
+    for (size_t done = 0; done < frames; done += LIMITER_BLOCK) {
+        const size_t n = (frames - done < LIMITER_BLOCK) ? frames - done : LIMITER_BLOCK;
+        float *block = out + (2 * done);
+        const float p = peak(block, 2 * n);
+        const float from = mixer->limit;
+        float to = from + ((1.0f - from) * mixer->release);
+        if (p * to > LIMITER_CEILING) {
+            to = LIMITER_CEILING / p;
+        }
+        mixer->limit = to;
+        if (from == 1.0f && to == 1.0f) {
+            continue;
+        }
+        const float step = (to - from) / (float)n;
+        for (size_t i = 0; i < n; ++i) {
+            const float gain = from + (step * (float)(i + 1));
+            for (size_t c = 0; c < 2; ++c) {
+                const float y = block[(2 * i) + c] * gain;
+                block[(2 * i) + c] = (y > 1.0f) ? 1.0f : ((y < -1.0f) ? -1.0f : y);
+            }
+        }
+    }
+}
+
+void mixer_render(struct mixer *mixer, float *out, size_t frames)
+{
+    struct command command;
+    while (spsc_ring_pop(&mixer->ring, &command, 1) == 1) {
+        apply(mixer, &command);
+    }
+
+    memset(out, 0, 2 * frames * sizeof(*out));
+    size_t active = 0;
+    for (size_t v = 0; v < mixer->count; ++v) {
+        struct voice *voice = &mixer->voices[v];
+        int playing = 1;
+        switch (voice->kind) {
+        case VOICE_IDLE:
+            continue;
+        case VOICE_TONE:
+            render_tone(voice, out, frames);
+            break;
+        case VOICE_SAMPLE:
+            playing = render_sample(voice, out, frames);
+            break;
+        case VOICE_STREAM:
+            playing = render_stream(mixer, voice, out, frames);
+            break;
+        }
+        if (!playing || (voice->stopping && silent(voice))) {
+            voice->kind = VOICE_IDLE;
+            voice->stopping = 0;
+            ramp_init(&voice->left, 0.0f, voice->left.length);
+            ramp_init(&voice->right, 0.0f, voice->right.length);
+            continue;
+        }
+        active += 1;
+    }
+    limit(mixer, out, frames);
+    atomic_store_explicit(&mixer->active, active, memory_order_relaxed);
+}
@@ -0,0 +1,43 @@
+#include "mono_bitmap.h"
+
+#include <string.h>
+
+void mono_bitmap_lut_init(struct mono_bitmap_lut *lut, bmp_pixel32 on, bmp_pixel32 off)
+{
+    for (unsigned value = 0; value < (1U << CHAR_BIT); ++value) {
+        for (unsigned bit = 0; bit < CHAR_BIT; ++bit) {
+            lut->pixels[value][bit] = ((value >> (CHAR_BIT - 1 - bit)) & 1) ? on : off;
+        }
+    }
+}
+
+void mono_bitmap_fill(bmp_pixel32 *image, size_t count, bmp_pixel32 color)
+{
+    if (count == 0) {
+        return;
+    }
+    // Doubles the filled prefix each time, so most of it is copied in bulk
+    image[0] = color;
+    for (size_t filled = 1; filled < count;) {
+        const size_t n = (filled < count - filled) ? filled : count - filled;
+        memcpy(&image[filled], image, n * sizeof(*image));
+        filled += n;
+    }
+}
+
+void mono_bitmap_expand(const struct mono_bitmap_lut *lut, const unsigned char *bits, size_t pitch, size_t width,
+                        size_t rows, bmp_pixel32 *image, size_t image_width, size_t image_height, size_t x, size_t y)
+{
+    const size_t whole = width / CHAR_BIT;
+    const size_t rest = width % CHAR_BIT;
+    for (size_t row = 0; row < rows; ++row) {
+        const unsigned char *source = &bits[row * pitch];
+        bmp_pixel32 *target = &image[((image_height - 1 - (y + row)) * image_width) + x];
+        for (size_t i = 0; i < whole; ++i) {
+            memcpy(&target[i * CHAR_BIT], lut->pixels[source[i]], sizeof(lut->pixels[0]));
+        }
+        if (rest > 0) {
+            memcpy(&target[whole * CHAR_BIT], lut->pixels[source[whole]], rest * sizeof(lut->pixels[0][0]));
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#include "oscillator.h"
+
+#include <assert.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const double TURN = 4294967296.0; // 2^32, one turn of the phase
+
+static const float TURN_INV = 1.0f / 4294967296.0f;
+
+// Taylor coefficients of sin(2 pi x), accurate to 4e-6 for |x| <= 1/4
+static const float C1 = 6.28318531f;
+static const float C3 = -41.3417022f;
+static const float C5 = 81.6052493f;
+static const float C7 = -76.7058597f;
+static const float C9 = 42.0586939f;
+
+void oscillator_init(struct oscillator *osc, double frequency, int sample_rate)
+{
+    osc->phase = 0;
+    oscillator_set_frequency(osc, frequency, sample_rate);
+}
+
+void oscillator_set_frequency(struct oscillator *osc, double frequency, int sample_rate)
+{
+    assert(sample_rate > 0 && frequency >= 0.0 && frequency < (double)sample_rate / 2.0);
+    osc->increment = (uint32_t)llround(frequency / (double)sample_rate * TURN);
+}
+
+/// Returns sin(2 pi x) for x in [-1/2, 1/2).
+static inline float sine(float x)
+{
+    // Reflect the outer quarters onto the inner half, where sin is odd
+    if (x > 0.25f) {
+        x = 0.5f - x;
+    } else if (x < -0.25f) {
+        x = -0.5f - x;
+    }
+    const float x2 = x * x;
+    return x * (C1 + x2 * (C3 + x2 * (C5 + x2 * (C7 + x2 * C9))));
+}
+
+/// Returns the phase as a signed fraction of a turn, in [-1/2, 1/2).
+static inline float turns(uint32_t phase)
+{
+    return (float)(int32_t)phase * TURN_INV;
+}
+
+#ifdef __SSE2__
+static inline __m128 sine4(__m128 x)
+{
+    const __m128 sign = _mm_and_ps(x, _mm_set1_ps(-0.0f));
+    const __m128 outer = _mm_cmpgt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), _mm_set1_ps(0.25f));
+    const __m128 reflected = _mm_sub_ps(_mm_or_ps(_mm_set1_ps(0.5f), sign), x);
+    x = _mm_or_ps(_mm_and_ps(outer, reflected), _mm_andnot_ps(outer, x));
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 y = _mm_add_ps(_mm_set1_ps(C7), _mm_mul_ps(x2, _mm_set1_ps(C9)));
+    y = _mm_add_ps(_mm_set1_ps(C5), _mm_mul_ps(x2, y));
+    y = _mm_add_ps(_mm_set1_ps(C3), _mm_mul_ps(x2, y));
+    y = _mm_add_ps(_mm_set1_ps(C1), _mm_mul_ps(x2, y));
+    return _mm_mul_ps(x, y);
+}
+
+/// Returns the sines of the next four phases, scaled by gain.
+static inline __m128 next4(__m128i *phase, __m128i step, __m128 gain)
+{
+    const __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(*phase), _mm_set1_ps(TURN_INV));
+    *phase = _mm_add_epi32(*phase, step);
+    return _mm_mul_ps(sine4(x), gain);
+}
+
+/// Returns the phases of the next four samples.
+static inline __m128i phases4(const struct oscillator *osc)
+{
+    const uint32_t p = osc->phase;
+    const uint32_t d = osc->increment;
+    return _mm_setr_epi32((int)p, (int)(p + d), (int)(p + 2 * d), (int)(p + 3 * d));
+}
+#endif
+
+void oscillator_sine(struct oscillator *osc, float *out, size_t n, float gain)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    if (n >= 4) {
+        __m128i phase = phases4(osc);
+        const __m128i step = _mm_set1_epi32((int)(4 * osc->increment));
+        const __m128 g = _mm_set1_ps(gain);
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(&out[i], next4(&phase, step, g));
+        }
+        osc->phase += (uint32_t)i * osc->increment;
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = gain * sine(turns(osc->phase));
+        osc->phase += osc->increment;
+    }
+}
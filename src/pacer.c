@@ -0,0 +1,82 @@
+#include "pacer.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+static const double SECOND = 1000.0;
+
+static const double TOLERANCE = 1e-3; // Fraction of a refresh ignored when rounding up
+
+void pacer_init(struct pacer *pacer, int refresh_rate)
+{
+    assert(refresh_rate > 0);
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->period = SECOND / (double)refresh_rate;
+}
+
+void pacer_set_refresh(struct pacer *pacer, int refresh_rate)
+{
+    pacer_init(pacer, refresh_rate);
+}
+
+int pacer_divisor(const struct pacer *pacer, double frame_time)
+{
+    const int divisor = (int)ceil((frame_time / pacer->period) - TOLERANCE);
+    return (divisor > 0) ? divisor : 1;
+}
+
+double pacer_next(struct pacer *pacer, double now, double frame_time)
+{
+    const double interval = pacer->period * (double)pacer_divisor(pacer, frame_time);
+    if (!pacer->started) {
+        pacer->started = 1;
+        pacer->deadline = now + interval;
+        return pacer->deadline;
+    }
+    pacer->deadline += interval;
+    if (pacer->deadline < now) {
+        pacer->missed += 1;
+        pacer->deadline += ceil((now - pacer->deadline) / pacer->period) * pacer->period;
+    }
+    return pacer->deadline;
+}
+
+void pacer_present(struct pacer *pacer, double now)
+{
+    if (pacer->presented) {
+        // Welford's online mean and variance
+        const double interval = now - pacer->last_present;
+        pacer->count += 1;
+        const double d = interval - pacer->mean;
+        pacer->mean += d / (double)pacer->count;
+        pacer->m2 += d * (interval - pacer->mean);
+        if (pacer->count == 1 || interval < pacer->min) {
+            pacer->min = interval;
+        }
+        if (pacer->count == 1 || interval > pacer->max) {
+            pacer->max = interval;
+        }
+    }
+    pacer->last_present = now;
+    pacer->presented = 1;
+}
+
+void pacer_skip(struct pacer *pacer)
+{
+    pacer->presented = 0;
+}
+
+int pacer_stats(const struct pacer *pacer, struct pacer_stats *stats)
+{
+    if (pacer->count == 0) {
+        return -1;
+    }
+    stats->count = pacer->count;
+    stats->mean = pacer->mean;
+    stats->stddev = sqrt(pacer->m2 / (double)pacer->count);
+    stats->min = pacer->min;
+    stats->max = pacer->max;
+    stats->missed = pacer->missed;
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "pixels.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+_Static_assert(sizeof(bmp_pixel32) == sizeof(uint32_t), "bmp_pixel32 is not 32 bits");
+
+/// Divides by 255, rounding to nearest, for x in [0, 255 * 255].
+static inline uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline void blend_one(bmp_pixel32 *dst, const bmp_pixel32 *src)
+{
+    const uint32_t a = src->a;
+    if (a == 0) {
+        return;
+    }
+    const uint32_t na = 255 - a;
+    dst->b = (uint8_t)div255(src->b * a + dst->b * na);
+    dst->g = (uint8_t)div255(src->g * a + dst->g * na);
+    dst->r = (uint8_t)div255(src->r * a + dst->r * na);
+    dst->a = 0xFF;
+}
+
+void pixels_fill(bmp_pixel32 *dst, bmp_pixel32 color, size_t n)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    uint32_t value = 0;
+    memcpy(&value, &color, sizeof(value));
+    const __m128i v = _mm_set1_epi32((int)value);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i *)(void *)&dst[i], v);
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = color;
+    }
+}
+
+void pixels_copy(bmp_pixel32 *restrict dst, const bmp_pixel32 *restrict src, size_t n)
+{
+    memcpy(dst, src, n * sizeof(*dst));
+}
+
+#ifdef __SSE2__
+/// Blends two pixels unpacked to 16-bit lanes.
+static inline __m128i blend_lanes(__m128i s, __m128i d)
+{
+    const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i na = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, na));
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+void pixels_blend(bmp_pixel32 *restrict dst, const bmp_pixel32 *restrict src, size_t n)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    for (; i + 4 <= n; i += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *)(const void *)&src[i]);
+        const __m128i sa = _mm_and_si128(s, alpha);
+        const int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(sa, alpha));
+        if (opaque == 0xFFFF) {
+            _mm_storeu_si128((__m128i *)(void *)&dst[i], s);
+            continue;
+        }
+        const int clear = _mm_movemask_epi8(_mm_cmpeq_epi32(sa, zero));
+        if (clear == 0xFFFF) {
+            continue;
+        }
+        const __m128i d = _mm_loadu_si128((const __m128i *)(const void *)&dst[i]);
+        const __m128i lo = blend_lanes(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        const __m128i hi = blend_lanes(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128((__m128i *)(void *)&dst[i], _mm_or_si128(_mm_packus_epi16(lo, hi), alpha));
+    }
+#endif
+    for (; i < n; ++i) {
+        blend_one(&dst[i], &src[i]);
+    }
+}
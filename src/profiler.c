@@ -0,0 +1,149 @@
+#include "profiler.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prelude_sdl.h"
+
+static const double SECOND = 1000.0;
+
+static const char *const PHASE_STR[] = {
+#define X(variant, i, str) [variant] = (str),
+    PROFILER_PHASE_VARIANTS
+#undef X
+    [PHASE_FRAME] = "frame",
+};
+
+const char *profiler_phase_str(enum profiler_phase phase)
+{
+    if (phase < 0 || phase > PHASE_FRAME) {
+        return NULL;
+    }
+    return PHASE_STR[phase];
+}
+
+void profiler_begin_slow(struct profiler *prof, enum profiler_phase phase)
+{
+    assert(phase < PHASE_MAX);
+    prof->phase_begin[phase] = now();
+}
+
+void profiler_end_slow(struct profiler *prof, enum profiler_phase phase)
+{
+    assert(phase < PHASE_MAX);
+    prof->current.ticks[phase] += now() - prof->phase_begin[phase];
+}
+
+void profiler_frame_slow(struct profiler *prof)
+{
+    const uint64_t end = now();
+    prof->current.ticks[PHASE_FRAME] = end - prof->frame_begin;
+    prof->frames[prof->next] = prof->current;
+    prof->next = (prof->next + 1) % PROFILER_FRAMES;
+    if (prof->count < PROFILER_FRAMES) {
+        prof->count += 1;
+    }
+    memset(&prof->current, 0, sizeof(prof->current));
+    prof->frame_begin = end;
+}
+
+void profiler_enable(struct profiler *prof, int enabled)
+{
+    prof->enabled = enabled;
+    memset(prof->phase_begin, 0, sizeof(prof->phase_begin));
+    memset(&prof->current, 0, sizeof(prof->current));
+    if (enabled) {
+        // Frames from before the profiler was last disabled are stale
+        prof->next = 0;
+        prof->count = 0;
+    }
+    prof->frame_begin = now();
+}
+
+static int compare_ticks(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/// Converts performance counter ticks to milliseconds.
+static double ticks_to_ms(uint64_t ticks)
+{
+    const uint64_t freq = SDL_GetPerformanceFrequency();
+    assert(freq > 0);
+    return ((double)ticks * SECOND) / (double)freq;
+}
+
+/// Returns the nearest-rank percentile of a sorted array.
+static uint64_t percentile(const uint64_t *sorted, size_t count, size_t pct)
+{
+    assert(count > 0);
+    size_t rank = (pct * count + 99) / 100;
+    if (rank > 0) {
+        rank -= 1;
+    }
+    return sorted[rank];
+}
+
+int profiler_stats(const struct profiler *prof, enum profiler_phase phase, struct profiler_stats *stats)
+{
+    assert(phase <= PHASE_FRAME);
+    if (prof->count == 0) {
+        return -1;
+    }
+    uint64_t sorted[PROFILER_FRAMES];
+    for (size_t i = 0; i < prof->count; ++i) {
+        sorted[i] = prof->frames[i].ticks[phase];
+    }
+    qsort(sorted, prof->count, sizeof(*sorted), compare_ticks);
+    stats->p50 = ticks_to_ms(percentile(sorted, prof->count, 50));
+    stats->p95 = ticks_to_ms(percentile(sorted, prof->count, 95));
+    stats->p99 = ticks_to_ms(percentile(sorted, prof->count, 99));
+    stats->max = ticks_to_ms(sorted[prof->count - 1]);
+    return 0;
+}
+
+int profiler_dump(const struct profiler *prof, const char *file)
+{
+    int ret = -1;
+
+    FILE *file_handle = fopen(file, "w");
+    if (file_handle == NULL) {
+        return -1;
+    }
+
+    struct profiler_stats stats = {0};
+    for (int phase = 0; phase <= PHASE_FRAME; ++phase) {
+        if (profiler_stats(prof, phase, &stats) != 0) {
+            break;
+        }
+        (void)fprintf(file_handle, "# %s: p50=%.3f p95=%.3f p99=%.3f max=%.3f\n",
+                      PHASE_STR[phase], stats.p50, stats.p95, stats.p99, stats.max);
+    }
+
+    (void)fprintf(file_handle, "frame");
+    for (int phase = 0; phase <= PHASE_FRAME; ++phase) {
+        (void)fprintf(file_handle, ",%s", PHASE_STR[phase]);
+    }
+    (void)fprintf(file_handle, "\n");
+
+    // Oldest frame first
+    const size_t first = (prof->next + PROFILER_FRAMES - prof->count) % PROFILER_FRAMES;
+    for (size_t i = 0; i < prof->count; ++i) {
+        const struct profiler_frame *frame = &prof->frames[(first + i) % PROFILER_FRAMES];
+        (void)fprintf(file_handle, "%zu", i);
+        for (int phase = 0; phase <= PHASE_FRAME; ++phase) {
+            (void)fprintf(file_handle, ",%.3f", ticks_to_ms(frame->ticks[phase]));
+        }
+        (void)fprintf(file_handle, "\n");
+    }
+
+    if (ferror(file_handle) == 0) {
+        ret = 0;
+    }
+    fclose(file_handle);
+    return ret;
+}
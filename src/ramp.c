@@ -0,0 +1,33 @@
+#include "ramp.h"
+
+#include <assert.h>
+
+void ramp_init(struct ramp *ramp, float value, uint32_t length)
+{
+    assert(length > 0);
+    ramp->value = value;
+    ramp->target = value;
+    ramp->step = 0.0f;
+    ramp->remaining = 0;
+    ramp->length = length;
+}
+
+void ramp_set(struct ramp *ramp, float target)
+{
+    if (target == ramp->target) {
+        return;
+    }
+    ramp->target = target;
+    ramp->step = (target - ramp->value) / (float)ramp->length;
+    ramp->remaining = ramp->length;
+}
+
+float ramp_step(struct ramp *ramp)
+{
+    if (ramp->remaining > 0) {
+        ramp->remaining -= 1;
+        // Land exactly on the target, whatever rounding built up on the way
+        ramp->value = (ramp->remaining == 0) ? ramp->target : ramp->value + ramp->step;
+    }
+    return ramp->value;
+}
@@ -0,0 +1,211 @@
+#include "raster.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pixels.h"
+#include "prelude_sdl.h"
+
+enum raster_op {
+    RASTER_FILL,
+    RASTER_BLIT,
+    RASTER_BLEND,
+};
+
+struct raster_command {
+    enum raster_op op;      // What to do
+    SDL_Rect dst;           // Destination, clipped to the raster
+    bmp_pixel32 color;      // Color of a fill
+    const bmp_pixel32 *src; // Source pixel of the top-left of dst
+    int pitch;              // Distance between source rows in pixels
+};
+
+struct raster {
+    bmp_pixel32 *pixels;             // The framebuffer
+    int width;                       // Width in pixels
+    int height;                      // Height in pixels
+    int cols;                        // Number of tile columns
+    int rows;                        // Number of tile rows
+    struct worker_pool *pool;        // Pool to rasterize with
+    struct raster_command *commands; // Recorded commands
+    size_t count;                    // Number of recorded commands
+    size_t cap;                      // Capacity of commands
+    uint8_t *target;                 // Locked texture pixels during raster_draw(), or NULL
+    int target_pitch;                // Distance between texture rows in bytes
+};
+
+struct raster *raster_create(int width, int height, struct worker_pool *pool)
+{
+    if (width <= 0 || height <= 0) {
+        return NULL;
+    }
+    struct raster *raster = calloc(1, sizeof(*raster));
+    if (raster == NULL) {
+        return NULL;
+    }
+    raster->pixels = calloc((size_t)width * (size_t)height, sizeof(*raster->pixels));
+    if (raster->pixels == NULL) {
+        free(raster);
+        return NULL;
+    }
+    raster->width = width;
+    raster->height = height;
+    raster->cols = (width + RASTER_TILE - 1) / RASTER_TILE;
+    raster->rows = (height + RASTER_TILE - 1) / RASTER_TILE;
+    raster->pool = pool;
+    return raster;
+}
+
+void raster_destroy(struct raster *raster)
+{
+    if (raster == NULL) {
+        return;
+    }
+    free(raster->commands);
+    free(raster->pixels);
+    free(raster);
+}
+
+static struct raster_command *push(struct raster *raster)
+{
+    if (raster->count == raster->cap) {
+        const size_t cap = (raster->cap == 0) ? 64 : raster->cap * 2;
+        struct raster_command *tmp = realloc(raster->commands, cap * sizeof(*tmp));
+        if (tmp == NULL) {
+            return NULL;
+        }
+        raster->commands = tmp;
+        raster->cap = cap;
+    }
+    return &raster->commands[raster->count++];
+}
+
+int raster_fill(struct raster *raster, const SDL_Rect *rect, bmp_pixel32 color)
+{
+    const SDL_Rect bounds = {0, 0, raster->width, raster->height};
+    SDL_Rect dst = bounds;
+    if (rect != NULL && !SDL_IntersectRect(rect, &bounds, &dst)) {
+        return 0;
+    }
+    struct raster_command *command = push(raster);
+    if (command == NULL) {
+        return -1;
+    }
+    *command = (struct raster_command){.op = RASTER_FILL, .dst = dst, .color = color};
+    return 0;
+}
+
+/// Records a blit or blend, clipped to both the image and the raster.
+static int record(struct raster *raster, enum raster_op op, const struct raster_image *image,
+                  const SDL_Rect *src, int x, int y)
+{
+    const SDL_Rect extent = {0, 0, image->width, image->height};
+    SDL_Rect s = extent;
+    if (src != NULL && !SDL_IntersectRect(src, &extent, &s)) {
+        return 0;
+    }
+    if (src != NULL) {
+        x += s.x - src->x;
+        y += s.y - src->y;
+    }
+    const SDL_Rect bounds = {0, 0, raster->width, raster->height};
+    const SDL_Rect unclipped = {x, y, s.w, s.h};
+    SDL_Rect dst = {0};
+    if (!SDL_IntersectRect(&unclipped, &bounds, &dst)) {
+        return 0;
+    }
+    s.x += dst.x - x;
+    s.y += dst.y - y;
+    struct raster_command *command = push(raster);
+    if (command == NULL) {
+        return -1;
+    }
+    *command = (struct raster_command){
+        .op = op,
+        .dst = dst,
+        .src = &image->pixels[((size_t)s.y * (size_t)image->pitch) + (size_t)s.x],
+        .pitch = image->pitch,
+    };
+    return 0;
+}
+
+int raster_blit(struct raster *raster, const struct raster_image *image, const SDL_Rect *src, int x, int y)
+{
+    return record(raster, RASTER_BLIT, image, src, x, y);
+}
+
+int raster_blend(struct raster *raster, const struct raster_image *image, const SDL_Rect *src, int x, int y)
+{
+    return record(raster, RASTER_BLEND, image, src, x, y);
+}
+
+/// Runs every command over one tile, then copies the tile to the target.
+static void draw_tile(void *data, size_t index)
+{
+    struct raster *raster = data;
+    const int col = (int)(index % (size_t)raster->cols);
+    const int row = (int)(index / (size_t)raster->cols);
+    const SDL_Rect bounds = {0, 0, raster->width, raster->height};
+    const SDL_Rect unclipped = {col * RASTER_TILE, row * RASTER_TILE, RASTER_TILE, RASTER_TILE};
+    SDL_Rect tile = {0};
+    (void)SDL_IntersectRect(&unclipped, &bounds, &tile);
+
+    for (size_t i = 0; i < raster->count; ++i) {
+        const struct raster_command *command = &raster->commands[i];
+        SDL_Rect r = {0};
+        if (!SDL_IntersectRect(&command->dst, &tile, &r)) {
+            continue;
+        }
+        const size_t n = (size_t)r.w;
+        for (int y = r.y; y < r.y + r.h; ++y) {
+            bmp_pixel32 *dst = &raster->pixels[((size_t)y * (size_t)raster->width) + (size_t)r.x];
+            if (command->op == RASTER_FILL) {
+                pixels_fill(dst, command->color, n);
+                continue;
+            }
+            const size_t sy = (size_t)(y - command->dst.y);
+            const size_t sx = (size_t)(r.x - command->dst.x);
+            const bmp_pixel32 *src = &command->src[(sy * (size_t)command->pitch) + sx];
+            if (command->op == RASTER_BLIT) {
+                pixels_copy(dst, src, n);
+            } else {
+                pixels_blend(dst, src, n);
+            }
+        }
+    }
+
+    if (raster->target == NULL) {
+        return;
+    }
+    for (int y = tile.y; y < tile.y + tile.h; ++y) {
+        const bmp_pixel32 *src = &raster->pixels[((size_t)y * (size_t)raster->width) + (size_t)tile.x];
+        uint8_t *dst = raster->target + ((size_t)y * (size_t)raster->target_pitch) + ((size_t)tile.x * sizeof(*src));
+        memcpy(dst, src, (size_t)tile.w * sizeof(*src));
+    }
+}
+
+int raster_draw(struct raster *raster, SDL_Texture *texture)
+{
+    if (texture != NULL) {
+        void *pixels = NULL;
+        if (SDL_LockTexture(texture, NULL, &pixels, &raster->target_pitch) != 0) {
+            log_sdl_error("SDL_LockTexture failed");
+            raster->count = 0;
+            return -1;
+        }
+        raster->target = pixels;
+    }
+    worker_pool_run(raster->pool, draw_tile, raster, (size_t)raster->cols * (size_t)raster->rows);
+    if (texture != NULL) {
+        SDL_UnlockTexture(texture);
+        raster->target = NULL;
+    }
+    raster->count = 0;
+    return 0;
+}
+
+const bmp_pixel32 *raster_pixels(const struct raster *raster)
+{
+    return raster->pixels;
+}
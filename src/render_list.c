@@ -0,0 +1,298 @@
+#include "render_list.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "prelude_sdl.h"
+
+enum {
+    RENDER_QUEUE_INDEX = 0x3, // Mask of the list index in ready
+    RENDER_QUEUE_FRESH = 0x4, // Set in ready when the list has not been replayed
+};
+
+int render_list_init(struct render_list *list, size_t cap, size_t strings_cap)
+{
+    memset(list, 0, sizeof(*list));
+    list->commands = calloc(cap, sizeof(*list->commands));
+    list->strings = calloc(strings_cap, sizeof(*list->strings));
+    if (list->commands == NULL || list->strings == NULL) {
+        render_list_finish(list);
+        return -1;
+    }
+    list->cap = cap;
+    list->strings_cap = strings_cap;
+    return 0;
+}
+
+void render_list_finish(struct render_list *list)
+{
+    free(list->commands);
+    free(list->strings);
+    memset(list, 0, sizeof(*list));
+}
+
+void render_list_reset(struct render_list *list)
+{
+    list->count = 0;
+    list->strings_len = 0;
+}
+
+static struct render_command *push(struct render_list *list, enum render_op op)
+{
+    if (list->count == list->cap) {
+        const size_t cap = (list->cap == 0) ? 64 : list->cap * 2;
+        struct render_command *tmp = realloc(list->commands, cap * sizeof(*tmp));
+        if (tmp == NULL) {
+            return NULL;
+        }
+        list->commands = tmp;
+        list->cap = cap;
+    }
+    struct render_command *command = &list->commands[list->count++];
+    memset(command, 0, sizeof(*command));
+    command->op = op;
+    return command;
+}
+
+int render_list_clear(struct render_list *list, SDL_Color color)
+{
+    struct render_command *command = push(list, RENDER_CLEAR);
+    if (command == NULL) {
+        return -1;
+    }
+    command->color = color;
+    return 0;
+}
+
+int render_list_copy(struct render_list *list, SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst)
+{
+    struct render_command *command = push(list, RENDER_COPY);
+    if (command == NULL) {
+        return -1;
+    }
+    command->texture = texture;
+    if (src != NULL) {
+        command->src = *src;
+        command->has_src = 1;
+    }
+    command->dst = *dst;
+    return 0;
+}
+
+int render_list_fill(struct render_list *list, const SDL_Rect *rect, SDL_Color color)
+{
+    struct render_command *command = push(list, RENDER_FILL);
+    if (command == NULL) {
+        return -1;
+    }
+    command->dst = *rect;
+    command->color = color;
+    return 0;
+}
+
+int render_list_sprite(struct render_list *list, SDL_Texture *texture,
+                       const SDL_Rect *src, const SDL_FRect *dst, SDL_Color color)
+{
+    struct render_command *command = push(list, RENDER_SPRITE);
+    if (command == NULL) {
+        return -1;
+    }
+    command->texture = texture;
+    command->src = *src;
+    command->fdst = *dst;
+    command->color = color;
+    return 0;
+}
+
+int render_list_text(struct render_list *list, struct text *text, int x, int y, SDL_Color color, const char *str)
+{
+    const size_t len = strlen(str) + 1;
+    if (list->strings_len + len > list->strings_cap) {
+        size_t cap = (list->strings_cap == 0) ? 256 : list->strings_cap;
+        while (cap < list->strings_len + len) {
+            cap *= 2;
+        }
+        char *tmp = realloc(list->strings, cap);
+        if (tmp == NULL) {
+            return -1;
+        }
+        list->strings = tmp;
+        list->strings_cap = cap;
+    }
+    struct render_command *command = push(list, RENDER_TEXT);
+    if (command == NULL) {
+        return -1;
+    }
+    memcpy(list->strings + list->strings_len, str, len);
+    command->text = text;
+    command->x = x;
+    command->y = y;
+    command->color = color;
+    command->str = list->strings_len;
+    list->strings_len += len;
+    return 0;
+}
+
+int render_list_call(struct render_list *list, render_fn *fn, void *data)
+{
+    struct render_command *command = push(list, RENDER_CALL);
+    if (command == NULL) {
+        return -1;
+    }
+    command->fn = fn;
+    command->data = data;
+    return 0;
+}
+
+static int set_color(SDL_Renderer *renderer, SDL_Color color)
+{
+    const int rc = SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+    if (rc != 0) {
+        log_sdl_error("SDL_SetRenderDrawColor failed");
+        return -1;
+    }
+    return 0;
+}
+
+/// Replays a command which does not go through the batch.
+static int replay_direct(const struct render_command *command, SDL_Renderer *renderer)
+{
+    int rc = 0;
+    switch (command->op) {
+    case RENDER_CLEAR:
+        if (set_color(renderer, command->color) != 0) {
+            return -1;
+        }
+        rc = SDL_RenderClear(renderer);
+        if (rc != 0) {
+            log_sdl_error("SDL_RenderClear failed");
+        }
+        break;
+    case RENDER_COPY:
+        rc = SDL_RenderCopy(renderer, command->texture, command->has_src ? &command->src : NULL, &command->dst);
+        if (rc != 0) {
+            log_sdl_error("SDL_RenderCopy failed");
+        }
+        break;
+    case RENDER_FILL:
+        rc = SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        if (rc != 0) {
+            log_sdl_error("SDL_SetRenderDrawBlendMode failed");
+            return -1;
+        }
+        if (set_color(renderer, command->color) != 0) {
+            return -1;
+        }
+        rc = SDL_RenderFillRect(renderer, &command->dst);
+        if (rc != 0) {
+            log_sdl_error("SDL_RenderFillRect failed");
+        }
+        break;
+    case RENDER_CALL:
+        rc = command->fn(renderer, command->data);
+        break;
+    default:
+        break;
+    }
+    return (rc == 0) ? 0 : -1;
+}
+
+int render_list_replay(const struct render_list *list, SDL_Renderer *renderer, struct sprite_batch *batch)
+{
+    for (size_t i = 0; i < list->count; ++i) {
+        const struct render_command *command = &list->commands[i];
+        int rc = 0;
+        switch (command->op) {
+        case RENDER_SPRITE:
+            rc = sprite_batch_draw(batch, command->texture, &command->src, &command->fdst, command->color);
+            break;
+        case RENDER_TEXT:
+            text_set_color(command->text, command->color);
+            rc = text_draw(command->text, batch, command->x, command->y, list->strings + command->str);
+            break;
+        default:
+            rc = sprite_batch_flush(batch);
+            if (rc == 0) {
+                rc = replay_direct(command, renderer);
+            }
+            break;
+        }
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    return sprite_batch_flush(batch);
+}
+
+int render_queue_init(struct render_queue *queue, size_t cap, size_t strings_cap)
+{
+    memset(queue, 0, sizeof(*queue));
+    for (size_t i = 0; i < 3; ++i) {
+        if (render_list_init(&queue->lists[i], cap, strings_cap) != 0) {
+            render_queue_finish(queue);
+            return -1;
+        }
+    }
+    queue->published = SDL_CreateSemaphore(0);
+    if (queue->published == NULL) {
+        log_sdl_error("SDL_CreateSemaphore failed");
+        render_queue_finish(queue);
+        return -1;
+    }
+    queue->writing = 0;
+    queue->reading = 1;
+    atomic_init(&queue->ready, 2);
+    atomic_init(&queue->closed, 0);
+    return 0;
+}
+
+void render_queue_finish(struct render_queue *queue)
+{
+    for (size_t i = 0; i < 3; ++i) {
+        render_list_finish(&queue->lists[i]);
+    }
+    if (queue->published != NULL) {
+        SDL_DestroySemaphore(queue->published);
+        queue->published = NULL;
+    }
+}
+
+struct render_list *render_queue_begin(struct render_queue *queue)
+{
+    struct render_list *list = &queue->lists[queue->writing];
+    render_list_reset(list);
+    return list;
+}
+
+void render_queue_publish(struct render_queue *queue)
+{
+    const int prev = atomic_exchange_explicit(&queue->ready, queue->writing | RENDER_QUEUE_FRESH,
+                                              memory_order_acq_rel);
+    queue->writing = prev & RENDER_QUEUE_INDEX;
+    (void)SDL_SemPost(queue->published);
+}
+
+const struct render_list *render_queue_wait(struct render_queue *queue)
+{
+    for (;;) {
+        if (atomic_load_explicit(&queue->closed, memory_order_acquire)) {
+            return NULL;
+        }
+        // Only this thread clears the flag, so a fresh list stays fresh until taken
+        if (atomic_load_explicit(&queue->ready, memory_order_acquire) & RENDER_QUEUE_FRESH) {
+            const int prev = atomic_exchange_explicit(&queue->ready, queue->reading, memory_order_acq_rel);
+            queue->reading = prev & RENDER_QUEUE_INDEX;
+            return &queue->lists[queue->reading];
+        }
+        if (SDL_SemWait(queue->published) != 0) {
+            log_sdl_error("SDL_SemWait failed");
+            return NULL;
+        }
+    }
+}
+
+void render_queue_close(struct render_queue *queue)
+{
+    atomic_store_explicit(&queue->closed, 1, memory_order_release);
+    (void)SDL_SemPost(queue->published);
+}
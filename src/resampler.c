@@ -0,0 +1,183 @@
+#include "resampler.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum {
+    HALF = RESAMPLER_TAPS / 2,
+    CAPACITY = RESAMPLER_TAPS + RESAMPLER_BLOCK, // Frames the buffer holds
+};
+
+static const double ROLLOFF = 0.9; // Cutoff as a share of the lower Nyquist frequency
+
+static const double KAISER_BETA = 8.0; // Shape of the window, trading a wider transition for a deeper stopband
+
+static size_t gcd(size_t a, size_t b)
+{
+    while (b != 0) {
+        const size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/// Evaluates the zeroth order modified Bessel function of the first kind
+/// by its power series.
+static double bessel_i0(double x)
+{
+    const double q = (x * x) / 4.0;
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+        term *= q / ((double)k * (double)k);
+        sum += term;
+    }
+    return sum;
+}
+
+/// Tabulates the Kaiser-windowed sinc at each phase, normalized so that
+/// every phase passes DC at unity gain.
+static void tabulate(struct resampler *resampler)
+{
+    const double ratio = (double)resampler->up / (double)resampler->down;
+    const double cutoff = ROLLOFF * ((ratio < 1.0) ? ratio : 1.0);
+    const double norm = bessel_i0(KAISER_BETA);
+    double taps[RESAMPLER_TAPS];
+    for (size_t p = 0; p < resampler->up; ++p) {
+        const double frac = (double)p / (double)resampler->up;
+        double sum = 0.0;
+        for (size_t j = 0; j < RESAMPLER_TAPS; ++j) {
+            // Distance from the output frame, in input frames
+            const double x = (double)j - (HALF - 1) - frac;
+            const double t = x / HALF;
+            const double window = bessel_i0(KAISER_BETA * sqrt(fmax(0.0, 1.0 - (t * t)))) / norm;
+            const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+            taps[j] = cutoff * sinc * window;
+            sum += taps[j];
+        }
+        float *c = &resampler->coefficients[p * 2 * RESAMPLER_TAPS];
+        for (size_t j = 0; j < RESAMPLER_TAPS; ++j) {
+            c[2 * j] = (float)(taps[j] / sum);
+            c[(2 * j) + 1] = c[2 * j];
+        }
+    }
+}
+
+int resampler_init(struct resampler *resampler, int from, int to)
+{
+    memset(resampler, 0, sizeof(*resampler));
+    if (from <= 0 || to <= 0) {
+        return -1;
+    }
+    const size_t d = gcd((size_t)from, (size_t)to);
+    resampler->up = (size_t)to / d;
+    resampler->down = (size_t)from / d;
+    if (resampler->up > RESAMPLER_MAX_PHASES) {
+        return -1;
+    }
+    // malloc() aligns to 16 bytes, and each phase is a multiple of that
+    resampler->coefficients = malloc(resampler->up * 2 * RESAMPLER_TAPS * sizeof(*resampler->coefficients));
+    resampler->frames = malloc(2 * CAPACITY * sizeof(*resampler->frames));
+    if (resampler->coefficients == NULL || resampler->frames == NULL) {
+        resampler_finish(resampler);
+        return -1;
+    }
+    tabulate(resampler);
+    resampler_reset(resampler);
+    return 0;
+}
+
+void resampler_finish(struct resampler *resampler)
+{
+    free(resampler->coefficients);
+    free(resampler->frames);
+    memset(resampler, 0, sizeof(*resampler));
+}
+
+void resampler_reset(struct resampler *resampler)
+{
+    // Silence before the stream, so that the first output falls on the first input
+    memset(resampler->frames, 0, 2 * (HALF - 1) * sizeof(*resampler->frames));
+    resampler->filled = HALF - 1;
+    resampler->position = 0;
+    resampler->phase = 0;
+}
+
+/// Filters one stereo output frame from the input frames under the taps.
+static void filter(const float *c, const float *x, float *out)
+{
+#ifdef __SSE2__
+    __m128 a = _mm_setzero_ps();
+    __m128 b = _mm_setzero_ps();
+    // Two frames at a time, with two sums to hide the adds' latency
+    for (size_t j = 0; j < 2 * RESAMPLER_TAPS; j += 8) {
+        a = _mm_add_ps(a, _mm_mul_ps(_mm_load_ps(&c[j]), _mm_loadu_ps(&x[j])));
+        b = _mm_add_ps(b, _mm_mul_ps(_mm_load_ps(&c[j + 4]), _mm_loadu_ps(&x[j + 4])));
+    }
+    a = _mm_add_ps(a, b);
+    // The lanes hold left, right, left, right
+    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    _mm_storel_pi((__m64 *)out, a);
+#else
+    float left = 0.0f;
+    float right = 0.0f;
+    for (size_t j = 0; j < RESAMPLER_TAPS; ++j) {
+        left += c[2 * j] * x[2 * j];
+        right += c[(2 * j) + 1] * x[(2 * j) + 1];
+    }
+    out[0] = left;
+    out[1] = right;
+#endif
+}
+
+/// Drops the frames the taps have passed and buffers more input.
+static size_t refill(struct resampler *resampler, const float *in, size_t in_frames)
+{
+    size_t used = 0;
+    if (resampler->position >= resampler->filled) {
+        // Decimating can step past the whole buffer and into the input
+        resampler->position -= resampler->filled;
+        resampler->filled = 0;
+        used = (resampler->position < in_frames) ? resampler->position : in_frames;
+        resampler->position -= used;
+    } else {
+        const size_t keep = resampler->filled - resampler->position;
+        memmove(resampler->frames, &resampler->frames[2 * resampler->position], 2 * keep * sizeof(*resampler->frames));
+        resampler->filled = keep;
+        resampler->position = 0;
+    }
+    size_t n = CAPACITY - resampler->filled;
+    n = (n < in_frames - used) ? n : in_frames - used;
+    memcpy(&resampler->frames[2 * resampler->filled], &in[2 * used], 2 * n * sizeof(*in));
+    resampler->filled += n;
+    return used + n;
+}
+
+size_t resampler_process(struct resampler *resampler, const float *in, size_t *in_frames, float *out, size_t out_frames)
+{
+    size_t used = 0;
+    size_t written = 0;
+    while (written < out_frames) {
+        if (resampler->position + RESAMPLER_TAPS > resampler->filled) {
+            if (used == *in_frames) {
+                break;
+            }
+            used += refill(resampler, &in[2 * used], *in_frames - used);
+            continue;
+        }
+        filter(&resampler->coefficients[resampler->phase * 2 * RESAMPLER_TAPS],
+               &resampler->frames[2 * resampler->position], &out[2 * written]);
+        written += 1;
+        resampler->phase += resampler->down;
+        resampler->position += resampler->phase / resampler->up;
+        resampler->phase %= resampler->up;
+    }
+    *in_frames = used;
+    return written;
+}
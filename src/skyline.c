@@ -0,0 +1,119 @@
+#include "skyline.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int skyline_init(struct skyline *sky, int width, int height)
+{
+    memset(sky, 0, sizeof(*sky));
+    if (width <= 0 || height <= 0) {
+        return -1;
+    }
+    // Every segment is at least a column wide, and one more is split off at most
+    sky->segments = malloc(((size_t)width + 1) * sizeof(*sky->segments));
+    if (sky->segments == NULL) {
+        return -1;
+    }
+    sky->width = width;
+    sky->height = height;
+    sky->segments[0] = (struct skyline_segment){.x = 0, .y = 0, .width = width};
+    sky->count = 1;
+    return 0;
+}
+
+void skyline_finish(struct skyline *sky)
+{
+    free(sky->segments);
+    memset(sky, 0, sizeof(*sky));
+}
+
+/// Finds the row a rectangle would rest on with its left edge on a
+/// segment, and the area it would leave unusable beneath it.
+///
+/// @return 0 if it fits, -1 otherwise.
+static int fit(const struct skyline *sky, size_t i, int width, int height, int *y, long *waste)
+{
+    const int left = sky->segments[i].x;
+    if (left + width > sky->width) {
+        return -1;
+    }
+    int top = 0;
+    for (size_t j = i; j < sky->count && sky->segments[j].x < left + width; ++j) {
+        top = (sky->segments[j].y > top) ? sky->segments[j].y : top;
+    }
+    if (top + height > sky->height) {
+        return -1;
+    }
+    long under = 0;
+    for (size_t j = i; j < sky->count && sky->segments[j].x < left + width; ++j) {
+        const int right = sky->segments[j].x + sky->segments[j].width;
+        const int span = ((right < left + width) ? right : left + width) - sky->segments[j].x;
+        under += (long)span * (top - sky->segments[j].y);
+    }
+    *y = top;
+    *waste = under;
+    return 0;
+}
+
+/// Raises the columns under a placed rectangle, and joins segments left
+/// at the same row.
+static void place(struct skyline *sky, size_t i, int width, int bottom)
+{
+    const int left = sky->segments[i].x;
+    const int right = left + width;
+    // Segments wholly under the rectangle go, and one partly under it is cut
+    size_t end = i;
+    while (end < sky->count && sky->segments[end].x + sky->segments[end].width <= right) {
+        end += 1;
+    }
+    if (end < sky->count && sky->segments[end].x < right) {
+        sky->segments[end].width -= right - sky->segments[end].x;
+        sky->segments[end].x = right;
+    }
+    // The segments from i up to end give way to one under the rectangle
+    memmove(&sky->segments[i + 1], &sky->segments[end], (sky->count - end) * sizeof(*sky->segments));
+    sky->count = sky->count + i + 1 - end;
+    sky->segments[i] = (struct skyline_segment){.x = left, .y = bottom, .width = width};
+
+    size_t out = 0;
+    for (size_t j = 1; j < sky->count; ++j) {
+        if (sky->segments[j].y == sky->segments[out].y) {
+            sky->segments[out].width += sky->segments[j].width;
+        } else {
+            sky->segments[++out] = sky->segments[j];
+        }
+    }
+    sky->count = out + 1;
+}
+
+int skyline_insert(struct skyline *sky, int width, int height, int *x, int *y)
+{
+    if (width <= 0 || height <= 0) {
+        return -1;
+    }
+    size_t best = SIZE_MAX;
+    int best_bottom = INT_MAX;
+    long best_waste = LONG_MAX;
+    for (size_t i = 0; i < sky->count; ++i) {
+        int top = 0;
+        long waste = 0;
+        if (fit(sky, i, width, height, &top, &waste) != 0) {
+            continue;
+        }
+        if (top + height < best_bottom || (top + height == best_bottom && waste < best_waste)) {
+            best = i;
+            best_bottom = top + height;
+            best_waste = waste;
+        }
+    }
+    if (best == SIZE_MAX) {
+        return -1;
+    }
+    *x = sky->segments[best].x;
+    *y = best_bottom - height;
+    place(sky, best, width, best_bottom);
+    sky->area += (long)width * height;
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "sprite_batch.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+
+enum {
+    QUAD_VERTICES = 4,
+    QUAD_INDICES = 6,
+};
+
+struct sprite_batch {
+    SDL_Renderer *renderer; // Renderer to submit to
+    SDL_Vertex *vertices;   // QUAD_VERTICES per quad
+    int *indices;           // QUAD_INDICES per quad, filled once
+    int capacity;           // Maximum number of quads
+    int count;              // Number of pending quads
+    SDL_Texture *texture;   // Texture of the pending quads
+    float inv_width;        // Reciprocal of the texture width
+    float inv_height;       // Reciprocal of the texture height
+    int submissions;        // Number of submissions since last queried
+};
+
+struct sprite_batch *sprite_batch_create(SDL_Renderer *renderer, int capacity)
+{
+    if (capacity <= 0 || capacity > INT_MAX / (QUAD_INDICES * (int)sizeof(int))) {
+        return NULL;
+    }
+    struct sprite_batch *batch = calloc(1, sizeof(*batch));
+    if (batch == NULL) {
+        return NULL;
+    }
+    batch->vertices = calloc((size_t)capacity * QUAD_VERTICES, sizeof(*batch->vertices));
+    batch->indices = calloc((size_t)capacity * QUAD_INDICES, sizeof(*batch->indices));
+    if (batch->vertices == NULL || batch->indices == NULL) {
+        sprite_batch_destroy(batch);
+        return NULL;
+    }
+    // Every quad is two triangles over its own four vertices, so the
+    // indices never change.
+    for (int i = 0, v = 0; i < capacity * QUAD_INDICES; i += QUAD_INDICES, v += QUAD_VERTICES) {
+        batch->indices[i + 0] = v + 0;
+        batch->indices[i + 1] = v + 1;
+        batch->indices[i + 2] = v + 2;
+        batch->indices[i + 3] = v + 2;
+        batch->indices[i + 4] = v + 3;
+        batch->indices[i + 5] = v + 0;
+    }
+    batch->renderer = renderer;
+    batch->capacity = capacity;
+    return batch;
+}
+
+void sprite_batch_destroy(struct sprite_batch *batch)
+{
+    if (batch == NULL) {
+        return;
+    }
+    free(batch->vertices);
+    free(batch->indices);
+    free(batch);
+}
+
+int sprite_batch_flush(struct sprite_batch *batch)
+{
+    if (batch->count == 0) {
+        return 0;
+    }
+    const int rc = SDL_RenderGeometry(batch->renderer, batch->texture,
+                                      batch->vertices, batch->count * QUAD_VERTICES,
+                                      batch->indices, batch->count * QUAD_INDICES);
+    batch->count = 0;
+    batch->submissions += 1;
+    if (rc != 0) {
+        log_sdl_error("SDL_RenderGeometry failed");
+        return -1;
+    }
+    return 0;
+}
+
+/// Switches the batch to a new texture, submitting any pending quads.
+static int set_texture(struct sprite_batch *batch, SDL_Texture *texture)
+{
+    const int rc = sprite_batch_flush(batch);
+    if (rc != 0) {
+        return -1;
+    }
+    int width = 0;
+    int height = 0;
+    if (SDL_QueryTexture(texture, NULL, NULL, &width, &height) != 0) {
+        log_sdl_error("SDL_QueryTexture failed");
+        return -1;
+    }
+    assert(width > 0 && height > 0);
+    batch->texture = texture;
+    batch->inv_width = 1.0f / (float)width;
+    batch->inv_height = 1.0f / (float)height;
+    return 0;
+}
+
+int sprite_batch_draw(struct sprite_batch *batch, SDL_Texture *texture,
+                      const SDL_Rect *src, const SDL_FRect *dst, SDL_Color color)
+{
+    int rc = 0;
+    if (texture != batch->texture) {
+        rc = set_texture(batch, texture);
+    } else if (batch->count == batch->capacity) {
+        rc = sprite_batch_flush(batch);
+    }
+    if (rc != 0) {
+        return -1;
+    }
+
+    const float u0 = (float)src->x * batch->inv_width;
+    const float v0 = (float)src->y * batch->inv_height;
+    const float u1 = (float)(src->x + src->w) * batch->inv_width;
+    const float v1 = (float)(src->y + src->h) * batch->inv_height;
+    const float x0 = dst->x;
+    const float y0 = dst->y;
+    const float x1 = dst->x + dst->w;
+    const float y1 = dst->y + dst->h;
+
+    SDL_Vertex *v = &batch->vertices[batch->count * QUAD_VERTICES];
+    v[0] = (SDL_Vertex){.position = {x0, y0}, .color = color, .tex_coord = {u0, v0}};
+    v[1] = (SDL_Vertex){.position = {x1, y0}, .color = color, .tex_coord = {u1, v0}};
+    v[2] = (SDL_Vertex){.position = {x1, y1}, .color = color, .tex_coord = {u1, v1}};
+    v[3] = (SDL_Vertex){.position = {x0, y1}, .color = color, .tex_coord = {u0, v1}};
+    batch->count += 1;
+    return 0;
+}
+
+int sprite_batch_submissions(struct sprite_batch *batch)
+{
+    const int ret = batch->submissions;
+    batch->submissions = 0;
+    return ret;
+}
@@ -0,0 +1,96 @@
+#include "spsc_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int spsc_ring_init(struct spsc_ring *ring, size_t size, size_t cap)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (size == 0 || cap == 0 || (cap & (cap - 1)) != 0) {
+        return -1;
+    }
+    ring->items = malloc(size * cap);
+    if (ring->items == NULL) {
+        return -1;
+    }
+    ring->size = size;
+    ring->cap = cap;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return 0;
+}
+
+void spsc_ring_finish(struct spsc_ring *ring)
+{
+    free(ring->items);
+    ring->items = NULL;
+}
+
+/// Returns where index falls in the ring, and how many of n items fit
+/// before its end.
+static size_t split(const struct spsc_ring *ring, size_t index, size_t n, size_t *first)
+{
+    const size_t at = index & (ring->cap - 1);
+    *first = (n < ring->cap - at) ? n : ring->cap - at;
+    return at;
+}
+
+size_t spsc_ring_push(struct spsc_ring *ring, const void *items, size_t n)
+{
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    const size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    const size_t space = ring->cap - (head - tail);
+    if (n > space) {
+        n = space;
+    }
+    if (n > 0) {
+        size_t first = 0;
+        const size_t at = split(ring, head, n, &first);
+        const unsigned char *src = items;
+        memcpy(ring->items + (at * ring->size), src, first * ring->size);
+        memcpy(ring->items, src + (first * ring->size), (n - first) * ring->size);
+        atomic_store_explicit(&ring->head, head + n, memory_order_release);
+    }
+    return n;
+}
+
+size_t spsc_ring_pop(struct spsc_ring *ring, void *items, size_t n)
+{
+    const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (n > head - tail) {
+        n = head - tail;
+    }
+    if (n > 0) {
+        size_t first = 0;
+        const size_t at = split(ring, tail, n, &first);
+        unsigned char *dst = items;
+        memcpy(dst, ring->items + (at * ring->size), first * ring->size);
+        memcpy(dst + (first * ring->size), ring->items, (n - first) * ring->size);
+        atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+    }
+    return n;
+}
+
+size_t spsc_ring_drop(struct spsc_ring *ring, size_t n)
+{
+    const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (n > head - tail) {
+        n = head - tail;
+    }
+    atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+    return n;
+}
+
+size_t spsc_ring_readable(struct spsc_ring *ring)
+{
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    const size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
+
+size_t spsc_ring_writable(struct spsc_ring *ring)
+{
+    return ring->cap - spsc_ring_readable(ring);
+}
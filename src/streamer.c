@@ -0,0 +1,285 @@
+#include "streamer.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prelude_sdl.h"
+#include "resampler.h"
+#include "spsc_ring.h"
+#include "wav.h"
+
+enum {
+    CHUNK = 1024,  // Frames converted at a time
+    POLL = 5,      // Milliseconds between passes over the streams
+    LOOKAHEAD = 4, // Rings' worth of frames the kernel is asked to read ahead
+};
+
+enum stream_state {
+    STREAM_IDLE,    // Closed, owned by the controlling thread
+    STREAM_PLAYING, // Being read by the thread
+    STREAM_ENDED,   // Read to the end, the file still open
+    STREAM_CLOSING, // Waiting for the thread to close the file
+};
+
+struct stream {
+    atomic_int state;           // State of enum stream_state
+    struct wav wav;             // File being read
+    int loop;                   // Whether to read from the start again at the end
+    size_t position;            // Next frame to convert
+    size_t prefetched;          // Frames the kernel has been asked to read in
+    size_t released;            // Frames the kernel has been told are done with
+    struct spsc_ring ring;      // Converted frames for the mixer
+    atomic_size_t end;          // Frames pushed once the file is over, or SIZE_MAX
+    int resampling;             // Whether the file is at another sample rate
+    struct resampler resampler; // Converter to the mixer's sample rate
+    size_t drained;             // Frames of silence fed to the resampler after a file's end
+};
+
+struct streamer {
+    int sample_rate;        // Frames per second of every stream
+    size_t count;           // Number of streams
+    struct stream *streams; // Streams
+    size_t lookahead;       // Frames read ahead of the position
+    float *chunk;           // Frames being converted, owned by the thread
+    float *resampled;       // Frames resampled from the chunk, owned by the thread
+    SDL_sem *wake;          // Posted to start a pass early
+    SDL_Thread *thread;     // The prefetching thread
+    atomic_int quit;        // Whether the thread should exit
+};
+
+/// Pushes the frames the resampler still holds back at the end of a file
+/// which does not loop, by feeding it the silence after the file.
+///
+/// @return 0 once every frame is pushed, -1 while the ring is too full.
+static int drain(struct streamer *streamer, struct stream *stream)
+{
+    for (;;) {
+        size_t room = spsc_ring_writable(&stream->ring);
+        if (room == 0) {
+            return -1;
+        }
+        room = (room < CHUNK) ? room : CHUNK;
+        size_t n = (RESAMPLER_TAPS / 2) - stream->drained;
+        memset(streamer->chunk, 0, 2 * n * sizeof(*streamer->chunk));
+        const size_t out = resampler_process(&stream->resampler, streamer->chunk, &n, streamer->resampled, room);
+        (void)spsc_ring_push(&stream->ring, streamer->resampled, out);
+        stream->drained += n;
+        // Output short of the room means the resampler ran out of input
+        if (stream->drained == RESAMPLER_TAPS / 2 && out < room) {
+            return 0;
+        }
+    }
+}
+
+/// Converts frames into a stream's ring until it is full or the file ends.
+static void fill(struct streamer *streamer, struct stream *stream)
+{
+    const struct wav *wav = &stream->wav;
+    for (;;) {
+        if (stream->position == wav->frames) {
+            if (!stream->loop) {
+                if (stream->resampling && drain(streamer, stream) != 0) {
+                    return;
+                }
+                atomic_store_explicit(&stream->end, atomic_load_explicit(&stream->ring.head, memory_order_relaxed),
+                                      memory_order_release);
+                int playing = STREAM_PLAYING;
+                // Closing wins over ending
+                (void)atomic_compare_exchange_strong(&stream->state, &playing, STREAM_ENDED);
+                return;
+            }
+            wav_release(wav, stream->released, wav->frames - stream->released);
+            wav_prefetch(wav, 0, streamer->lookahead);
+            stream->position = 0;
+            stream->prefetched = streamer->lookahead;
+            stream->released = 0;
+        }
+        const size_t left = wav->frames - stream->position;
+        size_t n = spsc_ring_writable(&stream->ring);
+        // Wait for room for a whole chunk, or for the rest of the file
+        if (n < CHUNK && n < left) {
+            return;
+        }
+        n = (n < CHUNK) ? n : CHUNK;
+        if (stream->resampling) {
+            // Frames the resampler could not take are read again next time
+            size_t used = wav_read_stereo(wav, stream->position, streamer->chunk, CHUNK);
+            n = resampler_process(&stream->resampler, streamer->chunk, &used, streamer->resampled, n);
+            (void)spsc_ring_push(&stream->ring, streamer->resampled, n);
+            n = used;
+        } else {
+            n = wav_read_stereo(wav, stream->position, streamer->chunk, n);
+            (void)spsc_ring_push(&stream->ring, streamer->chunk, n);
+        }
+        stream->position += n;
+
+        // Keep at least half the lookahead on its way in
+        if (stream->position + (streamer->lookahead / 2) > stream->prefetched) {
+            wav_prefetch(wav, stream->prefetched, streamer->lookahead);
+            stream->prefetched += streamer->lookahead;
+        }
+        if (stream->position - stream->released >= streamer->lookahead) {
+            wav_release(wav, stream->released, stream->position - stream->released);
+            stream->released = stream->position;
+        }
+    }
+}
+
+static int prefetch(void *data)
+{
+    struct streamer *streamer = data;
+    while (!atomic_load_explicit(&streamer->quit, memory_order_acquire)) {
+        for (size_t i = 0; i < streamer->count; ++i) {
+            struct stream *stream = &streamer->streams[i];
+            switch (atomic_load_explicit(&stream->state, memory_order_acquire)) {
+            case STREAM_PLAYING:
+                fill(streamer, stream);
+                break;
+            case STREAM_CLOSING:
+                wav_close(&stream->wav);
+                resampler_finish(&stream->resampler);
+                atomic_store_explicit(&stream->state, STREAM_IDLE, memory_order_release);
+                break;
+            default:
+                break;
+            }
+        }
+        (void)SDL_SemWaitTimeout(streamer->wake, POLL);
+    }
+    return 0;
+}
+
+struct streamer *streamer_create(int sample_rate, size_t streams, size_t frames)
+{
+    if (sample_rate <= 0 || streams == 0 || frames < CHUNK) {
+        return NULL;
+    }
+    struct streamer *streamer = calloc(1, sizeof(*streamer));
+    if (streamer == NULL) {
+        return NULL;
+    }
+    streamer->sample_rate = sample_rate;
+    streamer->lookahead = LOOKAHEAD * frames;
+    streamer->streams = calloc(streams, sizeof(*streamer->streams));
+    streamer->chunk = malloc(2 * CHUNK * sizeof(*streamer->chunk));
+    streamer->resampled = malloc(2 * CHUNK * sizeof(*streamer->resampled));
+    if (streamer->streams == NULL || streamer->chunk == NULL || streamer->resampled == NULL) {
+        streamer_destroy(streamer);
+        return NULL;
+    }
+    for (size_t i = 0; i < streams; ++i) {
+        struct stream *stream = &streamer->streams[i];
+        if (spsc_ring_init(&stream->ring, 2 * sizeof(float), frames) != 0) {
+            streamer_destroy(streamer);
+            return NULL;
+        }
+        streamer->count += 1;
+        // Fault the pages in now rather than in the audio callback
+        memset(stream->ring.items, 0, stream->ring.size * frames);
+        atomic_init(&stream->state, STREAM_IDLE);
+        atomic_init(&stream->end, SIZE_MAX);
+    }
+    streamer->wake = SDL_CreateSemaphore(0);
+    if (streamer->wake == NULL) {
+        log_sdl_error("SDL_CreateSemaphore failed");
+        streamer_destroy(streamer);
+        return NULL;
+    }
+    atomic_init(&streamer->quit, 0);
+    streamer->thread = SDL_CreateThread(prefetch, "prefetch", streamer);
+    if (streamer->thread == NULL) {
+        log_sdl_error("SDL_CreateThread failed");
+        streamer_destroy(streamer);
+        return NULL;
+    }
+    return streamer;
+}
+
+void streamer_destroy(struct streamer *streamer)
+{
+    if (streamer == NULL) {
+        return;
+    }
+    if (streamer->thread != NULL) {
+        atomic_store_explicit(&streamer->quit, 1, memory_order_release);
+        (void)SDL_SemPost(streamer->wake);
+        SDL_WaitThread(streamer->thread, NULL);
+    }
+    for (size_t i = 0; i < streamer->count; ++i) {
+        wav_close(&streamer->streams[i].wav);
+        resampler_finish(&streamer->streams[i].resampler);
+        spsc_ring_finish(&streamer->streams[i].ring);
+    }
+    if (streamer->wake != NULL) {
+        SDL_DestroySemaphore(streamer->wake);
+    }
+    free(streamer->resampled);
+    free(streamer->chunk);
+    free(streamer->streams);
+    free(streamer);
+}
+
+int streamer_open(struct streamer *streamer, size_t i, const char *file, int loop, struct mixer_stream *out)
+{
+    if (i >= streamer->count) {
+        return -1;
+    }
+    struct stream *stream = &streamer->streams[i];
+    if (atomic_load_explicit(&stream->state, memory_order_acquire) != STREAM_IDLE) {
+        return -1;
+    }
+    if (wav_open(&stream->wav, file) != 0) {
+        SDL_LogError(ERR, "%s: failed to open %s", __func__, file);
+        return -1;
+    }
+    if (stream->wav.frames == 0) {
+        SDL_LogError(ERR, "%s: %s is empty", __func__, file);
+        wav_close(&stream->wav);
+        return -1;
+    }
+    stream->resampling = stream->wav.sample_rate != streamer->sample_rate;
+    if (stream->resampling && resampler_init(&stream->resampler, stream->wav.sample_rate, streamer->sample_rate) != 0) {
+        SDL_LogError(ERR, "%s: can not resample %s from %d to %d Hz", __func__, file, stream->wav.sample_rate, streamer->sample_rate);
+        wav_close(&stream->wav);
+        return -1;
+    }
+    stream->drained = 0;
+    stream->loop = loop;
+    stream->position = 0;
+    stream->released = 0;
+    wav_prefetch(&stream->wav, 0, streamer->lookahead);
+    stream->prefetched = streamer->lookahead;
+    atomic_store_explicit(&stream->end, SIZE_MAX, memory_order_relaxed);
+    // The thread is not pushing to an idle stream's ring, so its head is settled
+    *out = (struct mixer_stream){
+        .ring = &stream->ring,
+        .start = atomic_load_explicit(&stream->ring.head, memory_order_relaxed),
+        .end = &stream->end,
+    };
+    atomic_store_explicit(&stream->state, STREAM_PLAYING, memory_order_release);
+    (void)SDL_SemPost(streamer->wake);
+    return 0;
+}
+
+void streamer_close(struct streamer *streamer, size_t i)
+{
+    if (i >= streamer->count) {
+        return;
+    }
+    struct stream *stream = &streamer->streams[i];
+    if (atomic_load_explicit(&stream->state, memory_order_acquire) == STREAM_IDLE) {
+        return;
+    }
+    atomic_store_explicit(&stream->state, STREAM_CLOSING, memory_order_release);
+    (void)SDL_SemPost(streamer->wake);
+}
+
+int streamer_idle(const struct streamer *streamer, size_t i)
+{
+    if (i >= streamer->count) {
+        return 0;
+    }
+    return atomic_load_explicit(&streamer->streams[i].state, memory_order_acquire) == STREAM_IDLE;
+}
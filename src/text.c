@@ -0,0 +1,332 @@
+#include "text.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph_index.h"
+#include "prelude_sdl.h"
+
+enum {
+    GLYPH_WIDTH = 10,
+    GLYPH_HEIGHT = 20,
+    LOW = '!',
+    HIGH = '~',
+    CODES_SIZE = (HIGH - LOW) + 1,
+    GLYPH_TABLE_SIZE = 256, // One glyph for each value of a char
+    RUN_CACHE_SIZE = 64,    // Number of cached glyph runs, must be a power of two
+};
+
+_Static_assert((RUN_CACHE_SIZE & (RUN_CACHE_SIZE - 1)) == 0, "RUN_CACHE_SIZE is not a power of two");
+
+/// Where a glyph is in the atlas, and where it is drawn from the pen.
+struct glyph_cell {
+    SDL_Rect src; // Atlas rectangle, empty if there is nothing to draw
+    int x;        // Offset of the left edge from the pen
+    int y;        // Offset of the top edge from the top of the line
+    int advance;  // Columns the pen moves after the glyph
+};
+
+/// A glyph positioned relative to the origin of its run.
+struct glyph_quad {
+    uint8_t code; // Index into the glyph table
+    int32_t x;    // Offset of the left edge
+    int32_t y;    // Offset of the top edge
+};
+
+/// A laid-out string.
+struct glyph_run {
+    uint64_t hash;            // Hash of str
+    char *str;                // The string, or NULL if the slot is unused
+    size_t str_cap;           // Capacity of str
+    struct glyph_quad *quads; // The visible glyphs
+    size_t quads_cap;         // Capacity of quads
+    size_t count;             // Number of visible glyphs
+    int w;                    // Width of the run
+    int h;                    // Height of the run
+};
+
+struct text {
+    SDL_Texture *texture;                       // Atlas texture, white glyphs with coverage in alpha
+    struct glyph_cell glyphs[GLYPH_TABLE_SIZE]; // Glyph of each char
+    int line_height;                            // Rows from the top of one line to the next
+    SDL_Color color;                            // Color of subsequent draws
+    struct glyph_run runs[RUN_CACHE_SIZE];      // Direct-mapped cache of glyph runs
+};
+
+/// Turns the atlas' black-on-white glyphs into white glyphs with coverage in
+/// the alpha channel, so that they can be tinted by the vertex color.
+///
+/// @param surface An ARGB8888 surface.
+/// @return 0 on success, -1 on failure.
+static int make_alpha_mask(SDL_Surface *surface)
+{
+    assert(surface->format->format == SDL_PIXELFORMAT_ARGB8888);
+    if (SDL_LockSurface(surface) != 0) {
+        log_sdl_error("SDL_LockSurface failed");
+        return -1;
+    }
+    for (int y = 0; y < surface->h; ++y) {
+        uint32_t *row = (uint32_t *)((uint8_t *)surface->pixels + ((size_t)y * (size_t)surface->pitch));
+        for (int x = 0; x < surface->w; ++x) {
+            const uint32_t coverage = 0xFF - ((row[x] >> 16) & 0xFF);
+            row[x] = (coverage << 24) | 0x00FFFFFF;
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return 0;
+}
+
+/// Lays the glyphs out as a single row of GLYPH_WIDTH x GLYPH_HEIGHT
+/// cells from LOW to HIGH.
+static int load_fixed_glyphs(struct text *text, int w, int h)
+{
+    if (h != GLYPH_HEIGHT || w != GLYPH_WIDTH * CODES_SIZE) {
+        SDL_LogError(ERR, "%s: unexpected atlas size %dx%d", __func__, w, h);
+        return -1;
+    }
+    for (int c = 0; c < GLYPH_TABLE_SIZE; ++c) {
+        text->glyphs[c] = (struct glyph_cell){.advance = GLYPH_WIDTH};
+        if (c >= LOW && c <= HIGH) {
+            text->glyphs[c].src = (SDL_Rect){.x = (c - LOW) * GLYPH_WIDTH, .y = 0, .w = GLYPH_WIDTH, .h = GLYPH_HEIGHT};
+        }
+    }
+    text->line_height = GLYPH_HEIGHT;
+    return 0;
+}
+
+/// Takes the ASCII glyphs on the atlas' first page from its index.  Codes
+/// the index has no glyph for, or has one on another page for, advance the
+/// pen as far as a space does and draw nothing.
+static int load_indexed_glyphs(struct text *text, const struct glyph_index *index, int w, int h)
+{
+    const struct glyph_index_header *header = index->header;
+    if (header->page_count == 0 || index->pages[0].width != w || index->pages[0].height != h) {
+        SDL_LogError(ERR, "%s: atlas size %dx%d does not match its index", __func__, w, h);
+        return -1;
+    }
+    const struct glyph_metrics *space = glyph_index_find(index, ' ');
+    const int missing = (space != NULL) ? space->advance : GLYPH_WIDTH;
+    for (int c = 0; c < GLYPH_TABLE_SIZE; ++c) {
+        text->glyphs[c] = (struct glyph_cell){.advance = missing};
+        // Bytes past ASCII are pieces of multibyte characters
+        const struct glyph_metrics *m = (c < 0x80) ? glyph_index_find(index, (uint32_t)c) : NULL;
+        if (m == NULL || (m->page != 0 && m->width > 0)) {
+            continue;
+        }
+        text->glyphs[c] = (struct glyph_cell){
+            .src = {.x = m->x, .y = m->y, .w = m->width, .h = m->height},
+            .x = m->left,
+            .y = header->ascent - m->top,
+            .advance = m->advance,
+        };
+    }
+    text->line_height = header->line_height;
+    return 0;
+}
+
+/// Fills the glyph table from the index beside the atlas if there is one,
+/// and otherwise from the fixed layout of the ASCII strip.
+static int load_glyphs(struct text *text, const char *path, int w, int h)
+{
+    char *index_file = glyph_index_file_name(path);
+    if (index_file == NULL) {
+        return -1;
+    }
+    struct glyph_index index;
+    int rc = glyph_index_open(&index, index_file);
+    if (rc != 0) {
+        free(index_file);
+        return load_fixed_glyphs(text, w, h);
+    }
+    SDL_LogDebug(APP, "%s: glyph metrics from %s", __func__, index_file);
+    free(index_file);
+    rc = load_indexed_glyphs(text, &index, w, h);
+    glyph_index_close(&index);
+    return rc;
+}
+
+struct text *text_create(SDL_Renderer *renderer, const char *path)
+{
+    struct text *text = calloc(1, sizeof(*text));
+    if (text == NULL) {
+        return NULL;
+    }
+    SDL_Surface *loaded = SDL_LoadBMP(path);
+    if (loaded == NULL) {
+        log_sdl_error("SDL_LoadBMP failed");
+        goto out_destroy_text;
+    }
+    SDL_Surface *surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (surface == NULL) {
+        log_sdl_error("SDL_ConvertSurfaceFormat failed");
+        goto out_destroy_text;
+    }
+    if (load_glyphs(text, path, surface->w, surface->h) != 0 || make_alpha_mask(surface) != 0) {
+        SDL_FreeSurface(surface);
+        goto out_destroy_text;
+    }
+    text->texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (text->texture == NULL) {
+        log_sdl_error("SDL_CreateTextureFromSurface failed");
+        goto out_destroy_text;
+    }
+    if (SDL_SetTextureBlendMode(text->texture, SDL_BLENDMODE_BLEND) != 0) {
+        log_sdl_error("SDL_SetTextureBlendMode failed");
+        goto out_destroy_text;
+    }
+    text->color = (SDL_Color){0xFF, 0xFF, 0xFF, 0xFF};
+    return text;
+out_destroy_text:
+    text_destroy(text);
+    return NULL;
+}
+
+void text_destroy(struct text *text)
+{
+    if (text == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < RUN_CACHE_SIZE; ++i) {
+        free(text->runs[i].str);
+        free(text->runs[i].quads);
+    }
+    if (text->texture != NULL) {
+        SDL_DestroyTexture(text->texture);
+    }
+    free(text);
+}
+
+void text_set_color(struct text *text, SDL_Color color)
+{
+    text->color = color;
+}
+
+/// FNV-1a
+static uint64_t hash_str(const char *str, size_t *len)
+{
+    uint64_t hash = 0xcbf29ce484222325U;
+    const char *c = str;
+    for (; *c != '\0'; ++c) {
+        hash ^= (uint8_t)*c;
+        hash *= 0x100000001b3U;
+    }
+    *len = (size_t)(c - str);
+    return hash;
+}
+
+/// Grows an array to hold at least n elements.
+static int reserve(void **ptr, size_t *cap, size_t n, size_t size)
+{
+    if (n <= *cap) {
+        return 0;
+    }
+    size_t new_cap = (*cap == 0) ? 16 : *cap;
+    while (new_cap < n) {
+        new_cap *= 2;
+    }
+    void *tmp = realloc(*ptr, new_cap * size);
+    if (tmp == NULL) {
+        return -1;
+    }
+    *ptr = tmp;
+    *cap = new_cap;
+    return 0;
+}
+
+/// Lays out a string into a run.
+static int layout(const struct text *text, struct glyph_run *run, const char *str, size_t len, uint64_t hash)
+{
+    if (reserve((void **)&run->str, &run->str_cap, len + 1, sizeof(*run->str)) != 0
+        || reserve((void **)&run->quads, &run->quads_cap, len, sizeof(*run->quads)) != 0) {
+        return -1;
+    }
+    memcpy(run->str, str, len + 1);
+    run->hash = hash;
+    run->count = 0;
+    int x = 0;
+    int y = 0;
+    int w = 0;
+    for (size_t i = 0; i < len; ++i) {
+        const uint8_t c = (uint8_t)str[i];
+        if (c == '\n') {
+            x = 0;
+            y += text->line_height;
+            continue;
+        }
+        const struct glyph_cell *glyph = &text->glyphs[c];
+        if (glyph->src.w > 0) {
+            run->quads[run->count++] = (struct glyph_quad){
+                .code = c,
+                .x = x + glyph->x,
+                .y = y + glyph->y,
+            };
+        }
+        x += glyph->advance;
+        if (x > w) {
+            w = x;
+        }
+    }
+    run->w = w;
+    run->h = y + text->line_height;
+    return 0;
+}
+
+/// Returns the cached run for a string, laying it out on a miss.
+static struct glyph_run *lookup(struct text *text, const char *str)
+{
+    size_t len = 0;
+    const uint64_t hash = hash_str(str, &len);
+    struct glyph_run *run = &text->runs[hash & (RUN_CACHE_SIZE - 1)];
+    if (run->str != NULL && run->hash == hash && strcmp(run->str, str) == 0) {
+        return run;
+    }
+    if (layout(text, run, str, len, hash) != 0) {
+        free(run->str);
+        run->str = NULL;
+        run->str_cap = 0;
+        return NULL;
+    }
+    return run;
+}
+
+void text_measure(const struct text *text, const char *str, SDL_Rect *rect)
+{
+    // Same arithmetic as layout(), without touching the cache
+    int x = 0;
+    int w = 0;
+    int h = text->line_height;
+    for (const char *c = str; *c != '\0'; ++c) {
+        if (*c == '\n') {
+            x = 0;
+            h += text->line_height;
+            continue;
+        }
+        x += text->glyphs[(uint8_t)*c].advance;
+        if (x > w) {
+            w = x;
+        }
+    }
+    rect->w = w;
+    rect->h = h;
+}
+
+int text_draw(struct text *text, struct sprite_batch *batch, int x, int y, const char *str)
+{
+    const struct glyph_run *run = lookup(text, str);
+    if (run == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < run->count; ++i) {
+        const struct glyph_quad *quad = &run->quads[i];
+        const SDL_Rect *src = &text->glyphs[quad->code].src;
+        const SDL_FRect dst = {.x = (float)(x + quad->x), .y = (float)(y + quad->y), .w = (float)src->w, .h = (float)src->h};
+        if (sprite_batch_draw(batch, text->texture, src, &dst, text->color) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
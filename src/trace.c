@@ -0,0 +1,232 @@
+#include "trace.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+
+enum {
+    TRACE_BUFFER_CAP = 8192, // Events per thread, must be a power of two
+    TRACE_FLUSH_MS = 10,     // Time between drains of the buffers
+    TRACE_PID = 1,
+};
+
+_Static_assert((TRACE_BUFFER_CAP & (TRACE_BUFFER_CAP - 1)) == 0, "TRACE_BUFFER_CAP is not a power of two");
+
+struct trace_record {
+    uint64_t ts;      // Timestamp in performance counter ticks
+    const char *name; // Event name
+    double value;     // Counter value
+    char type;        // One of enum trace_type
+};
+
+/// A single-producer, single-consumer ring owned by one thread.
+///
+/// The owning thread appends at head, the writer thread consumes at tail.
+struct trace_buffer {
+    struct trace_record records[TRACE_BUFFER_CAP];
+    atomic_uint head;                  // Written by the owning thread
+    atomic_uint tail;                  // Written by the writer thread
+    atomic_uint dropped;               // Events lost to a full buffer
+    _Atomic(const char *) thread_name; // Name of the owning thread, or NULL until it attaches
+    const char *name;                  // Name the owning thread takes when it attaches
+    unsigned long tid;                 // Id of the owning thread, set before thread_name
+    int named;                         // Whether the name was written, writer only
+    struct trace_buffer *next;         // Next buffer in the registry
+};
+
+atomic_int trace_enabled = 0;
+
+static _Atomic(struct trace_buffer *) buffers = NULL;
+
+static atomic_uint session = 0; // Bumped by trace_stop() once it has freed the buffers
+
+static _Thread_local struct trace_buffer *local = NULL;
+
+static _Thread_local unsigned local_session = 0; // Session the local buffer belongs to
+
+static struct {
+    FILE *file;
+    SDL_Thread *thread;
+    atomic_int running;
+    uint64_t start;
+    double ticks_per_us;
+    int first;
+} writer = {0};
+
+struct trace_buffer *trace_buffer_create(const char *name)
+{
+    if (!trace_is_enabled()) {
+        return NULL;
+    }
+    struct trace_buffer *buffer = calloc(1, sizeof(*buffer));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->name = name;
+    struct trace_buffer *head = atomic_load_explicit(&buffers, memory_order_relaxed);
+    do {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&buffers, &head, buffer,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+    return buffer;
+}
+
+void trace_thread_attach(struct trace_buffer *buffer)
+{
+    if (buffer == NULL) {
+        return;
+    }
+    buffer->tid = (unsigned long)SDL_ThreadID();
+    local = buffer;
+    local_session = atomic_load_explicit(&session, memory_order_relaxed);
+    // The writer reads tid only once it sees the name or an event
+    atomic_store_explicit(&buffer->thread_name, buffer->name, memory_order_release);
+}
+
+void trace_thread_name(const char *name)
+{
+    trace_thread_attach(trace_buffer_create(name));
+}
+
+void trace_event(enum trace_type type, const char *name, double value)
+{
+    struct trace_buffer *buffer = local;
+    // Threads which never attached record nothing, rather than allocate here
+    if (buffer == NULL || local_session != atomic_load_explicit(&session, memory_order_relaxed)) {
+        return;
+    }
+    const unsigned head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+    if (head - tail == TRACE_BUFFER_CAP) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    struct trace_record *record = &buffer->records[head & (TRACE_BUFFER_CAP - 1)];
+    record->ts = now();
+    record->name = name;
+    record->value = value;
+    record->type = (char)type;
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+static void write_separator(void)
+{
+    if (writer.first) {
+        writer.first = 0;
+        return;
+    }
+    (void)fputs(",\n", writer.file);
+}
+
+static void write_record(const struct trace_buffer *buffer, const struct trace_record *record)
+{
+    // Timestamps may precede the start by a few ticks if an event was in flight
+    const double ts = (double)(int64_t)(record->ts - writer.start) / writer.ticks_per_us;
+    write_separator();
+    (void)fprintf(writer.file, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%lu",
+                  record->name, record->type, ts, TRACE_PID, buffer->tid);
+    switch (record->type) {
+    case TRACE_INSTANT:
+        (void)fputs(",\"s\":\"t\"", writer.file);
+        break;
+    case TRACE_COUNTER:
+        (void)fprintf(writer.file, ",\"args\":{\"value\":%g}", record->value);
+        break;
+    default:
+        break;
+    }
+    (void)fputc('}', writer.file);
+}
+
+/// Writes out everything currently in the buffers.
+static void drain(void)
+{
+    struct trace_buffer *buffer = atomic_load_explicit(&buffers, memory_order_acquire);
+    for (; buffer != NULL; buffer = buffer->next) {
+        if (!buffer->named) {
+            const char *name = atomic_load_explicit(&buffer->thread_name, memory_order_acquire);
+            if (name != NULL) {
+                write_separator();
+                (void)fprintf(writer.file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                              TRACE_PID, buffer->tid, name);
+                buffer->named = 1;
+            }
+        }
+        const unsigned head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        unsigned tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            write_record(buffer, &buffer->records[tail & (TRACE_BUFFER_CAP - 1)]);
+        }
+        atomic_store_explicit(&buffer->tail, tail, memory_order_release);
+    }
+}
+
+static int trace_writer(__attribute__((unused)) void *data)
+{
+    while (atomic_load_explicit(&writer.running, memory_order_acquire)) {
+        drain();
+        SDL_Delay(TRACE_FLUSH_MS);
+    }
+    return 0;
+}
+
+int trace_start(const char *file)
+{
+    assert(writer.file == NULL);
+    writer.file = fopen(file, "w");
+    if (writer.file == NULL) {
+        SDL_LogError(ERR, "%s: failed to open %s", __func__, file);
+        return -1;
+    }
+    writer.start = now();
+    writer.ticks_per_us = (double)SDL_GetPerformanceFrequency() / 1e6;
+    writer.first = 1;
+    (void)fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", writer.file);
+
+    atomic_store_explicit(&writer.running, 1, memory_order_release);
+    writer.thread = SDL_CreateThread(trace_writer, "trace_writer", NULL);
+    if (writer.thread == NULL) {
+        log_sdl_error("SDL_CreateThread failed");
+        (void)fclose(writer.file);
+        writer.file = NULL;
+        return -1;
+    }
+    atomic_store_explicit(&trace_enabled, 1, memory_order_release);
+    return 0;
+}
+
+void trace_stop(void)
+{
+    if (writer.file == NULL) {
+        return;
+    }
+    atomic_store_explicit(&trace_enabled, 0, memory_order_release);
+    atomic_store_explicit(&writer.running, 0, memory_order_release);
+    SDL_WaitThread(writer.thread, NULL);
+    writer.thread = NULL;
+    drain();
+    (void)fputs("\n]}\n", writer.file);
+    if (fclose(writer.file) != 0) {
+        SDL_LogError(ERR, "%s: failed to write trace", __func__);
+    }
+    writer.file = NULL;
+    local = NULL;
+    // Threads still holding a buffer see the new session and let go of it
+    atomic_fetch_add_explicit(&session, 1, memory_order_relaxed);
+
+    unsigned dropped = 0;
+    struct trace_buffer *buffer = atomic_exchange(&buffers, NULL);
+    while (buffer != NULL) {
+        struct trace_buffer *next = buffer->next;
+        dropped += atomic_load(&buffer->dropped);
+        free(buffer);
+        buffer = next;
+    }
+    if (dropped > 0) {
+        SDL_LogWarn(APP, "%s: %u events dropped", __func__, dropped);
+    }
+}
@@ -0,0 +1,325 @@
+#include "wav.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum {
+    CHUNK_HEADER = 8,
+    RIFF_HEADER = 12,
+    FMT_SIZE = 16,
+    FORMAT_PCM = 0x0001,
+    FORMAT_FLOAT = 0x0003,
+    FORMAT_EXTENSIBLE = 0xFFFE,
+    EXTENSIBLE_SIZE = 40,
+    SUBFORMAT_OFFSET = 24,
+};
+
+static uint16_t read_u16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_u32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/// Parses the fmt chunk.
+static int parse_format(struct wav *wav, const unsigned char *chunk, uint32_t size)
+{
+    if (size < FMT_SIZE) {
+        return -1;
+    }
+    uint16_t tag = read_u16(chunk);
+    const uint16_t channels = read_u16(chunk + 2);
+    const uint32_t sample_rate = read_u32(chunk + 4);
+    const uint16_t block_align = read_u16(chunk + 12);
+    const uint16_t bits = read_u16(chunk + 14);
+    if (tag == FORMAT_EXTENSIBLE) {
+        if (size < EXTENSIBLE_SIZE) {
+            return -1;
+        }
+        // The subformat GUID starts with the format tag it stands for
+        tag = read_u16(chunk + SUBFORMAT_OFFSET);
+    }
+    if (channels == 0 || sample_rate == 0 || sample_rate > INT32_MAX) {
+        return -1;
+    }
+    if (tag == FORMAT_PCM && bits == 8) {
+        wav->format = WAV_U8;
+    } else if (tag == FORMAT_PCM && bits == 16) {
+        wav->format = WAV_S16;
+    } else if (tag == FORMAT_PCM && bits == 24) {
+        wav->format = WAV_S24;
+    } else if (tag == FORMAT_PCM && bits == 32) {
+        wav->format = WAV_S32;
+    } else if (tag == FORMAT_FLOAT && bits == 32) {
+        wav->format = WAV_F32;
+    } else {
+        return -1;
+    }
+    if (block_align != channels * (bits / 8)) {
+        return -1;
+    }
+    wav->channels = channels;
+    wav->sample_rate = (int)sample_rate;
+    wav->frame_size = block_align;
+    return 0;
+}
+
+/// Walks the chunks of a mapped RIFF file to its format and data.
+static int parse(struct wav *wav)
+{
+    const unsigned char *file = wav->map;
+    const size_t size = wav->map_size;
+    if (size < RIFF_HEADER || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+        return -1;
+    }
+    int have_format = 0;
+    size_t at = RIFF_HEADER;
+    while (at + CHUNK_HEADER <= size) {
+        const unsigned char *chunk = file + at;
+        const uint32_t chunk_size = read_u32(chunk + 4);
+        const size_t body = at + CHUNK_HEADER;
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunk_size > size - body || parse_format(wav, file + body, chunk_size) != 0) {
+                return -1;
+            }
+            have_format = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) {
+                return -1;
+            }
+            // Files cut short keep the frames that made it
+            const size_t bytes = (chunk_size < size - body) ? chunk_size : size - body;
+            wav->data = file + body;
+            wav->frames = bytes / wav->frame_size;
+            return 0;
+        }
+        // Chunks are padded to an even size
+        at = body + chunk_size + (chunk_size & 1);
+    }
+    return -1;
+}
+
+int wav_open(struct wav *wav, const char *file)
+{
+    memset(wav, 0, sizeof(*wav));
+    const int fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        goto out_close_fd;
+    }
+    wav->map_size = (size_t)st.st_size;
+    wav->map = mmap(NULL, wav->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (wav->map == MAP_FAILED) {
+        wav->map = NULL;
+        goto out_close_fd;
+    }
+    if (parse(wav) != 0) {
+        wav_close(wav);
+        goto out_close_fd;
+    }
+    // Read ahead more aggressively, and drop pages behind sooner
+    (void)madvise(wav->map, wav->map_size, MADV_SEQUENTIAL);
+    ret = 0;
+out_close_fd:
+    // The mapping keeps the file open
+    (void)close(fd);
+    return ret;
+}
+
+void wav_close(struct wav *wav)
+{
+    if (wav->map != NULL) {
+        (void)munmap(wav->map, wav->map_size);
+    }
+    memset(wav, 0, sizeof(*wav));
+}
+
+/// Rounds a range of frames out to whole pages and passes it to madvise().
+static void advise(const struct wav *wav, size_t frame, size_t frames, int advice)
+{
+    if (frame >= wav->frames) {
+        return;
+    }
+    if (frames > wav->frames - frame) {
+        frames = wav->frames - frame;
+    }
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = (uintptr_t)(wav->data + (frame * wav->frame_size)) & ~(page - 1);
+    const uintptr_t end = (uintptr_t)(wav->data + ((frame + frames) * wav->frame_size));
+    (void)madvise((void *)begin, end - begin, advice);
+}
+
+void wav_prefetch(const struct wav *wav, size_t frame, size_t frames)
+{
+    advise(wav, frame, frames, MADV_WILLNEED);
+}
+
+void wav_release(const struct wav *wav, size_t frame, size_t frames)
+{
+    // Only whole pages before the range's end may be dropped
+    const size_t page_frames = (size_t)sysconf(_SC_PAGESIZE) / wav->frame_size;
+    if (frames > page_frames) {
+        advise(wav, frame, frames - page_frames, MADV_DONTNEED);
+    }
+}
+
+/// Reads a sample as a float in [-1.0, 1.0).
+static float sample(const struct wav *wav, const unsigned char *p)
+{
+    switch (wav->format) {
+    case WAV_U8:
+        return (float)(p[0] - 128) * (1.0f / 128.0f);
+    case WAV_S16:
+        return (float)(int16_t)read_u16(p) * (1.0f / 32768.0f);
+    case WAV_S24:
+        // Shift into the top of an int32_t so the sign carries
+        return (float)((int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) / 256)
+               * (1.0f / 8388608.0f);
+    case WAV_S32:
+        return (float)(int32_t)read_u32(p) * (1.0f / 2147483648.0f);
+    case WAV_F32: {
+        float f;
+        memcpy(&f, p, sizeof(f));
+        return f;
+    }
+    }
+    return 0.0f;
+}
+
+size_t wav_read_stereo(const struct wav *wav, size_t frame, float *out, size_t frames)
+{
+    if (frame >= wav->frames) {
+        return 0;
+    }
+    if (frames > wav->frames - frame) {
+        frames = wav->frames - frame;
+    }
+    const unsigned char *in = wav->data + (frame * wav->frame_size);
+    size_t i = 0;
+    if (wav->channels == 2 && wav->format == WAV_F32) {
+        memcpy(out, in, frames * 2 * sizeof(*out));
+        return frames;
+    }
+#ifdef __SSE2__
+    // The common case of 16-bit stereo, eight samples at a time
+    if (wav->channels == 2 && wav->format == WAV_S16) {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(in + (i * 4)));
+            // Widen by placing each sample in the top half and shifting back down
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+            _mm_storeu_ps(&out[2 * i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(&out[(2 * i) + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    }
+#endif
+    const size_t width = wav->frame_size / (size_t)wav->channels;
+    const size_t right = (wav->channels > 1) ? width : 0;
+    for (; i < frames; ++i) {
+        const unsigned char *p = in + (i * wav->frame_size);
+        out[2 * i] = sample(wav, p);
+        out[(2 * i) + 1] = sample(wav, p + right);
+    }
+    return frames;
+}
+
+static void write_u16(unsigned char *p, uint32_t x)
+{
+    p[0] = (unsigned char)(x & 0xFF);
+    p[1] = (unsigned char)((x >> 8) & 0xFF);
+}
+
+static void write_u32(unsigned char *p, uint32_t x)
+{
+    write_u16(p, x & 0xFFFF);
+    write_u16(p + 2, x >> 16);
+}
+
+/// Writes a size into the header at an offset.
+static int patch_u32(FILE *file, long offset, uint32_t x)
+{
+    unsigned char bytes[4];
+    write_u32(bytes, x);
+    return (fseek(file, offset, SEEK_SET) == 0 && fwrite(bytes, sizeof(bytes), 1, file) == 1) ? 0 : -1;
+}
+
+int wav_writer_open(struct wav_writer *writer, const char *file, int sample_rate, int channels)
+{
+    memset(writer, 0, sizeof(*writer));
+    if (sample_rate <= 0 || channels <= 0 || channels > UINT16_MAX / 4) {
+        return -1;
+    }
+    writer->file = fopen(file, "wb");
+    if (writer->file == NULL) {
+        return -1;
+    }
+    writer->channels = channels;
+    const uint32_t block = (uint32_t)channels * sizeof(float);
+    unsigned char header[RIFF_HEADER + CHUNK_HEADER + FMT_SIZE + CHUNK_HEADER];
+    unsigned char *fmt = header + RIFF_HEADER + CHUNK_HEADER;
+    unsigned char *data = fmt + FMT_SIZE;
+    // The RIFF and data sizes are patched in on closing
+    memcpy(header, "RIFF\0\0\0\0WAVEfmt ", RIFF_HEADER + 4);
+    write_u32(header + RIFF_HEADER + 4, FMT_SIZE);
+    write_u16(fmt, FORMAT_FLOAT);
+    write_u16(fmt + 2, (uint32_t)channels);
+    write_u32(fmt + 4, (uint32_t)sample_rate);
+    write_u32(fmt + 8, (uint32_t)sample_rate * block);
+    write_u16(fmt + 12, block);
+    write_u16(fmt + 14, 32);
+    memcpy(data, "data\0\0\0\0", CHUNK_HEADER);
+    if (fwrite(header, sizeof(header), 1, writer->file) != 1) {
+        (void)fclose(writer->file);
+        writer->file = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int wav_writer_write(struct wav_writer *writer, const float *frames, size_t count)
+{
+    const size_t block = (size_t)writer->channels * sizeof(float);
+    const size_t limit = (UINT32_MAX - (RIFF_HEADER + CHUNK_HEADER + FMT_SIZE + CHUNK_HEADER)) / block;
+    if (count > limit - writer->frames) {
+        return -1;
+    }
+    // Samples are written as they lie, so the host must be little-endian
+    if (fwrite(frames, block, count, writer->file) != count) {
+        return -1;
+    }
+    writer->frames += count;
+    return 0;
+}
+
+int wav_writer_close(struct wav_writer *writer)
+{
+    if (writer->file == NULL) {
+        return -1;
+    }
+    const uint32_t data = (uint32_t)(writer->frames * (size_t)writer->channels * sizeof(float));
+    int ret = 0;
+    if (patch_u32(writer->file, 4, 4 + CHUNK_HEADER + FMT_SIZE + CHUNK_HEADER + data) != 0
+        || patch_u32(writer->file, RIFF_HEADER + CHUNK_HEADER + FMT_SIZE + 4, data) != 0) {
+        ret = -1;
+    }
+    if (fclose(writer->file) != 0) {
+        ret = -1;
+    }
+    memset(writer, 0, sizeof(*writer));
+    return ret;
+}
@@ -0,0 +1,121 @@
+#include "worker_pool.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "prelude_sdl.h"
+
+struct worker_pool {
+    SDL_Thread **threads; // The started threads
+    int count;            // Number of started threads
+    SDL_sem *start;       // Posted once per thread to start a loop
+    SDL_sem *done;        // Posted once per thread when it runs out of work
+    atomic_int quit;      // Whether the threads should exit
+    worker_fn *fn;        // Body of the current loop
+    void *data;           // Data of the current loop
+    size_t total;         // Iterations of the current loop
+    atomic_size_t next;   // Next iteration to hand out
+};
+
+/// Runs iterations of the current loop until there are none left.
+static void drain(struct worker_pool *pool)
+{
+    for (;;) {
+        const size_t i = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed);
+        if (i >= pool->total) {
+            return;
+        }
+        pool->fn(pool->data, i);
+    }
+}
+
+static int worker(void *data)
+{
+    struct worker_pool *pool = data;
+    for (;;) {
+        if (SDL_SemWait(pool->start) != 0) {
+            log_sdl_error("SDL_SemWait failed");
+            return -1;
+        }
+        if (atomic_load_explicit(&pool->quit, memory_order_acquire)) {
+            return 0;
+        }
+        drain(pool);
+        (void)SDL_SemPost(pool->done);
+    }
+}
+
+struct worker_pool *worker_pool_create(int threads)
+{
+    if (threads < 0) {
+        return NULL;
+    }
+    if (threads == 0) {
+        threads = SDL_GetCPUCount();
+    }
+    struct worker_pool *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->threads = calloc((size_t)threads, sizeof(*pool->threads));
+    pool->start = SDL_CreateSemaphore(0);
+    pool->done = SDL_CreateSemaphore(0);
+    if (pool->threads == NULL || pool->start == NULL || pool->done == NULL) {
+        log_sdl_error("SDL_CreateSemaphore failed");
+        worker_pool_destroy(pool);
+        return NULL;
+    }
+    for (int i = 1; i < threads; ++i) {
+        SDL_Thread *thread = SDL_CreateThread(worker, "worker", pool);
+        if (thread == NULL) {
+            log_sdl_error("SDL_CreateThread failed");
+            worker_pool_destroy(pool);
+            return NULL;
+        }
+        pool->threads[pool->count++] = thread;
+    }
+    return pool;
+}
+
+void worker_pool_destroy(struct worker_pool *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    atomic_store_explicit(&pool->quit, 1, memory_order_release);
+    for (int i = 0; i < pool->count; ++i) {
+        (void)SDL_SemPost(pool->start);
+    }
+    for (int i = 0; i < pool->count; ++i) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+    if (pool->done != NULL) {
+        SDL_DestroySemaphore(pool->done);
+    }
+    if (pool->start != NULL) {
+        SDL_DestroySemaphore(pool->start);
+    }
+    free(pool->threads);
+    free(pool);
+}
+
+int worker_pool_size(const struct worker_pool *pool)
+{
+    return pool->count + 1;
+}
+
+void worker_pool_run(struct worker_pool *pool, worker_fn *fn, void *data, size_t count)
+{
+    pool->fn = fn;
+    pool->data = data;
+    pool->total = count;
+    atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+    // Posting the semaphore publishes the loop to the threads
+    for (int i = 0; i < pool->count; ++i) {
+        (void)SDL_SemPost(pool->start);
+    }
+    drain(pool);
+    for (int i = 0; i < pool->count; ++i) {
+        (void)SDL_SemWait(pool->done);
+    }
+}
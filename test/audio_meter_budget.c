@@ -0,0 +1,63 @@
+/// Test for audio_meter_record() function.
+///
+/// This test records callbacks with made-up timings against a 2048-frame
+/// buffer at 48 kHz and checks the counters: that steady callbacks land
+/// in the bin of their share of the period, that one which overruns the
+/// period is counted over budget, and that a gap of several periods is
+/// counted as one late callback and the periods it missed.
+///
+/// @see audio_meter_record()
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "audio_meter.h"
+
+enum {
+    SAMPLE_RATE = 48000,
+    BUFFER = 2048,
+    FREQUENCY = 48000000, // Ticks per second, so that a period is 2048000 ticks
+    PERIOD = BUFFER * 1000,
+    STEADY = 1000,
+};
+
+static const double TOLERANCE = 1e-9;
+
+int main(void)
+{
+    static struct audio_meter meter;
+    audio_meter_init(&meter, SAMPLE_RATE, BUFFER, FREQUENCY);
+    struct audio_meter_stats stats;
+    audio_meter_read(&meter, &stats);
+    if (stats.callbacks != 0 || stats.mean != 0.0 || stats.p99 != 0.0
+        || fabs(stats.period - ((1000.0 * BUFFER) / SAMPLE_RATE)) > TOLERANCE) {
+        return EXIT_FAILURE;
+    }
+
+    // Steady callbacks using 12% of the period, with a little jitter
+    uint64_t t = 1000;
+    for (uint64_t i = 0; i < STEADY; ++i) {
+        const uint64_t begin = t + ((i % 2) * (PERIOD / 10));
+        audio_meter_record(&meter, begin, begin + ((PERIOD * 12) / 100));
+        t += PERIOD;
+    }
+    // One overrunning the period, and then one four periods later
+    audio_meter_record(&meter, t, t + ((PERIOD * 5) / 4));
+    t += 4 * PERIOD;
+    audio_meter_record(&meter, t, t + ((PERIOD * 12) / 100));
+
+    audio_meter_read(&meter, &stats);
+    const double mean = (((STEADY + 1) * 0.12) + 1.25) / (STEADY + 2);
+    if (stats.callbacks != STEADY + 2 || stats.over != 1 || stats.late != 1 || stats.missed != 3
+        || fabs(stats.mean - mean) > TOLERANCE || fabs(stats.max - 1.25) > TOLERANCE
+        || fabs(stats.p99 - 0.15) > TOLERANCE) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < AUDIO_METER_BINS; ++i) {
+        const uint64_t expected = (i == 2) ? STEADY + 1 : (i == AUDIO_METER_BINS - 1) ? 1 : 0;
+        if (stats.bins[i] != expected) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+/// Test for audio_queue_top_up() function.
+///
+/// This test simulates a device draining the queue by a frame's worth of
+/// audio between top-ups.  It checks that a generous target comes down
+/// to within a few granules of the drain without running the queue dry,
+/// that slower frames make it run dry and raise the target until it no
+/// longer does, and that the target stays within its bounds.
+///
+/// @see audio_queue_top_up()
+#include <stdlib.h>
+
+#include "audio_queue.h"
+
+enum {
+    GRANULE = 256,
+    TARGET = 4096,
+    MAX_TARGET = 8192,
+    FAST = 800,  // Frames drained per top-up at 60 Hz
+    SLOW = 1600, // Frames drained per top-up at 30 Hz
+    TOP_UPS = 4096,
+};
+
+/// Runs top-ups against a fixed drain and returns the underruns.
+static uint64_t run(struct audio_queue *queue, size_t *queued, size_t drain)
+{
+    const uint64_t underruns = queue->underruns;
+    for (size_t i = 0; i < TOP_UPS; ++i) {
+        *queued = (*queued > drain) ? *queued - drain : 0;
+        const size_t n = audio_queue_top_up(queue, *queued);
+        if (n % GRANULE != 0 || queue->target < GRANULE || queue->target > MAX_TARGET) {
+            return UINT64_MAX;
+        }
+        *queued += n;
+    }
+    return queue->underruns - underruns;
+}
+
+int main(void)
+{
+    struct audio_queue queue;
+    audio_queue_init(&queue, GRANULE, TARGET, MAX_TARGET);
+    size_t queued = 0;
+    if (run(&queue, &queued, FAST) != 0 || queue.target >= TARGET || queue.target > FAST + (4 * GRANULE)) {
+        return EXIT_FAILURE;
+    }
+    // Slower frames run the queue dry until the target catches up
+    const uint64_t underruns = run(&queue, &queued, SLOW);
+    if (underruns == 0 || underruns == UINT64_MAX || queue.target < SLOW) {
+        return EXIT_FAILURE;
+    }
+    if (run(&queue, &queued, SLOW) != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
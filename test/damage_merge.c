@@ -0,0 +1,67 @@
+/// Test for damage_add() function.
+///
+/// This test checks that dirty rectangles are clipped to the bounds, that
+/// touching rectangles are merged into their union, and that too many
+/// rectangles collapse into their bounding box.
+///
+/// @see damage_add()
+#include <stdlib.h>
+
+#include "damage.h"
+
+static int rect_eq(const SDL_Rect *r, int x, int y, int w, int h)
+{
+    return r->x == x && r->y == y && r->w == w && r->h == h;
+}
+
+int main(void)
+{
+    struct damage damage = {0};
+
+    damage_init(&damage, 100, 100);
+    if (damage.count != 1 || damage_area(&damage) != 10000) {
+        return EXIT_FAILURE;
+    }
+
+    damage_clear(&damage);
+    if (damage_area(&damage) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    // Clipped to the bounds
+    damage_add(&damage, &(SDL_Rect){-10, -10, 20, 20});
+    if (damage.count != 1 || !rect_eq(&damage.rects[0], 0, 0, 10, 10)) {
+        return EXIT_FAILURE;
+    }
+
+    // Disjoint rectangles are kept apart
+    damage_add(&damage, &(SDL_Rect){50, 50, 10, 10});
+    if (damage.count != 2 || damage_area(&damage) != 200) {
+        return EXIT_FAILURE;
+    }
+
+    // A rectangle bridging both merges all three
+    damage_add(&damage, &(SDL_Rect){5, 5, 50, 50});
+    if (damage.count != 1 || !rect_eq(&damage.rects[0], 0, 0, 60, 60)) {
+        return EXIT_FAILURE;
+    }
+
+    // Empty and out-of-bounds rectangles are ignored
+    damage_add(&damage, &(SDL_Rect){70, 70, 0, 10});
+    damage_add(&damage, &(SDL_Rect){200, 200, 10, 10});
+    if (damage.count != 1) {
+        return EXIT_FAILURE;
+    }
+
+    // Overflowing the rectangle list collapses to the bounding box
+    damage_clear(&damage);
+    for (int i = 0; i <= DAMAGE_MAX_RECTS; ++i) {
+        damage_add(&damage, &(SDL_Rect){i * 5, i * 5, 1, 1});
+    }
+    const int last = DAMAGE_MAX_RECTS * 5;
+    if (damage.count != 1 || !rect_eq(&damage.rects[0], 0, 0, last + 1, last + 1)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
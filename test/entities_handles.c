@@ -0,0 +1,140 @@
+/// Test for entities_create() and entities_destroy() functions.
+///
+/// This test creates and destroys entities in a pseudo-random order
+/// against a plain array of expected states, checking after every step
+/// that live handles find their own data, that stale handles are rejected
+/// even after their slots are reused, and that the columns stay packed.
+/// It then checks that a slot is retired rather than let its generation
+/// wrap, and that entities_integrate() wraps positions around the edges of
+/// the area.
+///
+/// @see entities_destroy()
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "entities.h"
+
+enum {
+    CAP = 64,
+    ROUNDS = 10000,
+};
+
+struct expected {
+    entity e;
+    float x;
+    int live;
+};
+
+static struct expected made[ROUNDS];
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return rng_state >> 8;
+}
+
+static int check(const struct entities *es, size_t made_count)
+{
+    size_t live = 0;
+    for (size_t i = 0; i < made_count; ++i) {
+        size_t index = 0;
+        const int found = entities_index(es, made[i].e, &index) == 0;
+        if (found != made[i].live) {
+            return -1;
+        }
+        if (found && (es->x[index] != made[i].x || entities_handle(es, index) != made[i].e)) {
+            return -1;
+        }
+        live += (size_t)found;
+    }
+    return (live == es->count) ? 0 : -1;
+}
+
+/// Destroys an entity whose slot is on its last generation, and expects
+/// the slot retired rather than reused.
+static int check_retire(void)
+{
+    struct entities es = {0};
+    if (entities_init(&es, 1) != 0) {
+        return -1;
+    }
+    int ret = 0;
+    const entity first = entities_create(&es, 0.0f, 0.0f, 0.0f, 0.0f);
+    es.slots[es.owner[0]].generation = UINT32_MAX;
+    const entity last = entities_handle(&es, 0);
+    if (first == ENTITY_NONE || entities_index(&es, first, &(size_t){0}) == 0 || entities_destroy(&es, last) != 0) {
+        ret = -1;
+    }
+    // The only slot is retired, so the store is full for good
+    if (entities_create(&es, 0.0f, 0.0f, 0.0f, 0.0f) != ENTITY_NONE || entities_index(&es, last, &(size_t){0}) == 0) {
+        ret = -1;
+    }
+    entities_finish(&es);
+    return ret;
+}
+
+static int check_integrate(void)
+{
+    struct entities es = {0};
+    if (entities_init(&es, 9) != 0) {
+        return -1;
+    }
+    // Nine entities cover both SIMD and scalar paths
+    const float vx[] = {10.0f, -10.0f, 0.0f, 30.0f, -30.0f, 5.0f, -5.0f, 0.0f, 100.0f};
+    for (size_t i = 0; i < 9; ++i) {
+        (void)entities_create(&es, 95.0f, 5.0f, vx[i], -vx[i]);
+    }
+    entities_integrate(&es, 0.5f, 100.0f, 50.0f, 0, es.count);
+    int ret = 0;
+    for (size_t i = 0; i < 9; ++i) {
+        const float x = fmodf(95.0f + (vx[i] * 0.5f) + 100.0f, 100.0f);
+        const float y = fmodf(5.0f - (vx[i] * 0.5f) + 50.0f, 50.0f);
+        if (fabsf(es.x[i] - x) > 1e-4f || fabsf(es.y[i] - y) > 1e-4f) {
+            ret = -1;
+        }
+    }
+    entities_finish(&es);
+    return ret;
+}
+
+int main(void)
+{
+    struct entities es = {0};
+    if (entities_init(&es, CAP) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (entities_index(&es, ENTITY_NONE, &(size_t){0}) == 0) {
+        return EXIT_FAILURE;
+    }
+    size_t made_count = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        // Bias towards creating until the store fills, then towards destroying
+        const int create = (rng() % CAP) >= es.count;
+        if (create) {
+            const float x = (float)round;
+            const entity e = entities_create(&es, x, 0.0f, 0.0f, 0.0f);
+            if (e == ENTITY_NONE) {
+                return EXIT_FAILURE;
+            }
+            made[made_count++] = (struct expected){e, x, 1};
+        } else {
+            const size_t i = rng() % made_count;
+            if (entities_destroy(&es, made[i].e) != (made[i].live ? 0 : -1)) {
+                return EXIT_FAILURE;
+            }
+            made[i].live = 0;
+        }
+        if (check(&es, made_count) != 0) {
+            return EXIT_FAILURE;
+        }
+    }
+    entities_finish(&es);
+
+    if (check_retire() != 0 || check_integrate() != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
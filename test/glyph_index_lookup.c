@@ -0,0 +1,161 @@
+/// Test for glyph_index_find() function.
+///
+/// This test writes an index of the printable ASCII codepoints, every
+/// third Cyrillic one and a few far apart, maps it, and checks that the
+/// ASCII ones land in the dense table, that every codepoint finds its own
+/// metrics and that codepoints without a glyph find none.  It then checks
+/// that an empty index works and that files cut short or with the wrong
+/// magic number are refused.
+///
+/// @see glyph_index_find()
+/// @see glyph_index_write()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "glyph_index.h"
+
+enum {
+    MAX_CODES = 256,
+};
+
+static uint32_t codes[MAX_CODES];
+static struct glyph_metrics glyphs[MAX_CODES];
+
+static const struct glyph_index_page PAGES[] = {{256, 128}, {64, 32}};
+
+static size_t fill(void)
+{
+    size_t count = 0;
+    for (uint32_t code = 0x20; code <= 0x7E; ++code) {
+        codes[count++] = code;
+    }
+    for (uint32_t code = 0x400; code <= 0x4FF; code += 3) {
+        codes[count++] = code;
+    }
+    codes[count++] = 0x4E00;
+    codes[count++] = 0x1F600;
+    codes[count++] = 0x10FFFF;
+    for (size_t i = 0; i < count; ++i) {
+        glyphs[i] = (struct glyph_metrics){
+            .page = (uint16_t)(i % 2),
+            .x = (uint16_t)i,
+            .y = (uint16_t)(i / 2),
+            .width = (uint16_t)(1 + (i % 9)),
+            .height = (uint16_t)(1 + (i % 13)),
+            .left = (int16_t)((int)(i % 3) - 1),
+            .top = (int16_t)(i % 17),
+            .advance = (int16_t)(i % 11),
+        };
+    }
+    return count;
+}
+
+static int same(const struct glyph_metrics *a, const struct glyph_metrics *b)
+{
+    return a->page == b->page && a->x == b->x && a->y == b->y && a->width == b->width && a->height == b->height
+        && a->left == b->left && a->top == b->top && a->advance == b->advance;
+}
+
+static int check_lookup(const char *name)
+{
+    extern const struct glyph_index_page PAGES[];
+
+    const size_t count = fill();
+    if (glyph_index_write(name, PAGES, 2, codes, glyphs, count, 16, 20) != 0) {
+        return -1;
+    }
+    struct glyph_index index;
+    if (glyph_index_open(&index, name) != 0) {
+        return -1;
+    }
+    int ret = 0;
+    const struct glyph_index_header *header = index.header;
+    if (header->dense_low != 0x20 || header->dense_count != 0x7E - 0x20 + 1 || header->sparse_count != count - 95
+        || header->ascent != 16 || header->line_height != 20 || index.pages[1].width != 64) {
+        ret = -1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const struct glyph_metrics *found = glyph_index_find(&index, codes[i]);
+        if (found == NULL || !same(found, &glyphs[i])) {
+            ret = -1;
+        }
+    }
+    static const uint32_t absent[] = {0, 0x1F, 0x7F, 0x3FF, 0x401, 0x4FE, 0x4E01, 0x10FFFE, UINT32_MAX};
+    for (size_t i = 0; i < sizeof(absent) / sizeof(absent[0]); ++i) {
+        if (glyph_index_find(&index, absent[i]) != NULL) {
+            ret = -1;
+        }
+    }
+    glyph_index_close(&index);
+    return ret;
+}
+
+static int check_empty(const char *name)
+{
+    extern const struct glyph_index_page PAGES[];
+
+    if (glyph_index_write(name, PAGES, 1, codes, glyphs, 0, 16, 20) != 0) {
+        return -1;
+    }
+    struct glyph_index index;
+    if (glyph_index_open(&index, name) != 0) {
+        return -1;
+    }
+    const int ret = (glyph_index_find(&index, 'A') == NULL && glyph_index_find(&index, 0) == NULL) ? 0 : -1;
+    glyph_index_close(&index);
+    return ret;
+}
+
+/// Writes a good index, then overwrites or cuts it, and expects it refused.
+static int check_refused(const char *name)
+{
+    extern const struct glyph_index_page PAGES[];
+
+    const size_t count = fill();
+    if (glyph_index_write(name, PAGES, 2, codes, glyphs, count, 16, 20) != 0) {
+        return -1;
+    }
+    if (truncate(name, 100) != 0) {
+        return -1;
+    }
+    struct glyph_index index;
+    if (glyph_index_open(&index, name) == 0) {
+        glyph_index_close(&index);
+        return -1;
+    }
+    if (glyph_index_write(name, PAGES, 2, codes, glyphs, count, 16, 20) != 0) {
+        return -1;
+    }
+    FILE *file = fopen(name, "r+b");
+    if (file == NULL) {
+        return -1;
+    }
+    const uint32_t swapped = __builtin_bswap32(GLYPH_INDEX_MAGIC);
+    const size_t written = fwrite(&swapped, sizeof(swapped), 1, file);
+    if (fclose(file) != 0 || written != 1) {
+        return -1;
+    }
+    if (glyph_index_open(&index, name) == 0) {
+        glyph_index_close(&index);
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    char name[] = "/tmp/glyph_index_XXXXXX";
+    const int fd = mkstemp(name);
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+    (void)close(fd);
+    int ret = EXIT_SUCCESS;
+    if (check_lookup(name) != 0 || check_empty(name) != 0 || check_refused(name) != 0) {
+        ret = EXIT_FAILURE;
+    }
+    (void)unlink(name);
+    return ret;
+}
@@ -0,0 +1,96 @@
+/// Test for governor_frame() function.
+///
+/// This test feeds a 60 Hz governor frames which overrun the 60 Hz budget
+/// and checks that it steps down to 30 Hz, then cheap frames and checks that
+/// it steps back up only after holding, then frames close to the 60 Hz
+/// budget and checks that it does not step up, and finally checks that it
+/// drops to the idle rate without input and leaves it on input.
+///
+/// @see governor_frame()
+#include <stdlib.h>
+
+#include "governor.h"
+
+/// Feeds frames of one cost, each taking the time the governor allots.
+static double run(struct governor *gov, int frames, double cost)
+{
+    double frame_time = 0.0;
+    for (int i = 0; i < frames; ++i) {
+        governor_input(gov);
+        frame_time = governor_frame(gov, cost, frame_time);
+    }
+    return frame_time;
+}
+
+/// Feeds frames without input.
+static double run_idle(struct governor *gov, int frames, double cost)
+{
+    double frame_time = 0.0;
+    for (int i = 0; i < frames; ++i) {
+        frame_time = governor_frame(gov, cost, frame_time);
+    }
+    return frame_time;
+}
+
+int main(void)
+{
+    struct governor gov = {0};
+
+    // A 60 Hz cap on a 144 Hz display is 48 Hz, the next divisor down
+    governor_init(&gov, 144, 60, 10, 0.0);
+    if (governor_rate(&gov) != 48.0) {
+        return EXIT_FAILURE;
+    }
+
+    governor_init(&gov, 60, 60, 10, 1000.0);
+    if (governor_rate(&gov) != 60.0) {
+        return EXIT_FAILURE;
+    }
+
+    // Frames fitting the budget keep the rate
+    run(&gov, GOVERNOR_WINDOW, 10.0);
+    if (governor_rate(&gov) != 60.0) {
+        return EXIT_FAILURE;
+    }
+
+    // Overruns step down by one divisor per evaluation
+    run(&gov, GOVERNOR_PERIOD, 20.0);
+    if (governor_rate(&gov) != 30.0) {
+        return EXIT_FAILURE;
+    }
+
+    // Headroom steps up only after GOVERNOR_HOLD evaluations
+    run(&gov, GOVERNOR_PERIOD * (GOVERNOR_HOLD - 1), 5.0);
+    if (governor_rate(&gov) != 30.0) {
+        return EXIT_FAILURE;
+    }
+    run(&gov, GOVERNOR_PERIOD, 5.0);
+    if (governor_rate(&gov) != 60.0) {
+        return EXIT_FAILURE;
+    }
+
+    // 15 ms fits 30 Hz but is too close to the 60 Hz budget to step up
+    run(&gov, GOVERNOR_PERIOD, 20.0);
+    run(&gov, GOVERNOR_PERIOD * (GOVERNOR_HOLD + 2), 15.0);
+    if (governor_rate(&gov) != 30.0) {
+        return EXIT_FAILURE;
+    }
+
+    // Cheap frames again, until the window holds nothing else
+    run(&gov, GOVERNOR_WINDOW * 2, 5.0);
+    if (governor_rate(&gov) != 60.0) {
+        return EXIT_FAILURE;
+    }
+
+    // Without input for a second, the rate drops to the idle rate
+    const double frame_time = run_idle(&gov, 120, 1.0);
+    if (governor_rate(&gov) != 10.0 || frame_time != 100.0) {
+        return EXIT_FAILURE;
+    }
+    governor_input(&gov);
+    if (governor_rate(&gov) != 60.0) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
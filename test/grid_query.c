@@ -0,0 +1,115 @@
+/// Test for grid_query_rect() and grid_query_radius() functions.
+///
+/// This test moves, removes and reinserts pseudo-random points, some of
+/// them outside the grid's area, and checks after every round that
+/// rectangle and radius queries find exactly the points a scan of every
+/// point finds.
+///
+/// @see grid_move()
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "grid.h"
+
+enum {
+    POINTS = 2000,
+    ROUNDS = 200,
+    QUERIES = 20,
+};
+
+static const float WIDTH = 1000.0f;
+static const float HEIGHT = 600.0f;
+
+static float px[POINTS];
+static float py[POINTS];
+static int present[POINTS];
+static uint32_t out[POINTS];
+static int seen[POINTS];
+
+static uint32_t rng_state = 1;
+
+static float rng(float lo, float hi)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return lo + ((hi - lo) * (float)(rng_state >> 8) / (float)(1U << 24));
+}
+
+/// Checks that out holds each point matching exactly once.
+static int check(size_t found, int (*match)(size_t, const float *), const float *q)
+{
+    if (found > POINTS) {
+        return -1;
+    }
+    memset(seen, 0, sizeof(seen));
+    for (size_t i = 0; i < found; ++i) {
+        if (seen[out[i]]++ != 0) {
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < POINTS; ++i) {
+        if (seen[i] != (present[i] && match(i, q))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int in_rect(size_t i, const float *q)
+{
+    return px[i] >= q[0] && px[i] < q[0] + q[2] && py[i] >= q[1] && py[i] < q[1] + q[3];
+}
+
+static int in_radius(size_t i, const float *q)
+{
+    const float dx = px[i] - q[0];
+    const float dy = py[i] - q[1];
+    return (dx * dx) + (dy * dy) <= q[2] * q[2];
+}
+
+int main(void)
+{
+    int ret = EXIT_FAILURE;
+    struct grid *grid = grid_create(WIDTH, HEIGHT, 32.0f, POINTS);
+    if (grid == NULL) {
+        return EXIT_FAILURE;
+    }
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (uint32_t i = 0; i < POINTS; ++i) {
+            const float roll = rng(0.0f, 1.0f);
+            if (roll < 0.05f) {
+                grid_remove(grid, i);
+                present[i] = 0;
+                continue;
+            }
+            if (!present[i] || roll < 0.1f) {
+                // Teleport, sometimes past the edges of the area
+                px[i] = rng(-50.0f, WIDTH + 50.0f);
+                py[i] = rng(-50.0f, HEIGHT + 50.0f);
+            } else {
+                px[i] += rng(-20.0f, 20.0f);
+                py[i] += rng(-20.0f, 20.0f);
+            }
+            if (grid_move(grid, i, px[i], py[i]) != 0) {
+                goto out_destroy_grid;
+            }
+            present[i] = 1;
+        }
+        for (int query = 0; query < QUERIES; ++query) {
+            const float rect[] = {rng(-100.0f, WIDTH), rng(-100.0f, HEIGHT), rng(1.0f, 400.0f), rng(1.0f, 400.0f)};
+            size_t found = grid_query_rect(grid, rect[0], rect[1], rect[2], rect[3], out, POINTS);
+            if (check(found, in_rect, rect) != 0) {
+                goto out_destroy_grid;
+            }
+            const float circle[] = {rng(-100.0f, WIDTH + 100.0f), rng(-100.0f, HEIGHT + 100.0f), rng(0.0f, 150.0f)};
+            found = grid_query_radius(grid, circle[0], circle[1], circle[2], out, POINTS);
+            if (check(found, in_radius, circle) != 0) {
+                goto out_destroy_grid;
+            }
+        }
+    }
+    ret = EXIT_SUCCESS;
+out_destroy_grid:
+    grid_destroy(grid);
+    return ret;
+}
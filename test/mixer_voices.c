@@ -0,0 +1,193 @@
+/// Test for mixer_render() function.
+///
+/// This test plays tones and samples on voices of a mixer and checks the
+/// stream: that a centred tone carries the oscillator's sine at the panned
+/// gain on both channels once its ramp is over, that a hard-panned voice
+/// is silent on the other channel, that a sample plays exactly once and
+/// then frees its voice, that a stream skips an earlier stream's frames
+/// and frees its voice at its end, that a stopped voice goes idle, and
+/// that the limiter keeps many loud voices within full scale.
+///
+/// @see mixer_render()
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "mixer.h"
+#include "oscillator.h"
+#include "spsc_ring.h"
+
+enum {
+    SAMPLE_RATE = 48000,
+    RAMP = 240,
+    VOICES = 32,
+    BUFFER = 1000,
+};
+
+static const double TOLERANCE = 1e-5;
+
+static float stream[2 * BUFFER];
+static float mono[BUFFER];
+
+static int check_tone(void)
+{
+    struct mixer *mixer = mixer_create(SAMPLE_RATE, VOICES, RAMP);
+    if (mixer == NULL) {
+        return -1;
+    }
+    int ret = 0;
+    struct oscillator osc = {0};
+    oscillator_init(&osc, 440.0, SAMPLE_RATE);
+    if (mixer_play_tone(mixer, 3, 440.0, 0.5f, 0.0f) != 0) {
+        ret = -1;
+    }
+    const double gain = 0.5 * cos(M_PI / 4.0);
+    for (int b = 0; b < 4; ++b) {
+        mixer_render(mixer, stream, BUFFER);
+        oscillator_sine(&osc, mono, BUFFER, 1.0f);
+        for (size_t i = (b == 0) ? RAMP : 0; i < BUFFER; ++i) {
+            if (fabs(stream[2 * i] - (gain * mono[i])) > TOLERANCE
+                || stream[2 * i] != stream[(2 * i) + 1]) {
+                ret = -1;
+            }
+        }
+    }
+    if (mixer_active(mixer) != 1) {
+        ret = -1;
+    }
+
+    // Hard left leaves the right channel silent once the ramp is over
+    (void)mixer_set_gain(mixer, 3, 0.5f, -1.0f);
+    mixer_render(mixer, stream, BUFFER);
+    for (size_t i = RAMP; i < BUFFER; ++i) {
+        if (fabsf(stream[(2 * i) + 1]) > TOLERANCE) {
+            ret = -1;
+        }
+    }
+
+    (void)mixer_stop(mixer, 3);
+    mixer_render(mixer, stream, BUFFER);
+    for (size_t i = RAMP; i < BUFFER; ++i) {
+        if (stream[2 * i] != 0.0f || stream[(2 * i) + 1] != 0.0f) {
+            ret = -1;
+        }
+    }
+    if (mixer_active(mixer) != 0) {
+        ret = -1;
+    }
+
+    if (mixer_play_tone(mixer, VOICES, 440.0, 0.5f, 0.0f) == 0) {
+        ret = -1;
+    }
+    mixer_destroy(mixer);
+    return ret;
+}
+
+static int check_sample(void)
+{
+    struct mixer *mixer = mixer_create(SAMPLE_RATE, VOICES, 1);
+    if (mixer == NULL) {
+        return -1;
+    }
+    int ret = 0;
+    static float ones[BUFFER / 3];
+    for (size_t i = 0; i < BUFFER / 3; ++i) {
+        ones[i] = 1.0f;
+    }
+    const struct mixer_sample sample = {.samples = ones, .count = BUFFER / 3, .loop = 0};
+    // Two voices at 0.25 each, panned apart, sum to 0.25 per channel
+    if (mixer_play_sample(mixer, 0, &sample, 0.25f, -1.0f) != 0
+        || mixer_play_sample(mixer, VOICES - 1, &sample, 0.25f, 1.0f) != 0) {
+        ret = -1;
+    }
+    mixer_render(mixer, stream, BUFFER);
+    for (size_t i = 0; i < BUFFER; ++i) {
+        const float expected = (i < BUFFER / 3) ? 0.25f : 0.0f;
+        if (fabsf(stream[2 * i] - expected) > TOLERANCE
+            || fabsf(stream[(2 * i) + 1] - expected) > TOLERANCE) {
+            ret = -1;
+        }
+    }
+    if (mixer_active(mixer) != 0) {
+        ret = -1;
+    }
+    mixer_destroy(mixer);
+    return ret;
+}
+
+static int check_stream(void)
+{
+    struct mixer *mixer = mixer_create(SAMPLE_RATE, VOICES, 1);
+    if (mixer == NULL) {
+        return -1;
+    }
+    struct spsc_ring ring;
+    if (spsc_ring_init(&ring, 2 * sizeof(float), 1024) != 0) {
+        mixer_destroy(mixer);
+        return -1;
+    }
+    int ret = 0;
+    static const float stale[2] = {1.0f, 1.0f};
+    static const float frame[2] = {0.5f, -0.25f};
+    for (size_t i = 0; i < 100; ++i) {
+        (void)spsc_ring_push(&ring, stale, 1);
+    }
+    atomic_size_t end;
+    atomic_init(&end, SIZE_MAX);
+    const struct mixer_stream source = {.ring = &ring, .start = 100, .end = &end};
+    for (size_t i = 0; i < BUFFER / 2; ++i) {
+        (void)spsc_ring_push(&ring, frame, 1);
+    }
+    atomic_store(&end, 100 + (BUFFER / 2));
+    if (mixer_play_stream(mixer, 5, &source, 1.0f, 0.0f) != 0) {
+        ret = -1;
+    }
+    mixer_render(mixer, stream, BUFFER);
+    const float gain = (float)cos(M_PI / 4.0);
+    for (size_t i = 0; i < BUFFER; ++i) {
+        const float left = (i < BUFFER / 2) ? 0.5f * gain : 0.0f;
+        const float right = (i < BUFFER / 2) ? -0.25f * gain : 0.0f;
+        if (fabsf(stream[2 * i] - left) > TOLERANCE || fabsf(stream[(2 * i) + 1] - right) > TOLERANCE) {
+            ret = -1;
+        }
+    }
+    if (mixer_active(mixer) != 0 || mixer_underruns(mixer) != 0) {
+        ret = -1;
+    }
+    spsc_ring_finish(&ring);
+    mixer_destroy(mixer);
+    return ret;
+}
+
+static int check_limiter(void)
+{
+    struct mixer *mixer = mixer_create(SAMPLE_RATE, VOICES, RAMP);
+    if (mixer == NULL) {
+        return -1;
+    }
+    int ret = 0;
+    for (size_t v = 0; v < VOICES; ++v) {
+        (void)mixer_play_tone(mixer, v, 220.0 + (double)v, 1.0f, 0.0f);
+    }
+    for (int b = 0; b < 20; ++b) {
+        mixer_render(mixer, stream, BUFFER);
+        for (size_t i = 0; i < 2 * BUFFER; ++i) {
+            if (!(fabsf(stream[i]) <= 1.0f)) {
+                ret = -1;
+            }
+        }
+    }
+    if (mixer_active(mixer) != VOICES) {
+        ret = -1;
+    }
+    mixer_destroy(mixer);
+    return ret;
+}
+
+int main(void)
+{
+    if (check_tone() != 0 || check_sample() != 0 || check_stream() != 0 || check_limiter() != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/// Test for mono_bitmap_expand() function.
+///
+/// This test expands pseudo-random bitmaps of every width from 1 to 33
+/// pixels into a larger image at several offsets, and checks every pixel
+/// of the image against the bitmap read a bit at a time, with the rows
+/// flipped and the pixels outside the bitmap left alone.
+///
+/// @see mono_bitmap_expand()
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mono_bitmap.h"
+
+enum {
+    IMAGE_WIDTH = 48,
+    IMAGE_HEIGHT = 24,
+    MAX_WIDTH = 33,
+    ROWS = 7,
+    PITCH = 6, // More than the widest bitmap needs, as FreeType may pad rows
+};
+
+static const bmp_pixel32 ON = {0x00, 0x00, 0x00, 0xFF};
+static const bmp_pixel32 OFF = {0xFF, 0xFF, 0xFF, 0x00};
+static const bmp_pixel32 BACKGROUND = {0x12, 0x34, 0x56, 0x78};
+
+static int same(bmp_pixel32 a, bmp_pixel32 b)
+{
+    return a.b == b.b && a.g == b.g && a.r == b.r && a.a == b.a;
+}
+
+static int check(const struct mono_bitmap_lut *lut, const unsigned char *bits, size_t width, size_t x, size_t y)
+{
+    extern const bmp_pixel32 ON;
+    extern const bmp_pixel32 OFF;
+    extern const bmp_pixel32 BACKGROUND;
+
+    static bmp_pixel32 image[IMAGE_WIDTH * IMAGE_HEIGHT];
+    mono_bitmap_fill(image, IMAGE_WIDTH * IMAGE_HEIGHT, BACKGROUND);
+    mono_bitmap_expand(lut, bits, PITCH, width, ROWS, image, IMAGE_WIDTH, IMAGE_HEIGHT, x, y);
+
+    for (size_t row = 0; row < IMAGE_HEIGHT; ++row) {
+        for (size_t col = 0; col < IMAGE_WIDTH; ++col) {
+            // The image is stored bottom row first
+            const bmp_pixel32 actual = image[((IMAGE_HEIGHT - 1 - row) * IMAGE_WIDTH) + col];
+            bmp_pixel32 expected = BACKGROUND;
+            if (row >= y && row < y + ROWS && col >= x && col < x + width) {
+                const size_t u = col - x;
+                const unsigned bit = (bits[((row - y) * PITCH) + (u / 8)] >> (7 - (u % 8))) & 1;
+                expected = bit ? ON : OFF;
+            }
+            if (!same(actual, expected)) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    extern const bmp_pixel32 ON;
+    extern const bmp_pixel32 OFF;
+
+    struct mono_bitmap_lut lut;
+    mono_bitmap_lut_init(&lut, ON, OFF);
+
+    unsigned char bits[ROWS * PITCH];
+    uint32_t rng_state = 1;
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+        rng_state = rng_state * 1664525U + 1013904223U;
+        bits[i] = (unsigned char)(rng_state >> 24);
+    }
+
+    static const size_t offsets[][2] = {{0, 0}, {1, 3}, {7, 10}, {IMAGE_WIDTH - MAX_WIDTH, IMAGE_HEIGHT - ROWS}};
+    for (size_t width = 1; width <= MAX_WIDTH; ++width) {
+        for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+            if (check(&lut, bits, width, offsets[i][0], offsets[i][1]) != 0) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    // An empty image stays empty, and one pixel is filled
+    bmp_pixel32 pixel = OFF;
+    mono_bitmap_fill(&pixel, 0, ON);
+    if (!same(pixel, OFF)) {
+        return EXIT_FAILURE;
+    }
+    mono_bitmap_fill(&pixel, 1, ON);
+    return same(pixel, ON) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
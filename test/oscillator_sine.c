@@ -0,0 +1,46 @@
+/// Test for oscillator_sine() function.
+///
+/// This test generates a few seconds of a 440 Hz sine in buffers of odd
+/// lengths, across several wraps of the phase, and checks every sample
+/// against sin() of the exactly accumulated phase.
+///
+/// @see oscillator_sine()
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "oscillator.h"
+
+enum {
+    SAMPLE_RATE = 48000,
+    BUFFER = 1027,
+    BUFFERS = 200,
+};
+
+static const double TOLERANCE = 1e-5;
+
+static float mono[BUFFER];
+
+int main(void)
+{
+    struct oscillator osc = {0};
+    oscillator_init(&osc, 440.0, SAMPLE_RATE);
+
+    uint32_t phase = 0;
+    for (int b = 0; b < BUFFERS; ++b) {
+        // Vary the length to cover every remainder of the SIMD loop
+        const size_t n = BUFFER - (size_t)(b % 4);
+        oscillator_sine(&osc, mono, n, 0.5f);
+        for (size_t i = 0; i < n; ++i) {
+            const double expected = 0.5 * sin(2.0 * M_PI * (double)phase / 4294967296.0);
+            if (fabs(mono[i] - expected) > TOLERANCE) {
+                return EXIT_FAILURE;
+            }
+            phase += osc.increment;
+        }
+        if (osc.phase != phase) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
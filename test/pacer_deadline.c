@@ -0,0 +1,67 @@
+/// Test for pacer_next() and pacer_stats() functions.
+///
+/// This test checks that frame times are rounded up to whole refreshes,
+/// that deadlines advance on the refresh grid without drifting, that a
+/// missed deadline moves to the next refresh on the grid, and that the
+/// present-interval statistics match a hand-computed example.
+///
+/// @see pacer_next()
+#include <math.h>
+#include <stdlib.h>
+
+#include "pacer.h"
+
+static int near(double a, double b)
+{
+    return fabs(a - b) < 1e-9;
+}
+
+int main(void)
+{
+    struct pacer pacer = {0};
+
+    // 60 Hz frames on a 144 Hz display last three refreshes, at 48 Hz
+    pacer_init(&pacer, 144);
+    if (pacer_divisor(&pacer, 1000.0 / 60.0) != 3 || pacer_divisor(&pacer, 1000.0 / 144.0) != 1) {
+        return EXIT_FAILURE;
+    }
+
+    pacer_init(&pacer, 100);
+    if (!near(pacer_next(&pacer, 3.0, 10.0), 13.0)) {
+        return EXIT_FAILURE;
+    }
+    // Late starts do not move the grid
+    if (!near(pacer_next(&pacer, 14.5, 10.0), 23.0)) {
+        return EXIT_FAILURE;
+    }
+    // Two refreshes per frame
+    if (!near(pacer_next(&pacer, 23.5, 20.0), 43.0)) {
+        return EXIT_FAILURE;
+    }
+    // A missed deadline moves to the next refresh after now
+    if (!near(pacer_next(&pacer, 71.0, 10.0), 73.0)) {
+        return EXIT_FAILURE;
+    }
+
+    struct pacer_stats stats = {0};
+    if (pacer_stats(&pacer, &stats) != -1) {
+        return EXIT_FAILURE;
+    }
+
+    // Intervals of 10, 12 and 8, then a skipped frame which is not measured
+    pacer_present(&pacer, 0.0);
+    pacer_present(&pacer, 10.0);
+    pacer_present(&pacer, 22.0);
+    pacer_present(&pacer, 30.0);
+    pacer_skip(&pacer);
+    pacer_present(&pacer, 50.0);
+    if (pacer_stats(&pacer, &stats) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (stats.count != 3 || !near(stats.mean, 10.0) || !near(stats.stddev, sqrt(8.0 / 3.0))
+        || !near(stats.min, 8.0) || !near(stats.max, 12.0) || stats.missed != 1) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/// Test for pixels_blend() function.
+///
+/// This test blends rows of random pixels of every length up to a few
+/// vectors, and checks each result against the rounded value of
+/// (src * a + dst * (255 - a)) / 255 computed in floating point.
+///
+/// @see pixels_blend()
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pixels.h"
+
+enum {
+    MAX_LEN = 37,
+    ROUNDS = 1000,
+};
+
+static uint32_t rng_state = 1;
+
+static uint8_t rng(void)
+{
+    rng_state = rng_state * 1664525U + 1013904223U;
+    return (uint8_t)(rng_state >> 24);
+}
+
+static uint8_t expected(uint8_t s, uint8_t d, uint8_t a)
+{
+    return (uint8_t)lround(((double)s * a + (double)d * (255 - a)) / 255.0);
+}
+
+int main(void)
+{
+    bmp_pixel32 src[MAX_LEN];
+    bmp_pixel32 dst[MAX_LEN];
+    bmp_pixel32 old[MAX_LEN];
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        const size_t n = (size_t)round % (MAX_LEN + 1);
+        for (size_t i = 0; i < n; ++i) {
+            // Mix in runs of fully opaque and fully transparent pixels
+            uint8_t a = rng();
+            if (round % 3 == 1) {
+                a = 0xFF;
+            } else if (round % 3 == 2) {
+                a = 0;
+            }
+            src[i] = (bmp_pixel32){.b = rng(), .g = rng(), .r = rng(), .a = a};
+            dst[i] = (bmp_pixel32){.b = rng(), .g = rng(), .r = rng(), .a = 0xFF};
+            old[i] = dst[i];
+        }
+        pixels_blend(dst, src, n);
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t a = src[i].a;
+            if (dst[i].b != expected(src[i].b, old[i].b, a)
+                || dst[i].g != expected(src[i].g, old[i].g, a)
+                || dst[i].r != expected(src[i].r, old[i].r, a)
+                || dst[i].a != 0xFF) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    bmp_pixel32 color = {.b = 1, .g = 2, .r = 3, .a = 4};
+    pixels_fill(dst, color, MAX_LEN);
+    for (size_t i = 0; i < MAX_LEN; ++i) {
+        if (dst[i].b != 1 || dst[i].g != 2 || dst[i].r != 3 || dst[i].a != 4) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
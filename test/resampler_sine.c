@@ -0,0 +1,109 @@
+/// Test for resampler_process() function.
+///
+/// This test resamples a sine on the left channel and a cosine on the
+/// right between 44.1 and 48 kHz both ways and by factors of two, feeding
+/// the input and taking the output in pieces of uneven sizes, and checks
+/// the output against the same waveforms at the output rate, that the
+/// number of output frames follows the ratio, that DC passes unchanged,
+/// and that ratios needing too many phases are refused.
+///
+/// @see resampler_process()
+#include <math.h>
+#include <stdlib.h>
+
+#include "resampler.h"
+
+enum {
+    FRAMES = 20000,
+    MAX_OUT = 2 * FRAMES,
+};
+
+static const double FREQUENCY = 1000.0;
+
+static const double TOLERANCE = 2e-4;
+
+static float in[2 * FRAMES];
+static float out[2 * MAX_OUT];
+
+static const size_t IN_PIECES[] = {1, 7, 333, 64, 1000, 2};
+static const size_t OUT_PIECES[] = {50, 3, 1, 999, 128};
+
+/// Resamples the whole input in uneven pieces and returns the output frames.
+static size_t run(struct resampler *resampler)
+{
+    size_t used = 0;
+    size_t written = 0;
+    for (size_t i = 0; used < FRAMES && written < MAX_OUT; ++i) {
+        const size_t want = IN_PIECES[i % (sizeof(IN_PIECES) / sizeof(IN_PIECES[0]))];
+        size_t n = (want < FRAMES - used) ? want : FRAMES - used;
+        size_t room = OUT_PIECES[i % (sizeof(OUT_PIECES) / sizeof(OUT_PIECES[0]))];
+        room = (room < MAX_OUT - written) ? room : MAX_OUT - written;
+        written += resampler_process(resampler, &in[2 * used], &n, &out[2 * written], room);
+        used += n;
+    }
+    // Drain what the last input allows
+    size_t none = 0;
+    written += resampler_process(resampler, NULL, &none, &out[2 * written], MAX_OUT - written);
+    return written;
+}
+
+static int check_sine(int from, int to)
+{
+    struct resampler resampler;
+    if (resampler_init(&resampler, from, to) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < FRAMES; ++i) {
+        const double phase = (2.0 * M_PI * FREQUENCY * (double)i) / from;
+        in[2 * i] = (float)(0.5 * sin(phase));
+        in[(2 * i) + 1] = (float)(0.5 * cos(phase));
+    }
+    int ret = 0;
+    const size_t written = run(&resampler);
+    const double expected = ((double)FRAMES * to) / from;
+    if ((double)written > expected || (double)written < expected - ((RESAMPLER_TAPS * (double)to) / from) - 1.0) {
+        ret = -1;
+    }
+    // The first outputs are filtered partly from the silence before the stream
+    for (size_t k = (RESAMPLER_TAPS * (size_t)to) / (size_t)from; k < written; ++k) {
+        const double phase = (2.0 * M_PI * FREQUENCY * (double)k) / to;
+        if (fabs(out[2 * k] - (0.5 * sin(phase))) > TOLERANCE || fabs(out[(2 * k) + 1] - (0.5 * cos(phase))) > TOLERANCE) {
+            ret = -1;
+        }
+    }
+    resampler_finish(&resampler);
+    return ret;
+}
+
+static int check_dc(void)
+{
+    struct resampler resampler;
+    if (resampler_init(&resampler, 44100, 48000) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < 2 * FRAMES; ++i) {
+        in[i] = 0.25f;
+    }
+    int ret = 0;
+    const size_t written = run(&resampler);
+    for (size_t k = RESAMPLER_TAPS * 2; k < written; ++k) {
+        if (fabsf(out[2 * k] - 0.25f) > 1e-6f || fabsf(out[(2 * k) + 1] - 0.25f) > 1e-6f) {
+            ret = -1;
+        }
+    }
+    resampler_finish(&resampler);
+    return ret;
+}
+
+int main(void)
+{
+    struct resampler resampler;
+    if (resampler_init(&resampler, 0, 48000) == 0 || resampler_init(&resampler, 1, 48000) == 0) {
+        return EXIT_FAILURE;
+    }
+    if (check_sine(44100, 48000) != 0 || check_sine(48000, 44100) != 0
+        || check_sine(24000, 48000) != 0 || check_sine(96000, 48000) != 0 || check_dc() != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
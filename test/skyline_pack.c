@@ -0,0 +1,106 @@
+/// Test for skyline_insert() function.
+///
+/// This test packs equal squares into a page they tile exactly, checking
+/// that every one fits and the next does not, and then packs rectangles
+/// of many sizes tallest first, checking that none leaves the page or
+/// overlaps another and that together they fill most of it.
+///
+/// @see skyline_insert()
+#include <stdlib.h>
+
+#include "skyline.h"
+
+enum {
+    PAGE = 256,
+    SQUARE = 16,
+    RECTS = 600,
+};
+
+static unsigned char used[PAGE * PAGE];
+
+struct rect {
+    int w;
+    int h;
+};
+
+static int compare_height(const void *a, const void *b)
+{
+    const struct rect *ra = a;
+    const struct rect *rb = b;
+    return (rb->h != ra->h) ? rb->h - ra->h : rb->w - ra->w;
+}
+
+static int check_squares(void)
+{
+    struct skyline sky;
+    if (skyline_init(&sky, 4 * SQUARE, 4 * SQUARE) != 0) {
+        return -1;
+    }
+    int ret = 0;
+    int x = 0;
+    int y = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (skyline_insert(&sky, SQUARE, SQUARE, &x, &y) != 0) {
+            ret = -1;
+        }
+    }
+    if (skyline_insert(&sky, 1, 1, &x, &y) == 0 || sky.area != 16L * SQUARE * SQUARE) {
+        ret = -1;
+    }
+    skyline_finish(&sky);
+    return ret;
+}
+
+static int check_mixed(void)
+{
+    static struct rect rects[RECTS];
+    // Glyph-like sizes from a fixed sequence
+    unsigned int seed = 12345;
+    long area = 0;
+    for (size_t i = 0; i < RECTS; ++i) {
+        seed = (seed * 1103515245U) + 12345U;
+        rects[i].w = 2 + (int)((seed >> 16) % 14);
+        seed = (seed * 1103515245U) + 12345U;
+        rects[i].h = 4 + (int)((seed >> 16) % 17);
+        area += (long)rects[i].w * rects[i].h;
+    }
+    qsort(rects, RECTS, sizeof(rects[0]), compare_height);
+
+    struct skyline sky;
+    if (skyline_init(&sky, PAGE, PAGE) != 0) {
+        return -1;
+    }
+    int ret = 0;
+    for (size_t i = 0; i < RECTS; ++i) {
+        int x = 0;
+        int y = 0;
+        if (skyline_insert(&sky, rects[i].w, rects[i].h, &x, &y) != 0) {
+            ret = -1;
+            continue;
+        }
+        if (x < 0 || y < 0 || x + rects[i].w > PAGE || y + rects[i].h > PAGE) {
+            ret = -1;
+            continue;
+        }
+        for (int v = y; v < y + rects[i].h; ++v) {
+            for (int u = x; u < x + rects[i].w; ++u) {
+                ret = (used[(v * PAGE) + u] != 0) ? -1 : ret;
+                used[(v * PAGE) + u] = 1;
+            }
+        }
+    }
+    // The rectangles cover about 94% of the page, and all of them must fit
+    if (sky.area != area || (double)area / (PAGE * PAGE) < 0.9) {
+        ret = -1;
+    }
+    skyline_finish(&sky);
+    return ret;
+}
+
+int main(void)
+{
+    if (check_squares() != 0 || check_mixed() != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/// Test for spsc_ring_push() and spsc_ring_pop() functions.
+///
+/// This test pushes a counting sequence from one thread and pops it on
+/// another, both in batches of pseudo-random sizes which wrap around the
+/// end of a small ring, and checks that every item arrives once and in
+/// order.
+///
+/// @see spsc_ring_push()
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "spsc_ring.h"
+
+enum {
+    CAP = 64,
+    BATCH = 23,
+    ITEMS = 100000,
+};
+
+static struct spsc_ring ring;
+
+static void *produce(__attribute__((unused)) void *data)
+{
+    uint32_t rng_state = 1;
+    uint32_t batch[BATCH];
+    uint32_t next = 0;
+    while (next < ITEMS) {
+        rng_state = rng_state * 1664525U + 1013904223U;
+        size_t n = 1 + ((rng_state >> 8) % BATCH);
+        if (n > ITEMS - next) {
+            n = ITEMS - next;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            batch[i] = next + (uint32_t)i;
+        }
+        const size_t pushed = spsc_ring_push(&ring, batch, n);
+        if (pushed == 0) {
+            (void)sched_yield();
+        }
+        next += (uint32_t)pushed;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    if (spsc_ring_init(&ring, sizeof(uint32_t), CAP) != 0) {
+        return EXIT_FAILURE;
+    }
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, produce, NULL) != 0) {
+        return EXIT_FAILURE;
+    }
+    int ret = EXIT_SUCCESS;
+    uint32_t rng_state = 2;
+    uint32_t batch[BATCH];
+    uint32_t expected = 0;
+    while (expected < ITEMS) {
+        rng_state = rng_state * 1664525U + 1013904223U;
+        const size_t n = spsc_ring_pop(&ring, batch, 1 + ((rng_state >> 8) % BATCH));
+        if (n == 0) {
+            (void)sched_yield();
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (batch[i] != expected++) {
+                ret = EXIT_FAILURE;
+            }
+        }
+        if (spsc_ring_readable(&ring) > CAP) {
+            ret = EXIT_FAILURE;
+        }
+    }
+    (void)pthread_join(producer, NULL);
+    if (spsc_ring_readable(&ring) != 0) {
+        ret = EXIT_FAILURE;
+    }
+    spsc_ring_finish(&ring);
+    return ret;
+}
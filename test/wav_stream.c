@@ -0,0 +1,251 @@
+/// Test for wav_read_stereo() and streamer_open() functions.
+///
+/// This test writes a 16-bit stereo and a 24-bit mono WAV file, checks
+/// their headers and converted frames, and then streams the stereo file
+/// once and looping through a ring smaller than the file, checking that
+/// every frame arrives in order and that the end is marked, and once more
+/// to a streamer at 44.1 kHz, checking that the resampled stream has the
+/// length of the file at that rate.
+///
+/// @see wav_read_stereo()
+/// @see streamer_open()
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "spsc_ring.h"
+#include "streamer.h"
+#include "wav.h"
+
+enum {
+    SAMPLE_RATE = 48000,
+    OTHER_RATE = 44100,
+    FRAMES = 10007,
+    RING = 4096,
+    READ = 333,
+    RETRIES = 1000000,
+};
+
+static float frames[2 * READ];
+
+static void put_u16(FILE *file, uint32_t x)
+{
+    (void)fputc((int)(x & 0xFF), file);
+    (void)fputc((int)((x >> 8) & 0xFF), file);
+}
+
+static void put_u32(FILE *file, uint32_t x)
+{
+    put_u16(file, x & 0xFFFF);
+    put_u16(file, x >> 16);
+}
+
+static int16_t left_of(size_t i)
+{
+    return (int16_t)(uint16_t)(i * 7);
+}
+
+static int16_t right_of(size_t i)
+{
+    return (int16_t)(uint16_t)(0x8000 + (i * 13));
+}
+
+static int32_t mono_of(size_t i)
+{
+    return (int32_t)(i * 977) - 0x800000;
+}
+
+/// Writes a WAV file with a stray chunk before the data, of odd size.
+static int write_wav(const char *name, uint16_t channels, uint16_t bits)
+{
+    FILE *file = fopen(name, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    const uint32_t block = channels * (bits / 8U);
+    const uint32_t data = FRAMES * block;
+    (void)fputs("RIFF", file);
+    put_u32(file, 4 + (8 + 16) + (8 + 3 + 1) + (8 + data));
+    (void)fputs("WAVEfmt ", file);
+    put_u32(file, 16);
+    put_u16(file, 1);
+    put_u16(file, channels);
+    put_u32(file, SAMPLE_RATE);
+    put_u32(file, SAMPLE_RATE * block);
+    put_u16(file, block);
+    put_u16(file, bits);
+    (void)fputs("LIST", file);
+    put_u32(file, 3);
+    (void)fwrite("abc\0", 1, 4, file);
+    (void)fputs("data", file);
+    put_u32(file, data);
+    for (size_t i = 0; i < FRAMES; ++i) {
+        if (channels == 2) {
+            put_u16(file, (uint16_t)left_of(i));
+            put_u16(file, (uint16_t)right_of(i));
+        } else {
+            const uint32_t x = (uint32_t)mono_of(i);
+            (void)fputc((int)(x & 0xFF), file);
+            put_u16(file, (x >> 8) & 0xFFFF);
+        }
+    }
+    return (fclose(file) == 0) ? 0 : -1;
+}
+
+static int check_stereo(const char *name)
+{
+    struct wav wav;
+    if (wav_open(&wav, name) != 0) {
+        return -1;
+    }
+    int ret = 0;
+    if (wav.channels != 2 || wav.sample_rate != SAMPLE_RATE || wav.format != WAV_S16 || wav.frames != FRAMES) {
+        ret = -1;
+    }
+    // Odd offsets and lengths cover the SIMD loop's remainders
+    for (size_t at = 1; at < FRAMES; at += READ) {
+        const size_t n = wav_read_stereo(&wav, at, frames, READ);
+        if (n != ((FRAMES - at < READ) ? FRAMES - at : READ)) {
+            ret = -1;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (frames[2 * i] != (float)left_of(at + i) / 32768.0f
+                || frames[(2 * i) + 1] != (float)right_of(at + i) / 32768.0f) {
+                ret = -1;
+            }
+        }
+    }
+    wav_close(&wav);
+    return ret;
+}
+
+static int check_mono(const char *name)
+{
+    struct wav wav;
+    if (wav_open(&wav, name) != 0) {
+        return -1;
+    }
+    int ret = 0;
+    if (wav.channels != 1 || wav.format != WAV_S24 || wav.frames != FRAMES) {
+        ret = -1;
+    }
+    const size_t n = wav_read_stereo(&wav, FRAMES - READ, frames, READ);
+    for (size_t i = 0; i < n; ++i) {
+        const float expected = (float)mono_of(FRAMES - READ + i) / 8388608.0f;
+        if (frames[2 * i] != expected || frames[(2 * i) + 1] != expected) {
+            ret = -1;
+        }
+    }
+    wav_close(&wav);
+    return ret;
+}
+
+/// Pops a stream as the mixer would, until its end or a number of frames.
+static int check_stream(const struct mixer_stream *stream, size_t total)
+{
+    size_t got = 0;
+    while (got < total) {
+        const size_t n = spsc_ring_pop(stream->ring, frames, (total - got < READ) ? total - got : READ);
+        for (size_t i = 0; i < n; ++i) {
+            const size_t at = (got + i) % FRAMES;
+            if (frames[2 * i] != (float)left_of(at) / 32768.0f) {
+                return -1;
+            }
+        }
+        got += n;
+        if (n == 0) {
+            const size_t tail = atomic_load_explicit(&stream->ring->tail, memory_order_relaxed);
+            if (tail == atomic_load_explicit(stream->end, memory_order_acquire)) {
+                break;
+            }
+            (void)sched_yield();
+        }
+    }
+    return (got == total) ? 0 : -1;
+}
+
+static int check_streamer(const char *name)
+{
+    struct streamer *streamer = streamer_create(SAMPLE_RATE, 2, RING);
+    if (streamer == NULL) {
+        return -1;
+    }
+    int ret = 0;
+    struct mixer_stream stream;
+    if (streamer_open(streamer, 1, name, 0, &stream) != 0 || check_stream(&stream, FRAMES) != 0) {
+        ret = -1;
+    }
+    // The same stream again, looping, once the thread has closed it
+    streamer_close(streamer, 1);
+    int tries = 0;
+    while (streamer_open(streamer, 1, name, 1, &stream) != 0 && tries < RETRIES) {
+        (void)sched_yield();
+        tries += 1;
+    }
+    if (tries == RETRIES || check_stream(&stream, (3 * FRAMES) + 5) != 0) {
+        ret = -1;
+    }
+    streamer_close(streamer, 1);
+    streamer_destroy(streamer);
+    return ret;
+}
+
+/// Pops a stream until its end and returns the number of frames.
+static size_t count_stream(const struct mixer_stream *stream)
+{
+    size_t got = 0;
+    for (int tries = 0; tries < RETRIES; ++tries) {
+        const size_t n = spsc_ring_pop(stream->ring, frames, READ);
+        got += n;
+        if (n == 0) {
+            const size_t tail = atomic_load_explicit(&stream->ring->tail, memory_order_relaxed);
+            if (tail == atomic_load_explicit(stream->end, memory_order_acquire)) {
+                break;
+            }
+            (void)sched_yield();
+        }
+    }
+    return got;
+}
+
+static int check_resampled(const char *name)
+{
+    struct streamer *streamer = streamer_create(OTHER_RATE, 1, RING);
+    if (streamer == NULL) {
+        return -1;
+    }
+    int ret = 0;
+    struct mixer_stream stream;
+    // Every input frame is accounted for, up to the last output falling before the file's end
+    const size_t expected = ((FRAMES * (size_t)OTHER_RATE) + SAMPLE_RATE - 1) / SAMPLE_RATE;
+    if (streamer_open(streamer, 0, name, 0, &stream) != 0 || count_stream(&stream) != expected) {
+        ret = -1;
+    }
+    streamer_close(streamer, 0);
+    streamer_destroy(streamer);
+    return ret;
+}
+
+int main(void)
+{
+    char stereo[] = "/tmp/wav_stream_XXXXXX";
+    char mono[] = "/tmp/wav_stream_XXXXXX";
+    const int stereo_fd = mkstemp(stereo);
+    const int mono_fd = mkstemp(mono);
+    if (stereo_fd < 0 || mono_fd < 0) {
+        return EXIT_FAILURE;
+    }
+    (void)close(stereo_fd);
+    (void)close(mono_fd);
+    int ret = EXIT_SUCCESS;
+    if (write_wav(stereo, 2, 16) != 0 || write_wav(mono, 1, 24) != 0
+        || check_stereo(stereo) != 0 || check_mono(mono) != 0 || check_streamer(stereo) != 0
+        || check_resampled(stereo) != 0) {
+        ret = EXIT_FAILURE;
+    }
+    (void)unlink(stereo);
+    (void)unlink(mono);
+    return ret;
+}
@@ -0,0 +1,72 @@
+/// Test for wav_writer_write() function.
+///
+/// This test writes float stereo frames in several pieces, opens the file
+/// with the reader, and checks that the header describes them and that
+/// every frame reads back exactly.
+///
+/// @see wav_writer_write()
+/// @see wav_open()
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "wav.h"
+
+enum {
+    SAMPLE_RATE = 44100,
+    FRAMES = 3001,
+    PIECE = 1000,
+};
+
+static float frames[2 * FRAMES];
+static float back[2 * FRAMES];
+
+static int check(const char *name)
+{
+    struct wav_writer writer;
+    if (wav_writer_open(&writer, name, SAMPLE_RATE, 2) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < FRAMES; ++i) {
+        frames[2 * i] = (float)i / FRAMES;
+        frames[(2 * i) + 1] = -1.0f + (float)(i % 7) / 3.0f;
+    }
+    int ret = 0;
+    for (size_t at = 0; at < FRAMES; at += PIECE) {
+        const size_t n = (FRAMES - at < PIECE) ? FRAMES - at : PIECE;
+        if (wav_writer_write(&writer, &frames[2 * at], n) != 0) {
+            ret = -1;
+        }
+    }
+    if (wav_writer_close(&writer) != 0 || ret != 0) {
+        return -1;
+    }
+
+    struct wav wav;
+    if (wav_open(&wav, name) != 0) {
+        return -1;
+    }
+    if (wav.channels != 2 || wav.sample_rate != SAMPLE_RATE || wav.format != WAV_F32 || wav.frames != FRAMES
+        || wav_read_stereo(&wav, 0, back, FRAMES) != FRAMES) {
+        ret = -1;
+    }
+    for (size_t i = 0; i < 2 * FRAMES; ++i) {
+        if (back[i] != frames[i]) {
+            ret = -1;
+        }
+    }
+    wav_close(&wav);
+    return ret;
+}
+
+int main(void)
+{
+    char name[] = "/tmp/wav_write_XXXXXX";
+    const int fd = mkstemp(name);
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+    (void)close(fd);
+    const int ret = (check(name) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    (void)unlink(name);
+    return ret;
+}